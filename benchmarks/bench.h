@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Print one result row: label, problem size, and average cost per operation.
+ */
+static inline void bench_report(const char* label, uint32_t n, uint64_t elapsed_ns, uint64_t ops)
+{
+  printf("%-40s n=%-6u %10.2f ns/op\n", label, (unsigned)n, ops ? (double)elapsed_ns / (double)ops : 0.0);
+}
+
+/**
+ * @brief Print a throughput row in millions of operations per second.
+ */
+static inline void bench_report_throughput(const char* label, uint32_t n, uint64_t elapsed_ns, uint64_t ops)
+{
+  printf("%-40s n=%-6u %10.2f Mops/s\n", label, (unsigned)n, elapsed_ns ? (double)ops * 1000.0 / (double)elapsed_ns : 0.0);
+}
+
+/**
+ * Keeps the optimizer from discarding a value that is otherwise unused.
+ */
+#define BENCH_DO_NOT_OPTIMIZE(value) __asm__ volatile("" : : "g"(value) : "memory")
@@ -0,0 +1,74 @@
+#include "bench.h"
+#include "dlist.h"
+#include "list.h"
+#include "utils.h"
+
+#define MAX_NODES 1000
+#define ITERATIONS 100000
+
+static list_node_t list_nodes[MAX_NODES + 1];
+static dlist_node_t dlist_nodes[MAX_NODES + 1];
+
+// Before: singly-linked list_t walks the chain on every push and delete.
+static void bench_list(uint32_t n)
+{
+  list_t list;
+  list_init(&list);
+  for(uint32_t i = 0; i < n; i++) {
+    list_push(&list, &list_nodes[i]);
+  }
+
+  uint64_t start = bench_now_ns();
+  for(uint32_t i = 0; i < ITERATIONS; i++) {
+    list_push(&list, &list_nodes[n]);
+    list_delete(&list, &list_nodes[n]);
+  }
+  bench_report("list_t push+delete", n, bench_now_ns() - start, ITERATIONS);
+
+  start = bench_now_ns();
+  for(uint32_t i = 0; i < ITERATIONS; i++) {
+    list_node_t* middle = &list_nodes[n / 2];
+    list_delete(&list, middle);
+    list_push(&list, middle);
+  }
+  bench_report("list_t delete middle+push", n, bench_now_ns() - start, ITERATIONS);
+  BENCH_DO_NOT_OPTIMIZE(list.head);
+}
+
+// After: dlist_t with a tail pointer does both in constant time.
+static void bench_dlist(uint32_t n)
+{
+  dlist_t list;
+  dlist_init(&list);
+  for(uint32_t i = 0; i < n; i++) {
+    dlist_push_back(&list, &dlist_nodes[i]);
+  }
+
+  uint64_t start = bench_now_ns();
+  for(uint32_t i = 0; i < ITERATIONS; i++) {
+    dlist_push_back(&list, &dlist_nodes[n]);
+    dlist_remove(&list, &dlist_nodes[n]);
+  }
+  bench_report("dlist_t push_back+remove", n, bench_now_ns() - start, ITERATIONS);
+
+  start = bench_now_ns();
+  for(uint32_t i = 0; i < ITERATIONS; i++) {
+    dlist_node_t* middle = &dlist_nodes[n / 2];
+    dlist_remove(&list, middle);
+    dlist_push_back(&list, middle);
+  }
+  bench_report("dlist_t remove middle+push_back", n, bench_now_ns() - start, ITERATIONS);
+  BENCH_DO_NOT_OPTIMIZE(list.head);
+}
+
+int main(void)
+{
+  const uint32_t sizes[] = { 10, 100, 1000 };
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(sizes); i++) {
+    bench_list(sizes[i]);
+    bench_dlist(sizes[i]);
+  }
+
+  return 0;
+}
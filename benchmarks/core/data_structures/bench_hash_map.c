@@ -0,0 +1,104 @@
+#include "bench.h"
+#include "hash_map.h"
+#include "utils.h"
+
+#include <stdbool.h>
+
+#define CAPACITY 1024
+#define LOOKUPS 1000000
+
+static HASH_MAP_STORAGE(slots, CAPACITY);
+static uint16_t keys[CAPACITY];
+static uint16_t missing[CAPACITY];
+static bool used[UINT16_MAX + 1];
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint16_t next_random(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return (uint16_t)rng_state;
+}
+
+// Sparse, vendor-style key IDs spread over the whole 16-bit range.
+static uint16_t unique_key(void)
+{
+  uint16_t key;
+  do {
+    key = next_random();
+  } while(used[key]);
+  used[key] = true;
+  return key;
+}
+
+// Before: resolving a key means scanning every candidate, as composite_datastream does.
+static void bench_linear_scan(uint32_t n)
+{
+  uint64_t start = bench_now_ns();
+  uint32_t found = 0;
+  for(uint32_t i = 0; i < LOOKUPS; i++) {
+    uint16_t key = keys[(i * 7u) % n];
+    for(uint32_t j = 0; j < n; j++) {
+      if(keys[j] == key) {
+        found++;
+        break;
+      }
+    }
+  }
+  bench_report("linear scan hit", n, bench_now_ns() - start, LOOKUPS);
+  BENCH_DO_NOT_OPTIMIZE(found);
+}
+
+// After: Robin Hood lookup at the load factor implied by n / CAPACITY.
+static void bench_hash_map(uint32_t n)
+{
+  hash_map_t map;
+  hash_map_init(&map, slots, CAPACITY);
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(used); i++) {
+    used[i] = false;
+  }
+  for(uint32_t i = 0; i < n; i++) {
+    keys[i] = unique_key();
+    hash_map_put(&map, keys[i], &keys[i]);
+  }
+  for(uint32_t i = 0; i < n; i++) {
+    missing[i] = unique_key();
+  }
+
+  char label[48];
+  unsigned load = (unsigned)((n * 100u + CAPACITY / 2) / CAPACITY);
+  void* value = NULL;
+  uint32_t found = 0;
+
+  uint64_t start = bench_now_ns();
+  for(uint32_t i = 0; i < LOOKUPS; i++) {
+    found += hash_map_get(&map, keys[(i * 7u) % n], &value);
+  }
+  snprintf(label, sizeof(label), "hash_map hit  (%u%% load)", load);
+  bench_report(label, n, bench_now_ns() - start, LOOKUPS);
+
+  start = bench_now_ns();
+  for(uint32_t i = 0; i < LOOKUPS; i++) {
+    found += hash_map_get(&map, missing[(i * 7u) % n], &value);
+  }
+  snprintf(label, sizeof(label), "hash_map miss (%u%% load)", load);
+  bench_report(label, n, bench_now_ns() - start, LOOKUPS);
+
+  BENCH_DO_NOT_OPTIMIZE(found);
+  BENCH_DO_NOT_OPTIMIZE(value);
+}
+
+int main(void)
+{
+  const uint32_t sizes[] = { CAPACITY / 2, CAPACITY * 3 / 4, CAPACITY * 9 / 10 };
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(sizes); i++) {
+    bench_hash_map(sizes[i]);
+    bench_linear_scan(sizes[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "mpsc_queue.h"
+#include "queue.h"
+#include "utils.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define MAX_PRODUCERS 8
+// queue_t counts with a uint16_t, so keep the worst-case backlog below 65536 and repeat.
+#define PER_PRODUCER 8000
+#define ROUNDS 20
+
+typedef struct {
+  mpsc_node_t mpsc_node;
+  queue_node_t queue_node;
+} item_t;
+
+static item_t items[MAX_PRODUCERS][PER_PRODUCER];
+
+static mpsc_queue_t mpsc;
+static queue_t locked_queue;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* mpsc_producer(void* arg)
+{
+  item_t* own = (item_t*)arg;
+  for(uint32_t i = 0; i < PER_PRODUCER; i++) {
+    mpsc_queue_push(&mpsc, &own[i].mpsc_node);
+  }
+  return NULL;
+}
+
+static void* locked_producer(void* arg)
+{
+  item_t* own = (item_t*)arg;
+  for(uint32_t i = 0; i < PER_PRODUCER; i++) {
+    pthread_mutex_lock(&lock);
+    queue_enqueue(&locked_queue, &own[i].queue_node);
+    pthread_mutex_unlock(&lock);
+  }
+  return NULL;
+}
+
+static uint32_t mpsc_consume(void)
+{
+  mpsc_node_t* node = mpsc_queue_pop(&mpsc);
+  return node != NULL;
+}
+
+static uint32_t locked_consume(void)
+{
+  pthread_mutex_lock(&lock);
+  queue_node_t* node = queue_dequeue(&locked_queue);
+  pthread_mutex_unlock(&lock);
+  return node != NULL;
+}
+
+static void run(const char* label, uint32_t producers, void* (*producer)(void*), uint32_t (*consume)(void))
+{
+  pthread_t threads[MAX_PRODUCERS];
+  uint32_t total = producers * PER_PRODUCER;
+
+  uint64_t start = bench_now_ns();
+  for(uint32_t round = 0; round < ROUNDS; round++) {
+    uint32_t received = 0;
+
+    for(uint32_t p = 0; p < producers; p++) {
+      pthread_create(&threads[p], NULL, producer, items[p]);
+    }
+    while(received < total) {
+      if(consume()) {
+        received++;
+      }
+      else {
+        sched_yield();
+      }
+    }
+    for(uint32_t p = 0; p < producers; p++) {
+      pthread_join(threads[p], NULL);
+    }
+  }
+
+  bench_report_throughput(label, producers, bench_now_ns() - start, (uint64_t)total * ROUNDS);
+}
+
+int main(void)
+{
+  const uint32_t producer_counts[] = { 1, 2, 4, 8 };
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(producer_counts); i++) {
+    mpsc_queue_init(&mpsc);
+    run("mpsc_queue", producer_counts[i], mpsc_producer, mpsc_consume);
+
+    queue_init(&locked_queue);
+    run("queue_t + pthread mutex", producer_counts[i], locked_producer, locked_consume);
+  }
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include "bench.h"
+#include "spsc_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define CAPACITY 1024
+#define TRANSFERS 20000000u
+
+typedef enum {
+  MODE_SINGLE,
+  MODE_BULK,
+  MODE_REGION,
+} transfer_mode_t;
+
+typedef struct {
+  spsc_ring_t ring;
+  transfer_mode_t mode;
+  uint32_t batch;
+} bench_context_t;
+
+static uint32_t storage[CAPACITY];
+
+static void* producer(void* arg)
+{
+  bench_context_t* context = (bench_context_t*)arg;
+  uint32_t batch[64];
+  uint32_t sent = 0;
+
+  while(sent < TRANSFERS) {
+    uint32_t before = sent;
+
+    if(context->mode == MODE_SINGLE) {
+      sent += spsc_ring_push(&context->ring, &sent);
+    }
+    else {
+      uint32_t n = context->batch;
+      if(n > TRANSFERS - sent) {
+        n = TRANSFERS - sent;
+      }
+      for(uint32_t i = 0; i < n; i++) {
+        batch[i] = sent + i;
+      }
+      sent += spsc_ring_push_n(&context->ring, batch, n);
+    }
+
+    // Yield when full so the benchmark also makes progress on a single core.
+    if(sent == before) {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+static void consume(bench_context_t* context)
+{
+  uint32_t batch[64];
+  uint32_t received = 0;
+  uint32_t checksum = 0;
+
+  while(received < TRANSFERS) {
+    uint32_t before = received;
+
+    if(context->mode == MODE_SINGLE) {
+      uint32_t value;
+      if(spsc_ring_pop(&context->ring, &value)) {
+        checksum += value;
+        received++;
+      }
+    }
+    else if(context->mode == MODE_BULK) {
+      uint32_t n = spsc_ring_pop_n(&context->ring, batch, context->batch);
+      for(uint32_t i = 0; i < n; i++) {
+        checksum += batch[i];
+      }
+      received += n;
+    }
+    else {
+      const void* region;
+      uint32_t n = spsc_ring_read_region(&context->ring, &region);
+      for(uint32_t i = 0; i < n; i++) {
+        checksum += ((const uint32_t*)region)[i];
+      }
+      spsc_ring_read_commit(&context->ring, n);
+      received += n;
+    }
+
+    if(received == before) {
+      sched_yield();
+    }
+  }
+
+  BENCH_DO_NOT_OPTIMIZE(checksum);
+}
+
+static void run(const char* label, transfer_mode_t mode, uint32_t batch)
+{
+  bench_context_t context = { .mode = mode, .batch = batch };
+  spsc_ring_init(&context.ring, storage, sizeof(uint32_t), CAPACITY);
+
+  pthread_t thread;
+  uint64_t start = bench_now_ns();
+  pthread_create(&thread, NULL, producer, &context);
+  consume(&context);
+  pthread_join(thread, NULL);
+
+  bench_report_throughput(label, batch, bench_now_ns() - start, TRANSFERS);
+}
+
+int main(void)
+{
+  run("spsc_ring push/pop", MODE_SINGLE, 1);
+  run("spsc_ring push_n/pop_n", MODE_BULK, 8);
+  run("spsc_ring push_n/pop_n", MODE_BULK, 64);
+  run("spsc_ring push_n/read_region", MODE_REGION, 64);
+
+  return 0;
+}
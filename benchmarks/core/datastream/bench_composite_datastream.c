@@ -0,0 +1,127 @@
+#include "bench.h"
+#include "composite_datastream.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define MAX_STREAMS 16
+#define KEYS_PER_STREAM 32
+#define KEY_SPACE (MAX_STREAMS * KEYS_PER_STREAM)
+#define OPERATIONS 1000000
+
+// Minimal child stream owning a contiguous key range, so each child answers contains()
+// for a disjoint slice of the composite key space.
+typedef struct {
+  i_datastream_t interface;
+  datastream_key_t first;
+  uint32_t values[KEYS_PER_STREAM];
+} range_stream_t;
+
+static range_stream_t children[MAX_STREAMS];
+static i_datastream_t* streams[MAX_STREAMS];
+static COMPOSITE_DATASTREAM_ROUTES(routes, KEY_SPACE);
+static datastream_key_t workload[OPERATIONS];
+
+static bool range_contains(i_datastream_t* interface, datastream_key_t key)
+{
+  range_stream_t* stream = (range_stream_t*)interface;
+  return key >= stream->first && key < stream->first + KEYS_PER_STREAM;
+}
+
+static void range_read(i_datastream_t* interface, datastream_key_t key, void* out)
+{
+  range_stream_t* stream = (range_stream_t*)interface;
+  memcpy(out, &stream->values[key - stream->first], sizeof(uint32_t));
+}
+
+static void range_write(i_datastream_t* interface, datastream_key_t key, const void* data)
+{
+  range_stream_t* stream = (range_stream_t*)interface;
+  memcpy(&stream->values[key - stream->first], data, sizeof(uint32_t));
+}
+
+static datastream_size_t range_size(i_datastream_t* interface, datastream_key_t key)
+{
+  (void)interface;
+  (void)key;
+  return sizeof(uint32_t);
+}
+
+static void range_stream_init(range_stream_t* stream, datastream_key_t first)
+{
+  memset(stream, 0, sizeof(*stream));
+  stream->first = first;
+  stream->interface.read = range_read;
+  stream->interface.write = range_write;
+  stream->interface.contains = range_contains;
+  stream->interface.size = range_size;
+}
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t next_random(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+// Mixed workload: uniformly spread over every child, so the average scan visits half of them.
+static void build_workload(uint32_t key_count)
+{
+  for(uint32_t i = 0; i < OPERATIONS; i++) {
+    workload[i] = (datastream_key_t)(next_random() % key_count);
+  }
+}
+
+static uint64_t run(composite_datastream_t* composite)
+{
+  i_datastream_t* datastream = &composite->interface;
+  uint32_t value = 0;
+
+  uint64_t start = bench_now_ns();
+  for(uint32_t i = 0; i < OPERATIONS; i++) {
+    if((i & 3u) == 0) {
+      datastream_write(datastream, workload[i], &i);
+    }
+    else {
+      datastream_read(datastream, workload[i], &value);
+    }
+  }
+  uint64_t elapsed = bench_now_ns() - start;
+
+  BENCH_DO_NOT_OPTIMIZE(value);
+  return elapsed;
+}
+
+static void bench_composite(uint8_t stream_count)
+{
+  uint32_t key_count = (uint32_t)stream_count * KEYS_PER_STREAM;
+  composite_datastream_t composite;
+
+  for(uint8_t i = 0; i < stream_count; i++) {
+    range_stream_init(&children[i], (datastream_key_t)(i * KEYS_PER_STREAM));
+    streams[i] = &children[i].interface;
+  }
+  build_workload(key_count);
+
+  // Before: every access asks each child in turn whether it owns the key.
+  composite_datastream_init(&composite, streams, stream_count);
+  bench_report("composite linear scan (1:3 write:read)", stream_count, run(&composite), OPERATIONS);
+
+  // After: one table lookup resolves the owning child.
+  composite_datastream_set_routes(&composite, routes, (uint16_t)key_count);
+  bench_report("composite routed (1:3 write:read)", stream_count, run(&composite), OPERATIONS);
+}
+
+int main(void)
+{
+  const uint8_t stream_counts[] = { 2, 4, 8, MAX_STREAMS };
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(stream_counts); i++) {
+    bench_composite(stream_counts[i]);
+  }
+
+  return 0;
+}
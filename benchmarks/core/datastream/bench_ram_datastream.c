@@ -0,0 +1,179 @@
+#include "bench.h"
+#include "ram_datastream.h"
+#include "ram_datastream_utils.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define OPERATIONS 2000000
+#define SNAPSHOT_CYCLES 200000
+
+// 500 keys: 100 groups of mixed-size values in declaration order.
+#define GROUP(ENTRY, n)          \
+  ENTRY(K_FLAG_##n, uint8_t)     \
+  ENTRY(K_TIME_##n, uint64_t)    \
+  ENTRY(K_COUNT_##n, uint16_t)   \
+  ENTRY(K_VALUE_##n, float)      \
+  ENTRY(K_STATUS_##n, uint32_t)
+
+#define GROUPS_10(ENTRY, n)                                                                              \
+  GROUP(ENTRY, n##0) GROUP(ENTRY, n##1) GROUP(ENTRY, n##2) GROUP(ENTRY, n##3) GROUP(ENTRY, n##4)         \
+    GROUP(ENTRY, n##5) GROUP(ENTRY, n##6) GROUP(ENTRY, n##7) GROUP(ENTRY, n##8) GROUP(ENTRY, n##9)
+
+#define BENCH_ENTRIES(ENTRY)                                                                             \
+  GROUPS_10(ENTRY, 0) GROUPS_10(ENTRY, 1) GROUPS_10(ENTRY, 2) GROUPS_10(ENTRY, 3) GROUPS_10(ENTRY, 4)    \
+    GROUPS_10(ENTRY, 5) GROUPS_10(ENTRY, 6) GROUPS_10(ENTRY, 7) GROUPS_10(ENTRY, 8) GROUPS_10(ENTRY, 9)
+
+#define KEY_COUNT DATABASE_KEY_COUNT(BENCH_ENTRIES)
+
+DATABASE_ENUM(BENCH_ENTRIES)
+
+// Before: the previous DATABASE_STORAGE layout, packed byte arrays with no alignment.
+#define EXPAND_AS_PACKED_MEMBER(name, type) uint8_t name[sizeof(type)];
+#define EXPAND_AS_PACKED_ENTRY(name, type) { offsetof(packed_storage_t, name), sizeof(type) },
+
+typedef struct {
+  BENCH_ENTRIES(EXPAND_AS_PACKED_MEMBER)
+} packed_storage_t;
+
+#define EXPAND_AS_NATURAL_ENTRY(name, type) { offsetof(natural_storage_t, name), sizeof(type) },
+
+typedef struct {
+  BENCH_ENTRIES(DATABASE_EXPAND_AS_STORAGE_STRUCT)
+} natural_storage_t;
+
+DATABASE_SORTED_STORAGE(BENCH_ENTRIES)
+
+static const ram_datastream_entry_t packed_entries[] = { BENCH_ENTRIES(EXPAND_AS_PACKED_ENTRY) };
+static const ram_datastream_entry_t natural_entries[] = { BENCH_ENTRIES(EXPAND_AS_NATURAL_ENTRY) };
+static const ram_datastream_entry_t sorted_entries[] = { BENCH_ENTRIES(DATABASE_EXPAND_AS_SORTED_ENTRY) };
+
+static packed_storage_t packed_storage;
+static natural_storage_t natural_storage;
+static ram_storage_t sorted_storage;
+
+static datastream_key_t workload[OPERATIONS];
+
+// The same keys followed by a 16 KiB capture buffer that the consumer does not need.
+typedef struct {
+  ram_storage_t scalars;
+  int16_t capture[8192];
+} large_storage_t;
+
+static ram_datastream_entry_t large_entries[KEY_COUNT + 1];
+static large_storage_t large_storage;
+static large_storage_t storage_copy;
+static RAM_DATASTREAM_SNAPSHOT(view, large_storage_t, KEY_COUNT + 1);
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t next_random(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static void bench_layout(const char* label, const ram_datastream_entry_t* entries, void* storage)
+{
+  const ram_datastream_config_t config = { entries, KEY_COUNT, NULL };
+  ram_datastream_t ds;
+  ram_datastream_init(&ds, &config, storage);
+
+  uint64_t value = 0;
+  uint64_t start = bench_now_ns();
+  for(uint32_t i = 0; i < OPERATIONS; i++) {
+    if((i & 3u) == 0) {
+      value = i;
+      datastream_write(&ds.interface, workload[i], &value);
+    }
+    else {
+      datastream_read(&ds.interface, workload[i], &value);
+    }
+  }
+  bench_report(label, KEY_COUNT, bench_now_ns() - start, OPERATIONS);
+  BENCH_DO_NOT_OPTIMIZE(value);
+}
+
+// A consumer that needs three keys from the same instant, while the producer writes
+// writes_per_cycle random scalar keys between consecutive views.
+static void bench_consistent_view(const char* label, const ram_datastream_config_t* config, void* storage, uint32_t storage_size, uint32_t writes_per_cycle)
+{
+  ram_datastream_t ds;
+  datastream_snapshot_t snapshot;
+  uint64_t time = 0;
+  float value = 0;
+  uint32_t status = 0;
+  uint64_t written = 0;
+  char line[64];
+
+  // Before: copy the whole storage so that every key comes from the same instant.
+  ram_datastream_init(&ds, config, storage);
+  uint32_t w = 0;
+  uint64_t start = bench_now_ns();
+  for(uint32_t c = 0; c < SNAPSHOT_CYCLES; c++) {
+    for(uint32_t i = 0; i < writes_per_cycle; i++, w++) {
+      written = w;
+      datastream_write(&ds.interface, workload[w % OPERATIONS], &written);
+    }
+    memcpy(&storage_copy, storage, storage_size);
+    memcpy(&time, (uint8_t*)&storage_copy + config->entries[K_TIME_00].offset, sizeof(time));
+    memcpy(&value, (uint8_t*)&storage_copy + config->entries[K_VALUE_00].offset, sizeof(value));
+    memcpy(&status, (uint8_t*)&storage_copy + config->entries[K_STATUS_00].offset, sizeof(status));
+  }
+  snprintf(line, sizeof(line), "%s copy storage", label);
+  bench_report(line, writes_per_cycle, bench_now_ns() - start, SNAPSHOT_CYCLES);
+
+  // After: capture copies nothing and writes save only the keys they change.
+  ram_datastream_init(&ds, config, storage);
+  ram_datastream_add_snapshot(&ds, &snapshot, &view_shadow, view_tags);
+  w = 0;
+  start = bench_now_ns();
+  for(uint32_t c = 0; c < SNAPSHOT_CYCLES; c++) {
+    for(uint32_t i = 0; i < writes_per_cycle; i++, w++) {
+      written = w;
+      datastream_write(&ds.interface, workload[w % OPERATIONS], &written);
+    }
+    ram_datastream_capture(&ds, &snapshot);
+    ram_datastream_snapshot_read(&ds, &snapshot, K_TIME_00, &time);
+    ram_datastream_snapshot_read(&ds, &snapshot, K_VALUE_00, &value);
+    ram_datastream_snapshot_read(&ds, &snapshot, K_STATUS_00, &status);
+  }
+  snprintf(line, sizeof(line), "%s snapshot", label);
+  bench_report(line, writes_per_cycle, bench_now_ns() - start, SNAPSHOT_CYCLES);
+
+  BENCH_DO_NOT_OPTIMIZE(time);
+  BENCH_DO_NOT_OPTIMIZE(value);
+  BENCH_DO_NOT_OPTIMIZE(status);
+}
+
+int main(void)
+{
+  for(uint32_t i = 0; i < OPERATIONS; i++) {
+    workload[i] = (datastream_key_t)(next_random() % KEY_COUNT);
+  }
+
+  printf("storage bytes: packed %u, natural %u, sorted %u\n",
+    (unsigned)sizeof(packed_storage_t),
+    (unsigned)sizeof(natural_storage_t),
+    (unsigned)sizeof(ram_storage_t));
+
+  // Before: the previous DATABASE_STORAGE layout. After: naturally aligned, then sorted.
+  bench_layout("ram_datastream packed (1:3 write:read)", packed_entries, &packed_storage);
+  bench_layout("ram_datastream natural (1:3 write:read)", natural_entries, &natural_storage);
+  bench_layout("ram_datastream sorted (1:3 write:read)", sorted_entries, &sorted_storage);
+
+  memcpy(large_entries, sorted_entries, sizeof(sorted_entries));
+  large_entries[KEY_COUNT] = (ram_datastream_entry_t){ offsetof(large_storage_t, capture), sizeof(large_storage.capture) };
+  const ram_datastream_config_t sorted_config = { sorted_entries, KEY_COUNT, NULL };
+  const ram_datastream_config_t large_config = { large_entries, KEY_COUNT + 1, NULL };
+
+  const uint32_t writes_per_cycle[] = { 1, 8, 64 };
+  for(uint32_t i = 0; i < NUM_ELEMENTS(writes_per_cycle); i++) {
+    bench_consistent_view("view of 500 keys:", &sorted_config, &sorted_storage, sizeof(sorted_storage), writes_per_cycle[i]);
+    bench_consistent_view("view of 500 keys + 16K buffer:", &large_config, &large_storage, sizeof(large_storage), writes_per_cycle[i]);
+  }
+
+  return 0;
+}
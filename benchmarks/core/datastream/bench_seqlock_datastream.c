@@ -0,0 +1,140 @@
+#include "bench.h"
+#include "ram_datastream.h"
+#include "seqlock_datastream.h"
+#include "utils.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define MAX_READERS 8
+#define WRITES 200000
+
+// One 64-byte record: large enough that a torn copy is possible without synchronization.
+typedef struct {
+  uint64_t words[8];
+} sample_t;
+
+enum {
+  KEY_SAMPLE,
+  KEY_COUNTER,
+};
+
+typedef struct {
+  sample_t sample;
+  uint32_t counter;
+} bench_storage_t;
+
+static const ram_datastream_entry_t entries[] = {
+  { offsetof(bench_storage_t, sample), sizeof(sample_t) },
+  { offsetof(bench_storage_t, counter), sizeof(uint32_t) },
+};
+
+static const ram_datastream_config_t config = {
+  .entries = entries,
+  .count = NUM_ELEMENTS(entries),
+};
+
+static bench_storage_t storage;
+static bench_storage_t shadow;
+
+static seqlock_datastream_t seqlock;
+static ram_datastream_t ram;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_bool done;
+
+typedef struct {
+  void (*read)(sample_t* out);
+  uint64_t reads;
+} reader_t;
+
+static void seqlock_read(sample_t* out)
+{
+  datastream_read(&seqlock.interface, KEY_SAMPLE, out);
+}
+
+static void seqlock_write(const sample_t* sample)
+{
+  datastream_write(&seqlock.interface, KEY_SAMPLE, sample);
+}
+
+// Before: the plain ram_datastream made thread-safe the usual way, one mutex around every call.
+static void locked_read(sample_t* out)
+{
+  pthread_mutex_lock(&lock);
+  datastream_read(&ram.interface, KEY_SAMPLE, out);
+  pthread_mutex_unlock(&lock);
+}
+
+static void locked_write(const sample_t* sample)
+{
+  pthread_mutex_lock(&lock);
+  datastream_write(&ram.interface, KEY_SAMPLE, sample);
+  pthread_mutex_unlock(&lock);
+}
+
+static void* reader(void* arg)
+{
+  reader_t* own = (reader_t*)arg;
+  sample_t sample;
+
+  while(!atomic_load_explicit(&done, memory_order_relaxed)) {
+    own->read(&sample);
+    own->reads++;
+  }
+
+  BENCH_DO_NOT_OPTIMIZE(sample);
+  return NULL;
+}
+
+static void run(const char* label, uint32_t reader_count, void (*read)(sample_t*), void (*write)(const sample_t*))
+{
+  pthread_t threads[MAX_READERS];
+  reader_t readers[MAX_READERS];
+  char line[64];
+
+  atomic_store(&done, false);
+  for(uint32_t r = 0; r < reader_count; r++) {
+    readers[r] = (reader_t){ .read = read, .reads = 0 };
+    pthread_create(&threads[r], NULL, reader, &readers[r]);
+  }
+
+  uint64_t start = bench_now_ns();
+  for(uint64_t i = 1; i <= WRITES; i++) {
+    sample_t sample;
+    for(uint32_t w = 0; w < NUM_ELEMENTS(sample.words); w++) {
+      sample.words[w] = i;
+    }
+    write(&sample);
+  }
+  uint64_t elapsed = bench_now_ns() - start;
+  atomic_store(&done, true);
+
+  uint64_t reads = 0;
+  for(uint32_t r = 0; r < reader_count; r++) {
+    pthread_join(threads[r], NULL);
+    reads += readers[r].reads;
+  }
+
+  snprintf(line, sizeof(line), "%s writes", label);
+  bench_report_throughput(line, reader_count, elapsed, WRITES);
+  snprintf(line, sizeof(line), "%s reads", label);
+  bench_report_throughput(line, reader_count, elapsed, reads);
+}
+
+int main(void)
+{
+  const uint32_t reader_counts[] = { 1, 2, 4, MAX_READERS };
+
+  for(uint32_t i = 0; i < NUM_ELEMENTS(reader_counts); i++) {
+    ram_datastream_init(&ram, &config, &storage);
+    run("ram_datastream + pthread mutex", reader_counts[i], locked_read, locked_write);
+
+    seqlock_datastream_init(&seqlock, &config, &storage, &shadow);
+    run("seqlock_datastream", reader_counts[i], seqlock_read, seqlock_write);
+    printf("%-40s n=%-6u %10u\n", "seqlock_datastream retried reads", (unsigned)reader_counts[i], (unsigned)seqlock_datastream_retries(&seqlock));
+  }
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// C11 atomics for shared state in core headers. C++ translation units (the test suite)
+// only need a layout-compatible declaration, so they see std::atomic instead.
+#ifdef __cplusplus
+extern "C++" {
+#include <atomic>
+}
+#define SIERA_ATOMIC(type) std::atomic<type>
+#define SIERA_ATOMIC_FLAG std::atomic_flag
+#else
+#include <stdatomic.h>
+#define SIERA_ATOMIC(type) _Atomic(type)
+#define SIERA_ATOMIC_FLAG atomic_flag
+#endif
@@ -0,0 +1,73 @@
+#include "arena.h"
+
+void arena_init(arena_t* arena, void* buffer, size_t capacity)
+{
+  arena->buffer = (uint8_t*)buffer;
+  arena->capacity = capacity;
+  arena->offset = 0;
+  arena->peak = 0;
+  arena->failed_allocations = 0;
+}
+
+void* arena_alloc_aligned(arena_t* arena, size_t size, size_t alignment)
+{
+  uintptr_t current = (uintptr_t)(arena->buffer + arena->offset);
+  size_t padding = (size_t)(-current & (alignment - 1));
+
+  if(padding > arena->capacity - arena->offset ||
+    size > arena->capacity - arena->offset - padding) {
+    arena->failed_allocations++;
+    return NULL;
+  }
+
+  void* allocation = arena->buffer + arena->offset + padding;
+  arena->offset += padding + size;
+
+  if(arena->offset > arena->peak) {
+    arena->peak = arena->offset;
+  }
+
+  return allocation;
+}
+
+void* arena_alloc(arena_t* arena, size_t size)
+{
+  return arena_alloc_aligned(arena, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+arena_mark_t arena_mark(const arena_t* arena)
+{
+  return arena->offset;
+}
+
+void arena_rewind(arena_t* arena, arena_mark_t mark)
+{
+  if(mark <= arena->offset) {
+    arena->offset = mark;
+  }
+}
+
+void arena_reset(arena_t* arena)
+{
+  arena->offset = 0;
+}
+
+size_t arena_used(const arena_t* arena)
+{
+  return arena->offset;
+}
+
+size_t arena_remaining(const arena_t* arena)
+{
+  return arena->capacity - arena->offset;
+}
+
+size_t arena_peak(const arena_t* arena)
+{
+  return arena->peak;
+}
+
+uint32_t arena_failed_allocations(const arena_t* arena)
+{
+  return arena->failed_allocations;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_DEFAULT_ALIGNMENT sizeof(uint64_t)
+
+/**
+ * Bump allocator over a caller-provided buffer. Allocations are never freed
+ * individually; the whole arena is reset, or rewound to a mark, at once.
+ */
+typedef struct {
+  uint8_t* buffer;
+  size_t capacity;
+  size_t offset;
+  size_t peak;
+  uint32_t failed_allocations;
+} arena_t;
+
+typedef size_t arena_mark_t;
+
+/**
+ * @brief
+ *
+ * @param arena
+ * @param buffer
+ * @param capacity Size of buffer in bytes.
+ */
+void arena_init(arena_t* arena, void* buffer, size_t capacity);
+
+/**
+ * @brief Allocate size bytes aligned to ARENA_DEFAULT_ALIGNMENT.
+ *
+ * @return void* The allocation, or NULL if the arena does not have room.
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/**
+ * @brief Allocate size bytes at the given alignment.
+ *
+ * @param arena
+ * @param size
+ * @param alignment Must be a power of two.
+ * @return void* The allocation, or NULL if the arena does not have room.
+ */
+void* arena_alloc_aligned(arena_t* arena, size_t size, size_t alignment);
+
+/**
+ * @brief Capture the current fill level so that later allocations can be discarded
+ * with arena_rewind().
+ */
+arena_mark_t arena_mark(const arena_t* arena);
+
+/**
+ * @brief Discard every allocation made after mark was taken.
+ */
+void arena_rewind(arena_t* arena, arena_mark_t mark);
+
+/**
+ * @brief Discard every allocation. Peak usage is kept.
+ */
+void arena_reset(arena_t* arena);
+
+size_t arena_used(const arena_t* arena);
+size_t arena_remaining(const arena_t* arena);
+
+/**
+ * @brief Highest fill level reached since init, for sizing the backing buffer.
+ */
+size_t arena_peak(const arena_t* arena);
+
+/**
+ * @brief Number of allocations that returned NULL.
+ */
+uint32_t arena_failed_allocations(const arena_t* arena);
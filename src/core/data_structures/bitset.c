@@ -0,0 +1,113 @@
+#include "bitset.h"
+
+static uint16_t word_count(const bitset_t* bitset)
+{
+  return (uint16_t)BITSET_WORDS((uint32_t)bitset->bit_count);
+}
+
+// Bits of the last word that lie beyond bit_count must stay clear for count/next.
+static bitset_word_t last_word_mask(const bitset_t* bitset)
+{
+  uint16_t used = bitset->bit_count % BITSET_WORD_BITS;
+  return used == 0 ? ~(bitset_word_t)0 : ((bitset_word_t)1u << used) - 1u;
+}
+
+void bitset_init(bitset_t* bitset, bitset_word_t* words, uint16_t bit_count)
+{
+  bitset->words = words;
+  bitset->bit_count = bit_count;
+  bitset_clear_all(bitset);
+}
+
+void bitset_clear_all(bitset_t* bitset)
+{
+  for(uint16_t i = 0; i < word_count(bitset); i++) {
+    bitset->words[i] = 0;
+  }
+}
+
+void bitset_set_all(bitset_t* bitset)
+{
+  uint16_t words = word_count(bitset);
+
+  for(uint16_t i = 0; i < words; i++) {
+    bitset->words[i] = ~(bitset_word_t)0;
+  }
+
+  if(words > 0) {
+    bitset->words[words - 1] &= last_word_mask(bitset);
+  }
+}
+
+void bitset_and(bitset_t* destination, const bitset_t* source)
+{
+  for(uint16_t i = 0; i < word_count(destination); i++) {
+    destination->words[i] &= source->words[i];
+  }
+}
+
+void bitset_or(bitset_t* destination, const bitset_t* source)
+{
+  for(uint16_t i = 0; i < word_count(destination); i++) {
+    destination->words[i] |= source->words[i];
+  }
+}
+
+void bitset_and_not(bitset_t* destination, const bitset_t* source)
+{
+  for(uint16_t i = 0; i < word_count(destination); i++) {
+    destination->words[i] &= ~source->words[i];
+  }
+}
+
+bool bitset_intersects(const bitset_t* a, const bitset_t* b)
+{
+  for(uint16_t i = 0; i < word_count(a); i++) {
+    if(a->words[i] & b->words[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool bitset_is_empty(const bitset_t* bitset)
+{
+  for(uint16_t i = 0; i < word_count(bitset); i++) {
+    if(bitset->words[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint16_t bitset_count(const bitset_t* bitset)
+{
+  uint16_t count = 0;
+
+  for(uint16_t i = 0; i < word_count(bitset); i++) {
+    count += (uint16_t)__builtin_popcount(bitset->words[i]);
+  }
+
+  return count;
+}
+
+uint16_t bitset_next(const bitset_t* bitset, uint16_t start)
+{
+  if(start >= bitset->bit_count) {
+    return BITSET_NONE;
+  }
+
+  uint16_t word = start / BITSET_WORD_BITS;
+  bitset_word_t bits = bitset->words[word] & (~(bitset_word_t)0 << (start % BITSET_WORD_BITS));
+
+  while(bits == 0) {
+    word++;
+    if(word >= word_count(bitset)) {
+      return BITSET_NONE;
+    }
+    bits = bitset->words[word];
+  }
+
+  uint32_t index = (uint32_t)word * BITSET_WORD_BITS + (uint32_t)__builtin_ctz(bits);
+  return index < bitset->bit_count ? (uint16_t)index : BITSET_NONE;
+}
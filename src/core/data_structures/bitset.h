@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t bitset_word_t;
+
+#define BITSET_WORD_BITS 32u
+#define BITSET_WORDS(bit_count) (((bit_count) + BITSET_WORD_BITS - 1u) / BITSET_WORD_BITS)
+#define BITSET_NONE UINT16_MAX
+
+/**
+ * Declares the word storage for a set of bit_count bits, e.g. one bit per datastream key:
+ *
+ * static BITSET_STORAGE(dirty_words, DATABASE_KEY_COUNT(DATABASE_ENTRIES));
+ */
+#define BITSET_STORAGE(name, bit_count) bitset_word_t name[BITSET_WORDS(bit_count)]
+
+typedef struct {
+  bitset_word_t* words;
+  uint16_t bit_count;
+} bitset_t;
+
+/**
+ * @brief Initialize an empty set over caller-provided storage (see BITSET_STORAGE).
+ *
+ * @param bitset
+ * @param words
+ * @param bit_count
+ */
+void bitset_init(bitset_t* bitset, bitset_word_t* words, uint16_t bit_count);
+
+static inline void bitset_set(bitset_t* bitset, uint16_t index)
+{
+  bitset->words[index / BITSET_WORD_BITS] |= (bitset_word_t)1u << (index % BITSET_WORD_BITS);
+}
+
+static inline void bitset_clear(bitset_t* bitset, uint16_t index)
+{
+  bitset->words[index / BITSET_WORD_BITS] &= ~((bitset_word_t)1u << (index % BITSET_WORD_BITS));
+}
+
+static inline bool bitset_test(const bitset_t* bitset, uint16_t index)
+{
+  return (bitset->words[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1u;
+}
+
+void bitset_clear_all(bitset_t* bitset);
+void bitset_set_all(bitset_t* bitset);
+
+/**
+ * @brief destination &= source, a word at a time. Both sets must have the same size.
+ */
+void bitset_and(bitset_t* destination, const bitset_t* source);
+
+/**
+ * @brief destination |= source, a word at a time. Both sets must have the same size.
+ */
+void bitset_or(bitset_t* destination, const bitset_t* source);
+
+/**
+ * @brief destination &= ~source, a word at a time. Both sets must have the same size.
+ */
+void bitset_and_not(bitset_t* destination, const bitset_t* source);
+
+/**
+ * @brief
+ *
+ * @return true if the two sets share at least one bit.
+ */
+bool bitset_intersects(const bitset_t* a, const bitset_t* b);
+
+bool bitset_is_empty(const bitset_t* bitset);
+
+/**
+ * @brief Number of set bits.
+ */
+uint16_t bitset_count(const bitset_t* bitset);
+
+/**
+ * @brief Find the first set bit at or after start, skipping clear words entirely.
+ *
+ * @return uint16_t The bit index, or BITSET_NONE if there is none.
+ */
+uint16_t bitset_next(const bitset_t* bitset, uint16_t start);
+
+#define bitset_for_each(bitset, index)                                   \
+  for(uint16_t index = bitset_next((bitset), 0); index != BITSET_NONE; \
+    index = bitset_next((bitset), (uint16_t)(index + 1u)))
@@ -0,0 +1,111 @@
+#include "dlist.h"
+
+void dlist_init(dlist_t* list)
+{
+  list->head = NULL;
+  list->tail = NULL;
+}
+
+void dlist_node_init(dlist_node_t* node)
+{
+  node->next = NULL;
+  node->prev = NULL;
+  node->owner = NULL;
+}
+
+void dlist_push_front(dlist_t* list, dlist_node_t* node)
+{
+  node->prev = NULL;
+  node->next = list->head;
+  node->owner = list;
+
+  if(list->head == NULL) {
+    list->tail = node;
+  }
+  else {
+    list->head->prev = node;
+  }
+
+  list->head = node;
+}
+
+void dlist_push_back(dlist_t* list, dlist_node_t* node)
+{
+  node->next = NULL;
+  node->prev = list->tail;
+  node->owner = list;
+
+  if(list->tail == NULL) {
+    list->head = node;
+  }
+  else {
+    list->tail->next = node;
+  }
+
+  list->tail = node;
+}
+
+bool dlist_contains(const dlist_t* list, const dlist_node_t* node)
+{
+  return node->owner == list;
+}
+
+void dlist_insert_after(dlist_t* list, dlist_node_t* position, dlist_node_t* node)
+{
+  if(position == NULL) {
+    dlist_push_front(list, node);
+    return;
+  }
+
+  node->prev = position;
+  node->next = position->next;
+  node->owner = list;
+
+  if(position->next == NULL) {
+    list->tail = node;
+  }
+  else {
+    position->next->prev = node;
+  }
+
+  position->next = node;
+}
+
+void dlist_remove(dlist_t* list, dlist_node_t* node)
+{
+  if(!dlist_contains(list, node)) {
+    return;
+  }
+
+  if(node->prev == NULL) {
+    list->head = node->next;
+  }
+  else {
+    node->prev->next = node->next;
+  }
+
+  if(node->next == NULL) {
+    list->tail = node->prev;
+  }
+  else {
+    node->next->prev = node->prev;
+  }
+
+  dlist_node_init(node);
+}
+
+dlist_node_t* dlist_pop_front(dlist_t* list)
+{
+  dlist_node_t* node = list->head;
+
+  if(node != NULL) {
+    dlist_remove(list, node);
+  }
+
+  return node;
+}
+
+bool dlist_is_empty(const dlist_t* list)
+{
+  return list->head == NULL;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct dlist_t;
+
+/**
+ * owner is the list the node is linked into, or NULL while it is unlinked. It lets
+ * dlist_contains() and dlist_remove() tell a node of this list from a node of another.
+ */
+typedef struct dlist_node_t {
+  struct dlist_node_t* next;
+  struct dlist_node_t* prev;
+  struct dlist_t* owner;
+} dlist_node_t;
+
+typedef struct dlist_t {
+  dlist_node_t* head;
+  dlist_node_t* tail;
+} dlist_t;
+
+/**
+ * @brief Initialize an empty list.
+ *
+ * @param list
+ */
+void dlist_init(dlist_t* list);
+
+/**
+ * @brief Reset a node to the unlinked state. Removing an unlinked node is a no-op.
+ *
+ * @param node
+ */
+void dlist_node_init(dlist_node_t* node);
+
+/**
+ * @brief Insert a node at the head of the list. O(1).
+ *
+ * @param list
+ * @param node
+ */
+void dlist_push_front(dlist_t* list, dlist_node_t* node);
+
+/**
+ * @brief Append a node at the tail of the list. O(1).
+ *
+ * @param list
+ * @param node
+ */
+void dlist_push_back(dlist_t* list, dlist_node_t* node);
+
+/**
+ * @brief Insert a node directly after position, or at the head if position is NULL. O(1).
+ *
+ * @param list
+ * @param position A node already in list, or NULL.
+ * @param node
+ */
+void dlist_insert_after(dlist_t* list, dlist_node_t* position, dlist_node_t* node);
+
+/**
+ * @brief Unlink a node from the list. O(1). Does nothing if the node is not linked into
+ * this list, including when it is linked into another one.
+ *
+ * @param list
+ * @param node
+ */
+void dlist_remove(dlist_t* list, dlist_node_t* node);
+
+/**
+ * @brief Check whether a node is linked into this list. O(1). The node must have been
+ * initialized or linked at some point.
+ *
+ * @param list
+ * @param node
+ * @return true
+ * @return false
+ */
+bool dlist_contains(const dlist_t* list, const dlist_node_t* node);
+
+/**
+ * @brief Unlink and return the head of the list.
+ *
+ * @param list
+ * @return dlist_node_t* The former head, or NULL if the list is empty.
+ */
+dlist_node_t* dlist_pop_front(dlist_t* list);
+
+/**
+ * @brief
+ *
+ * @param list
+ * @return true
+ * @return false
+ */
+bool dlist_is_empty(const dlist_t* list);
+
+#define dlist_for_each(list, iterator)                         \
+  for(dlist_node_t* iterator = (list)->head; iterator != NULL; \
+    iterator = iterator->next)
+
+/**
+ * Iterates while allowing the current node to be removed from within the loop body.
+ */
+#define dlist_for_each_safe(list, iterator, next_node)                                       \
+  for(dlist_node_t *iterator = (list)->head, *next_node = iterator ? iterator->next : NULL; \
+    iterator != NULL;                                                                       \
+    iterator = next_node, next_node = iterator ? iterator->next : NULL)
@@ -0,0 +1,152 @@
+#include "hash_map.h"
+
+#include <stddef.h>
+
+// distance is the probe length + 1, so 0 marks an empty slot.
+enum {
+  EMPTY = 0,
+};
+
+static uint16_t home(const hash_map_t* map, uint16_t key)
+{
+  // Fibonacci hashing: vendor key IDs are often clustered or strided, so spread them
+  // with a multiply and keep the well-mixed high bits.
+  return (uint16_t)(((uint32_t)key * 2654435769u) >> map->shift);
+}
+
+static int32_t find_slot(const hash_map_t* map, uint16_t key)
+{
+  uint16_t index = home(map, key);
+
+  for(uint16_t distance = 1;; distance++) {
+    const hash_map_slot_t* slot = &map->slots[index];
+
+    // Robin Hood invariant: once a resident is closer to home than we would be, the
+    // key cannot be further along.
+    if(slot->distance < distance) {
+      return -1;
+    }
+    if(slot->key == key) {
+      return index;
+    }
+
+    index = (index + 1) & map->mask;
+  }
+}
+
+bool hash_map_init(hash_map_t* map, hash_map_slot_t* slots, uint16_t capacity)
+{
+  if(capacity < 2 || (capacity & (capacity - 1)) != 0) {
+    return false;
+  }
+
+  uint8_t bits = 0;
+  while((1u << bits) < capacity) {
+    bits++;
+  }
+
+  map->slots = slots;
+  map->mask = capacity - 1;
+  map->shift = (uint8_t)(32 - bits);
+  hash_map_clear(map);
+
+  return true;
+}
+
+bool hash_map_put(hash_map_t* map, uint16_t key, void* value)
+{
+  int32_t existing = find_slot(map, key);
+  if(existing >= 0) {
+    map->slots[existing].value = value;
+    return true;
+  }
+
+  if(map->count > map->mask) {
+    return false;
+  }
+
+  hash_map_slot_t incoming = { .key = key, .distance = 1, .value = value };
+  uint16_t index = home(map, key);
+
+  while(true) {
+    hash_map_slot_t* slot = &map->slots[index];
+
+    if(slot->distance == EMPTY) {
+      *slot = incoming;
+      map->count++;
+      return true;
+    }
+
+    // Take from the rich: a resident closer to its home gives up its slot and moves on.
+    if(slot->distance < incoming.distance) {
+      hash_map_slot_t displaced = *slot;
+      *slot = incoming;
+      incoming = displaced;
+    }
+
+    index = (index + 1) & map->mask;
+    incoming.distance++;
+  }
+}
+
+bool hash_map_get(const hash_map_t* map, uint16_t key, void** value)
+{
+  int32_t index = find_slot(map, key);
+
+  if(index < 0) {
+    return false;
+  }
+
+  if(value != NULL) {
+    *value = map->slots[index].value;
+  }
+
+  return true;
+}
+
+bool hash_map_contains(const hash_map_t* map, uint16_t key)
+{
+  return find_slot(map, key) >= 0;
+}
+
+bool hash_map_remove(hash_map_t* map, uint16_t key)
+{
+  int32_t found = find_slot(map, key);
+  if(found < 0) {
+    return false;
+  }
+
+  // Backward-shift the following cluster instead of leaving a tombstone.
+  uint16_t index = (uint16_t)found;
+  uint16_t next = (index + 1) & map->mask;
+
+  while(map->slots[next].distance > 1) {
+    map->slots[index] = map->slots[next];
+    map->slots[index].distance--;
+    index = next;
+    next = (next + 1) & map->mask;
+  }
+
+  map->slots[index].distance = EMPTY;
+  map->count--;
+
+  return true;
+}
+
+void hash_map_clear(hash_map_t* map)
+{
+  for(uint32_t i = 0; i <= map->mask; i++) {
+    map->slots[i].distance = EMPTY;
+  }
+  map->count = 0;
+}
+
+uint16_t hash_map_count(const hash_map_t* map)
+{
+  return map->count;
+}
+
+uint16_t hash_map_capacity(const hash_map_t* map)
+{
+  return (uint16_t)(map->mask + 1u);
+}
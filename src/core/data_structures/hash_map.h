@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint16_t key;
+  uint16_t distance;
+  void* value;
+} hash_map_slot_t;
+
+/**
+ * Fixed-capacity open-addressing map from sparse 16-bit keys to pointers (or indices
+ * cast through uintptr_t). Uses Robin Hood probing with backward-shift deletion so probe
+ * sequences stay short at high load. All storage is caller-provided.
+ */
+typedef struct {
+  hash_map_slot_t* slots;
+  uint16_t mask;
+  uint8_t shift;
+  uint16_t count;
+} hash_map_t;
+
+#define HASH_MAP_STORAGE(name, capacity) hash_map_slot_t name[capacity]
+
+/**
+ * @brief Initialize an empty map over caller-provided slots (see HASH_MAP_STORAGE).
+ *
+ * @param map
+ * @param slots
+ * @param capacity Number of slots; must be a power of two between 2 and 32768.
+ * @return false if capacity is not supported.
+ */
+bool hash_map_init(hash_map_t* map, hash_map_slot_t* slots, uint16_t capacity);
+
+/**
+ * @brief Insert a key, or replace its value if it is already present.
+ *
+ * @return false if the key is new and every slot is in use.
+ */
+bool hash_map_put(hash_map_t* map, uint16_t key, void* value);
+
+/**
+ * @brief Look up a key.
+ *
+ * @param map
+ * @param key
+ * @param value Receives the stored value if found; may be NULL.
+ * @return true if the key is present.
+ */
+bool hash_map_get(const hash_map_t* map, uint16_t key, void** value);
+
+bool hash_map_contains(const hash_map_t* map, uint16_t key);
+
+/**
+ * @brief Remove a key if present.
+ *
+ * @return true if the key was removed.
+ */
+bool hash_map_remove(hash_map_t* map, uint16_t key);
+
+void hash_map_clear(hash_map_t* map);
+
+uint16_t hash_map_count(const hash_map_t* map);
+uint16_t hash_map_capacity(const hash_map_t* map);
@@ -0,0 +1,128 @@
+#include "heap.h"
+
+#include <stddef.h>
+
+static void place(heap_t* heap, heap_node_t* node, uint16_t index)
+{
+  heap->nodes[index] = node;
+  node->index = index;
+}
+
+static void sift_up(heap_t* heap, uint16_t index)
+{
+  heap_node_t* node = heap->nodes[index];
+
+  while(index > 0) {
+    uint16_t parent = (uint16_t)((index - 1) / 2);
+    if(!heap->less(node, heap->nodes[parent])) {
+      break;
+    }
+    place(heap, heap->nodes[parent], index);
+    index = parent;
+  }
+
+  place(heap, node, index);
+}
+
+static void sift_down(heap_t* heap, uint16_t index)
+{
+  heap_node_t* node = heap->nodes[index];
+
+  while(true) {
+    uint32_t child = 2u * index + 1u;
+    if(child >= heap->count) {
+      break;
+    }
+    if(child + 1u < heap->count && heap->less(heap->nodes[child + 1u], heap->nodes[child])) {
+      child++;
+    }
+    if(!heap->less(heap->nodes[child], node)) {
+      break;
+    }
+    place(heap, heap->nodes[child], index);
+    index = (uint16_t)child;
+  }
+
+  place(heap, node, index);
+}
+
+void heap_init(heap_t* heap, heap_node_t** storage, uint16_t capacity, heap_less_t less)
+{
+  heap->nodes = storage;
+  heap->capacity = capacity;
+  heap->count = 0;
+  heap->less = less;
+}
+
+bool heap_insert(heap_t* heap, heap_node_t* node)
+{
+  if(heap->count == heap->capacity) {
+    return false;
+  }
+
+  place(heap, node, heap->count);
+  heap->count++;
+  sift_up(heap, node->index);
+
+  return true;
+}
+
+heap_node_t* heap_peek(const heap_t* heap)
+{
+  return heap->count > 0 ? heap->nodes[0] : NULL;
+}
+
+heap_node_t* heap_pop(heap_t* heap)
+{
+  heap_node_t* first = heap_peek(heap);
+
+  if(first != NULL) {
+    heap_remove(heap, first);
+  }
+
+  return first;
+}
+
+void heap_remove(heap_t* heap, heap_node_t* node)
+{
+  if(!heap_contains(heap, node)) {
+    return;
+  }
+
+  uint16_t index = node->index;
+  heap->count--;
+
+  if(index != heap->count) {
+    place(heap, heap->nodes[heap->count], index);
+    heap_update(heap, heap->nodes[index]);
+  }
+
+  heap->nodes[heap->count] = NULL;
+}
+
+void heap_update(heap_t* heap, heap_node_t* node)
+{
+  uint16_t index = node->index;
+
+  if(index > 0 && heap->less(node, heap->nodes[(index - 1) / 2])) {
+    sift_up(heap, index);
+  }
+  else {
+    sift_down(heap, index);
+  }
+}
+
+bool heap_contains(const heap_t* heap, const heap_node_t* node)
+{
+  return node->index < heap->count && heap->nodes[node->index] == node;
+}
+
+uint16_t heap_count(const heap_t* heap)
+{
+  return heap->count;
+}
+
+bool heap_is_empty(const heap_t* heap)
+{
+  return heap->count == 0;
+}
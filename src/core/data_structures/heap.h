@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct heap_node_t {
+  uint16_t index;
+} heap_node_t;
+
+/**
+ * Ordering for the heap: return true if a must come out before b.
+ */
+typedef bool (*heap_less_t)(const heap_node_t* a, const heap_node_t* b);
+
+/**
+ * Intrusive binary min-heap. Nodes are embedded in the caller's structs; the heap only
+ * stores pointers to them in a caller-provided array and records each node's slot in
+ * the node, which makes membership tests O(1) and removal of arbitrary nodes O(log n).
+ */
+typedef struct {
+  heap_node_t** nodes;
+  uint16_t capacity;
+  uint16_t count;
+  heap_less_t less;
+} heap_t;
+
+/**
+ * @brief
+ *
+ * @param heap
+ * @param storage Array of capacity node pointers.
+ * @param capacity
+ * @param less
+ */
+void heap_init(heap_t* heap, heap_node_t** storage, uint16_t capacity, heap_less_t less);
+
+/**
+ * @brief Insert a node. O(log n).
+ *
+ * @return false if the heap is full.
+ */
+bool heap_insert(heap_t* heap, heap_node_t* node);
+
+/**
+ * @brief O(1).
+ *
+ * @return heap_node_t* The first node in order, or NULL if the heap is empty.
+ */
+heap_node_t* heap_peek(const heap_t* heap);
+
+/**
+ * @brief Remove and return the first node in order. O(log n).
+ *
+ * @return heap_node_t* The removed node, or NULL if the heap is empty.
+ */
+heap_node_t* heap_pop(heap_t* heap);
+
+/**
+ * @brief Remove a node from anywhere in the heap. O(log n). Does nothing if the node
+ * is not in the heap.
+ */
+void heap_remove(heap_t* heap, heap_node_t* node);
+
+/**
+ * @brief Restore ordering after the key of a node in the heap changed, in either
+ * direction (decrease-key or increase-key). O(log n).
+ */
+void heap_update(heap_t* heap, heap_node_t* node);
+
+/**
+ * @brief O(1).
+ */
+bool heap_contains(const heap_t* heap, const heap_node_t* node);
+
+uint16_t heap_count(const heap_t* heap);
+bool heap_is_empty(const heap_t* heap);
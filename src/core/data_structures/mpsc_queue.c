@@ -0,0 +1,59 @@
+#include "mpsc_queue.h"
+
+void mpsc_queue_init(mpsc_queue_t* queue)
+{
+  atomic_init(&queue->stub.next, NULL);
+  atomic_init(&queue->tail, &queue->stub);
+  queue->head = &queue->stub;
+}
+
+void mpsc_queue_push(mpsc_queue_t* queue, mpsc_node_t* node)
+{
+  atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+  mpsc_node_t* prev = atomic_exchange_explicit(&queue->tail, node, memory_order_acq_rel);
+  atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+mpsc_node_t* mpsc_queue_pop(mpsc_queue_t* queue)
+{
+  mpsc_node_t* head = queue->head;
+  mpsc_node_t* next = atomic_load_explicit(&head->next, memory_order_acquire);
+
+  if(head == &queue->stub) {
+    if(next == NULL) {
+      return NULL;
+    }
+    queue->head = next;
+    head = next;
+    next = atomic_load_explicit(&head->next, memory_order_acquire);
+  }
+
+  if(next != NULL) {
+    queue->head = next;
+    return head;
+  }
+
+  // head is the last linked node. Unless a producer is mid-push, re-queue the stub
+  // behind it so head can be handed out without leaving the queue without a node.
+  if(head != atomic_load_explicit(&queue->tail, memory_order_acquire)) {
+    return NULL;
+  }
+
+  mpsc_queue_push(queue, &queue->stub);
+
+  next = atomic_load_explicit(&head->next, memory_order_acquire);
+  if(next != NULL) {
+    queue->head = next;
+    return head;
+  }
+
+  return NULL;
+}
+
+bool mpsc_queue_is_empty(mpsc_queue_t* queue)
+{
+  mpsc_node_t* head = queue->head;
+  return head == &queue->stub &&
+    atomic_load_explicit(&head->next, memory_order_acquire) == NULL &&
+    atomic_load_explicit(&queue->tail, memory_order_acquire) == head;
+}
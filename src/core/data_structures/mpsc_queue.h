@@ -0,0 +1,55 @@
+#pragma once
+
+#include "atomic_utils.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct mpsc_node_t {
+  SIERA_ATOMIC(struct mpsc_node_t*) next;
+} mpsc_node_t;
+
+/**
+ * Intrusive multi-producer/single-consumer FIFO (Vyukov). Any number of threads or
+ * cores may push concurrently with a single atomic exchange and no allocation; only
+ * one context may pop.
+ */
+typedef struct {
+  SIERA_ATOMIC(mpsc_node_t*) tail;
+  mpsc_node_t* head;
+  mpsc_node_t stub;
+} mpsc_queue_t;
+
+/**
+ * @brief
+ *
+ * @param queue
+ */
+void mpsc_queue_init(mpsc_queue_t* queue);
+
+/**
+ * @brief Producer side. Append a node. Wait-free; safe from any thread.
+ *
+ * @param queue
+ * @param node Must not already be queued.
+ */
+void mpsc_queue_push(mpsc_queue_t* queue, mpsc_node_t* node);
+
+/**
+ * @brief Consumer side. Remove the oldest node.
+ *
+ * May return NULL while a producer is between its exchange and its link store even
+ * though a node is on the way; the consumer simply picks it up on a later call.
+ *
+ * @param queue
+ * @return mpsc_node_t* The oldest node, or NULL if none is ready.
+ */
+mpsc_node_t* mpsc_queue_pop(mpsc_queue_t* queue);
+
+/**
+ * @brief Consumer side.
+ *
+ * @param queue
+ * @return true if no node has been pushed since the last pop emptied the queue.
+ */
+bool mpsc_queue_is_empty(mpsc_queue_t* queue);
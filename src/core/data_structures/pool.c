@@ -0,0 +1,121 @@
+#include "pool.h"
+
+static void lock(pool_t* pool)
+{
+  if(pool->thread_safe) {
+    while(atomic_flag_test_and_set_explicit(&pool->lock, memory_order_acquire)) {
+    }
+  }
+}
+
+static void unlock(pool_t* pool)
+{
+  if(pool->thread_safe) {
+    atomic_flag_clear_explicit(&pool->lock, memory_order_release);
+  }
+}
+
+void pool_init(pool_t* pool, void* buffer, size_t block_size, uint16_t count)
+{
+  pool->buffer = (uint8_t*)buffer;
+  pool->block_size = POOL_BLOCK_SIZE(block_size);
+  pool->capacity = count;
+  pool->used = 0;
+  pool->high_water_mark = 0;
+  pool->failed_allocations = 0;
+  pool->thread_safe = false;
+  atomic_flag_clear(&pool->lock);
+
+  pool->free_list = NULL;
+  for(uint16_t i = count; i > 0; i--) {
+    pool_block_t* block = (pool_block_t*)(pool->buffer + (size_t)(i - 1) * pool->block_size);
+    block->next = pool->free_list;
+    pool->free_list = block;
+  }
+}
+
+void pool_init_thread_safe(pool_t* pool, void* buffer, size_t block_size, uint16_t count)
+{
+  pool_init(pool, buffer, block_size, count);
+  pool->thread_safe = true;
+}
+
+void* pool_alloc(pool_t* pool)
+{
+  lock(pool);
+
+  pool_block_t* block = pool->free_list;
+
+  if(block == NULL) {
+    pool->failed_allocations++;
+  }
+  else {
+    pool->free_list = block->next;
+    pool->used++;
+    if(pool->used > pool->high_water_mark) {
+      pool->high_water_mark = pool->used;
+    }
+  }
+
+  unlock(pool);
+
+  return block;
+}
+
+void pool_free(pool_t* pool, void* block)
+{
+  if(block == NULL) {
+    return;
+  }
+
+  lock(pool);
+
+  pool_block_t* node = (pool_block_t*)block;
+  node->next = pool->free_list;
+  pool->free_list = node;
+  pool->used--;
+
+  unlock(pool);
+}
+
+bool pool_owns(const pool_t* pool, const void* block)
+{
+  const uint8_t* address = (const uint8_t*)block;
+  const uint8_t* end = pool->buffer + (size_t)pool->capacity * pool->block_size;
+
+  return address >= pool->buffer && address < end &&
+    (size_t)(address - pool->buffer) % pool->block_size == 0;
+}
+
+uint16_t pool_capacity(const pool_t* pool)
+{
+  return pool->capacity;
+}
+
+uint16_t pool_used(const pool_t* pool)
+{
+  return pool->used;
+}
+
+uint16_t pool_available(const pool_t* pool)
+{
+  return pool->capacity - pool->used;
+}
+
+uint16_t pool_high_water_mark(const pool_t* pool)
+{
+  return pool->high_water_mark;
+}
+
+uint32_t pool_failed_allocations(const pool_t* pool)
+{
+  return pool->failed_allocations;
+}
+
+void pool_reset_statistics(pool_t* pool)
+{
+  lock(pool);
+  pool->high_water_mark = pool->used;
+  pool->failed_allocations = 0;
+  unlock(pool);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "atomic_utils.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_ALIGNMENT sizeof(uint64_t)
+
+/**
+ * Size actually reserved per block: at least one pointer (the free-list link lives in
+ * free blocks) and rounded up so every block is 8-byte aligned.
+ */
+#define POOL_BLOCK_SIZE(size) \
+  (((((size) < sizeof(void*)) ? sizeof(void*) : (size)) + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT)
+
+/**
+ * Declares a suitably aligned backing buffer for count blocks of block_size bytes.
+ *
+ * static POOL_BUFFER(timer_pool_buffer, sizeof(s_timer_t), 16);
+ */
+#define POOL_BUFFER(name, block_size, count) \
+  uint64_t name[POOL_BLOCK_SIZE(block_size) / sizeof(uint64_t) * (count)]
+
+typedef struct pool_block_t {
+  struct pool_block_t* next;
+} pool_block_t;
+
+/**
+ * Fixed-block allocator over a caller-provided static buffer. Allocation and release
+ * are O(1) pops and pushes on a free list threaded through the unused blocks, so there
+ * is no fragmentation and no heap use.
+ */
+typedef struct {
+  pool_block_t* free_list;
+  uint8_t* buffer;
+  size_t block_size;
+  uint16_t capacity;
+  uint16_t used;
+  uint16_t high_water_mark;
+  uint32_t failed_allocations;
+  bool thread_safe;
+  SIERA_ATOMIC_FLAG lock;
+} pool_t;
+
+/**
+ * @brief Initialize a pool over buffer, which must hold count blocks of
+ * POOL_BLOCK_SIZE(block_size) bytes (see POOL_BUFFER).
+ *
+ * @param pool
+ * @param buffer
+ * @param block_size Size of the object stored in each block.
+ * @param count Number of blocks.
+ */
+void pool_init(pool_t* pool, void* buffer, size_t block_size, uint16_t count);
+
+/**
+ * @brief Same as pool_init(), but alloc/free are serialized with a spin lock so threads
+ * on different cores can share the pool. Not for sharing between an ISR and the code it
+ * interrupts on a single core.
+ */
+void pool_init_thread_safe(pool_t* pool, void* buffer, size_t block_size, uint16_t count);
+
+/**
+ * @brief Take one block from the pool.
+ *
+ * @param pool
+ * @return void* The block, or NULL if the pool is exhausted.
+ */
+void* pool_alloc(pool_t* pool);
+
+/**
+ * @brief Return a block obtained from pool_alloc(). Freeing NULL does nothing.
+ *
+ * @param pool
+ * @param block
+ */
+void pool_free(pool_t* pool, void* block);
+
+/**
+ * @brief
+ *
+ * @param pool
+ * @param block
+ * @return true if block is the start of one of the pool's blocks.
+ */
+bool pool_owns(const pool_t* pool, const void* block);
+
+uint16_t pool_capacity(const pool_t* pool);
+uint16_t pool_used(const pool_t* pool);
+uint16_t pool_available(const pool_t* pool);
+
+/**
+ * @brief Largest number of blocks in use at once since init or the last reset.
+ */
+uint16_t pool_high_water_mark(const pool_t* pool);
+
+/**
+ * @brief Number of pool_alloc() calls that returned NULL.
+ */
+uint32_t pool_failed_allocations(const pool_t* pool);
+
+void pool_reset_statistics(pool_t* pool);
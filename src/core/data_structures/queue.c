@@ -1,17 +1,17 @@
-#include "list.h"
+#include "dlist.h"
 #include "queue.h"
 
 #include <stddef.h>
 
 void queue_init(queue_t* queue)
 {
-  list_init(&queue->list);
+  dlist_init(&queue->list);
   queue->size = 0;
 }
 
 void queue_enqueue(queue_t* queue, queue_node_t* node)
 {
-  list_push(&queue->list, node);
+  dlist_push_back(&queue->list, node);
   queue->size++;
 }
 
@@ -21,8 +21,7 @@ queue_node_t* queue_dequeue(queue_t* queue)
     return NULL;
   }
 
-  queue_node_t* node = queue->list.head;
-  list_delete(&queue->list, node);
+  queue_node_t* node = dlist_pop_front(&queue->list);
   queue->size--;
   return node;
 }
@@ -1,14 +1,14 @@
 #pragma once
 
-#include "list.h"
+#include "dlist.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 
-typedef list_node_t queue_node_t;
+typedef dlist_node_t queue_node_t;
 
 typedef struct {
-  list_t list;
+  dlist_t list;
   uint16_t size;
 } queue_t;
 
@@ -0,0 +1,163 @@
+#include "spsc_ring.h"
+
+#include <string.h>
+
+static uint8_t* slot(spsc_ring_t* ring, uint32_t index)
+{
+  return ring->buffer + (index & ring->mask) * ring->element_size;
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b)
+{
+  return a < b ? a : b;
+}
+
+bool spsc_ring_init(spsc_ring_t* ring, void* buffer, uint32_t element_size, uint32_t capacity)
+{
+  if(capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    return false;
+  }
+
+  ring->buffer = (uint8_t*)buffer;
+  ring->element_size = element_size;
+  ring->mask = capacity - 1;
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+
+  return true;
+}
+
+// Copies count elements starting at free-running index, splitting at the wrap point.
+static void copy_in(spsc_ring_t* ring, uint32_t index, const uint8_t* src, uint32_t count)
+{
+  uint32_t offset = index & ring->mask;
+  uint32_t first = min_u32(count, ring->mask + 1 - offset);
+
+  memcpy(slot(ring, index), src, first * ring->element_size);
+  memcpy(ring->buffer, src + first * ring->element_size, (count - first) * ring->element_size);
+}
+
+static void copy_out(spsc_ring_t* ring, uint32_t index, uint8_t* dst, uint32_t count)
+{
+  uint32_t offset = index & ring->mask;
+  uint32_t first = min_u32(count, ring->mask + 1 - offset);
+
+  memcpy(dst, slot(ring, index), first * ring->element_size);
+  memcpy(dst + first * ring->element_size, ring->buffer, (count - first) * ring->element_size);
+}
+
+uint32_t spsc_ring_push_n(spsc_ring_t* ring, const void* elements, uint32_t count)
+{
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  uint32_t space = ring->mask + 1 - (head - tail);
+
+  count = min_u32(count, space);
+  if(count == 0) {
+    return 0;
+  }
+
+  copy_in(ring, head, (const uint8_t*)elements, count);
+  atomic_store_explicit(&ring->head, head + count, memory_order_release);
+
+  return count;
+}
+
+uint32_t spsc_ring_pop_n(spsc_ring_t* ring, void* elements, uint32_t count)
+{
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  count = min_u32(count, head - tail);
+  if(count == 0) {
+    return 0;
+  }
+
+  copy_out(ring, tail, (uint8_t*)elements, count);
+  atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+
+  return count;
+}
+
+bool spsc_ring_push(spsc_ring_t* ring, const void* element)
+{
+  return spsc_ring_push_n(ring, element, 1) == 1;
+}
+
+bool spsc_ring_pop(spsc_ring_t* ring, void* element)
+{
+  return spsc_ring_pop_n(ring, element, 1) == 1;
+}
+
+uint32_t spsc_ring_write_region(spsc_ring_t* ring, void** region)
+{
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  uint32_t space = ring->mask + 1 - (head - tail);
+
+  *region = slot(ring, head);
+  return min_u32(space, ring->mask + 1 - (head & ring->mask));
+}
+
+void spsc_ring_write_commit(spsc_ring_t* ring, uint32_t count)
+{
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  atomic_store_explicit(&ring->head, head + count, memory_order_release);
+}
+
+uint32_t spsc_ring_read_region(spsc_ring_t* ring, const void** region)
+{
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  *region = slot(ring, tail);
+  return min_u32(head - tail, ring->mask + 1 - (tail & ring->mask));
+}
+
+void spsc_ring_read_commit(spsc_ring_t* ring, uint32_t count)
+{
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+}
+
+uint32_t spsc_ring_count(spsc_ring_t* ring)
+{
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  return head - tail;
+}
+
+uint32_t spsc_ring_space(spsc_ring_t* ring)
+{
+  return ring->mask + 1 - spsc_ring_count(ring);
+}
+
+uint32_t spsc_ring_capacity(const spsc_ring_t* ring)
+{
+  return ring->mask + 1;
+}
+
+bool spsc_ring_is_empty(spsc_ring_t* ring)
+{
+  return spsc_ring_count(ring) == 0;
+}
+
+bool spsc_byte_ring_init(spsc_byte_ring_t* ring, uint8_t* buffer, uint32_t capacity)
+{
+  return spsc_ring_init(&ring->ring, buffer, 1, capacity);
+}
+
+uint32_t spsc_byte_ring_write(spsc_byte_ring_t* ring, const uint8_t* data, uint32_t length)
+{
+  return spsc_ring_push_n(&ring->ring, data, length);
+}
+
+uint32_t spsc_byte_ring_read(spsc_byte_ring_t* ring, uint8_t* data, uint32_t length)
+{
+  return spsc_ring_pop_n(&ring->ring, data, length);
+}
+
+uint32_t spsc_byte_ring_count(spsc_byte_ring_t* ring)
+{
+  return spsc_ring_count(&ring->ring);
+}
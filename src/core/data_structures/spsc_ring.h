@@ -0,0 +1,123 @@
+#pragma once
+
+#include "atomic_utils.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer/single-consumer ring of fixed-size elements.
+ *
+ * One context (typically an ISR) may only push, and one other context (typically the
+ * main loop) may only pop. Neither side ever blocks or masks interrupts. Indices run
+ * freely and are masked on access, so capacity must be a power of two and all slots
+ * are usable.
+ */
+typedef struct {
+  uint8_t* buffer;
+  uint32_t element_size;
+  uint32_t mask;
+  SIERA_ATOMIC(uint32_t) head;
+  SIERA_ATOMIC(uint32_t) tail;
+} spsc_ring_t;
+
+/**
+ * Byte-oriented ring for stream data such as UART receive buffers.
+ */
+typedef struct {
+  spsc_ring_t ring;
+} spsc_byte_ring_t;
+
+/**
+ * @brief Initialize a ring over a caller-provided buffer of capacity * element_size bytes.
+ *
+ * @param ring
+ * @param buffer
+ * @param element_size
+ * @param capacity Number of elements; must be a non-zero power of two.
+ * @return false if capacity is not a power of two.
+ */
+bool spsc_ring_init(spsc_ring_t* ring, void* buffer, uint32_t element_size, uint32_t capacity);
+
+/**
+ * @brief Producer side. Copy one element into the ring.
+ *
+ * @return false if the ring is full.
+ */
+bool spsc_ring_push(spsc_ring_t* ring, const void* element);
+
+/**
+ * @brief Consumer side. Copy the oldest element out of the ring.
+ *
+ * @return false if the ring is empty.
+ */
+bool spsc_ring_pop(spsc_ring_t* ring, void* element);
+
+/**
+ * @brief Producer side. Copy up to count elements into the ring with a single publish.
+ *
+ * @return uint32_t Number of elements pushed.
+ */
+uint32_t spsc_ring_push_n(spsc_ring_t* ring, const void* elements, uint32_t count);
+
+/**
+ * @brief Consumer side. Copy up to count elements out of the ring with a single release.
+ *
+ * @return uint32_t Number of elements popped.
+ */
+uint32_t spsc_ring_pop_n(spsc_ring_t* ring, void* elements, uint32_t count);
+
+/**
+ * @brief Producer side. Get the largest contiguous free region at the write position.
+ *
+ * The producer fills the region in place and then calls spsc_ring_write_commit().
+ *
+ * @param ring
+ * @param region Set to the start of the region.
+ * @return uint32_t Number of elements available in the region; 0 if full.
+ */
+uint32_t spsc_ring_write_region(spsc_ring_t* ring, void** region);
+
+/**
+ * @brief Producer side. Publish count elements written through spsc_ring_write_region().
+ */
+void spsc_ring_write_commit(spsc_ring_t* ring, uint32_t count);
+
+/**
+ * @brief Consumer side. Get the largest contiguous readable region at the read position.
+ *
+ * The consumer processes the region in place and then calls spsc_ring_read_commit().
+ *
+ * @param ring
+ * @param region Set to the start of the region.
+ * @return uint32_t Number of elements available in the region; 0 if empty.
+ */
+uint32_t spsc_ring_read_region(spsc_ring_t* ring, const void** region);
+
+/**
+ * @brief Consumer side. Release count elements obtained through spsc_ring_read_region().
+ */
+void spsc_ring_read_commit(spsc_ring_t* ring, uint32_t count);
+
+uint32_t spsc_ring_count(spsc_ring_t* ring);
+uint32_t spsc_ring_space(spsc_ring_t* ring);
+uint32_t spsc_ring_capacity(const spsc_ring_t* ring);
+bool spsc_ring_is_empty(spsc_ring_t* ring);
+
+bool spsc_byte_ring_init(spsc_byte_ring_t* ring, uint8_t* buffer, uint32_t capacity);
+
+/**
+ * @brief Producer side. Write up to length bytes.
+ *
+ * @return uint32_t Number of bytes written.
+ */
+uint32_t spsc_byte_ring_write(spsc_byte_ring_t* ring, const uint8_t* data, uint32_t length);
+
+/**
+ * @brief Consumer side. Read up to length bytes.
+ *
+ * @return uint32_t Number of bytes read.
+ */
+uint32_t spsc_byte_ring_read(spsc_byte_ring_t* ring, uint8_t* data, uint32_t length);
+
+uint32_t spsc_byte_ring_count(spsc_byte_ring_t* ring);
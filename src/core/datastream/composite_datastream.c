@@ -1,13 +1,19 @@
 #include "composite_datastream.h"
 
-static i_datastream_t* find_stream(composite_datastream_t* instance, datastream_key_t key)
+static uint8_t scan(composite_datastream_t* instance, datastream_key_t key)
 {
   for(uint16_t i = 0; i < instance->count; i++) {
     if(datastream_contains(instance->streams[i], key)) {
-      return instance->streams[i];
+      return (uint8_t)i;
     }
   }
-  return NULL; // Key not found; handle error as needed.
+  return COMPOSITE_DATASTREAM_NO_ROUTE;
+}
+
+static i_datastream_t* find_stream(composite_datastream_t* instance, datastream_key_t key)
+{
+  uint8_t index = key < instance->route_count ? instance->routes[key] : scan(instance, key);
+  return index == COMPOSITE_DATASTREAM_NO_ROUTE ? NULL : instance->streams[index];
 }
 
 static void read(i_datastream_t* interface, datastream_key_t key, void* out)
@@ -28,28 +34,65 @@ static void write(i_datastream_t* interface, datastream_key_t key, const void* d
   }
 }
 
+static void write_range(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  i_datastream_t* stream = find_stream(instance, key);
+  if(stream) {
+    datastream_write_range(stream, key, offset, length, data);
+  }
+}
+
 static bool contains(i_datastream_t* interface, datastream_key_t key)
 {
   composite_datastream_t* instance = (composite_datastream_t*)interface;
   return find_stream(instance, key) != NULL;
 }
 
-static uint8_t size(i_datastream_t* interface, datastream_key_t key)
+static datastream_size_t size(i_datastream_t* interface, datastream_key_t key)
 {
   composite_datastream_t* instance = (composite_datastream_t*)interface;
   i_datastream_t* stream = find_stream(instance, key);
   return stream ? datastream_size(stream, key) : 0;
 }
 
-static void subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+static const void* peek(i_datastream_t* interface, datastream_key_t key)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  i_datastream_t* stream = find_stream(instance, key);
+  return stream ? datastream_peek(stream, key) : NULL;
+}
+
+static void* acquire(i_datastream_t* interface, datastream_key_t key)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  i_datastream_t* stream = find_stream(instance, key);
+  return stream ? datastream_acquire(stream, key) : NULL;
+}
+
+static void release(i_datastream_t* interface, datastream_key_t key)
 {
   composite_datastream_t* instance = (composite_datastream_t*)interface;
   i_datastream_t* stream = find_stream(instance, key);
   if(stream) {
-    datastream_subscribe(stream, key, subscription);
+    datastream_release(stream, key);
   }
 }
 
+static datastream_version_t version(i_datastream_t* interface, datastream_key_t key)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  i_datastream_t* stream = find_stream(instance, key);
+  return stream ? datastream_version(stream, key) : 0;
+}
+
+static bool subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  i_datastream_t* stream = find_stream(instance, key);
+  return stream != NULL && datastream_subscribe(stream, key, subscription);
+}
+
 static void subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
 {
   composite_datastream_t* instance = (composite_datastream_t*)interface;
@@ -64,6 +107,75 @@ static void unsubscribe(i_datastream_t* interface, event_subscription_t* subscri
   for(uint16_t i = 0; i < instance->count; i++) {
     datastream_unsubscribe(instance->streams[i], subscription);
   }
+  event_unsubscribe(&instance->batch_on_change, subscription);
+}
+
+static void subscribe_batch(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+
+  if(instance->dirty.words != NULL) {
+    event_subscribe(&instance->batch_on_change, subscription);
+    return;
+  }
+
+  for(uint16_t i = 0; i < instance->count; i++) {
+    datastream_subscribe_batch(instance->streams[i], subscription);
+  }
+}
+
+// A stream's batch: merged while our own commit runs, passed straight on when the stream
+// was committed on its own.
+static void capture(void* context, const void* data)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)context;
+  const datastream_on_batch_args_t* args = (const datastream_on_batch_args_t*)data;
+
+  if(!instance->committing) {
+    event_publish(&instance->batch_on_change, args);
+    return;
+  }
+
+  bitset_for_each(args->keys, key)
+  {
+    if(key < instance->dirty.bit_count) {
+      bitset_set(&instance->dirty, key);
+    }
+  }
+}
+
+static void begin_batch(i_datastream_t* interface)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+  instance->batch_depth++;
+  for(uint16_t i = 0; i < instance->count; i++) {
+    datastream_begin_batch(instance->streams[i]);
+  }
+}
+
+// Each stream publishes its own changed keys; with batch storage they are merged into one
+// batch event for the composite.
+static void commit(i_datastream_t* interface)
+{
+  composite_datastream_t* instance = (composite_datastream_t*)interface;
+
+  bool outermost = instance->batch_depth > 0 && --instance->batch_depth == 0;
+  instance->committing = outermost && instance->dirty.words != NULL;
+
+  for(uint16_t i = 0; i < instance->count; i++) {
+    datastream_commit(instance->streams[i]);
+  }
+
+  if(instance->committing) {
+    instance->committing = false;
+    if(!bitset_is_empty(&instance->dirty)) {
+      datastream_on_batch_args_t args = {
+        .keys = &instance->dirty,
+      };
+      event_publish(&instance->batch_on_change, &args);
+      bitset_clear_all(&instance->dirty);
+    }
+  }
 }
 
 void composite_datastream_init(composite_datastream_t* instance,
@@ -72,12 +184,51 @@ void composite_datastream_init(composite_datastream_t* instance,
 {
   instance->streams = streams;
   instance->count = count;
+  instance->routes = NULL;
+  instance->route_count = 0;
+  event_init(&instance->batch_on_change);
+  instance->captures = NULL;
+  instance->dirty = (bitset_t){ 0 };
+  instance->batch_depth = 0;
+  instance->committing = false;
 
   instance->interface.read = read;
   instance->interface.write = write;
+  instance->interface.write_range = write_range;
   instance->interface.contains = contains;
   instance->interface.size = size;
   instance->interface.subscribe = subscribe;
   instance->interface.subscribe_all = subscribe_all;
   instance->interface.unsubscribe = unsubscribe;
+  instance->interface.subscribe_batch = subscribe_batch;
+  instance->interface.begin_batch = begin_batch;
+  instance->interface.commit = commit;
+  instance->interface.peek = peek;
+  instance->interface.acquire = acquire;
+  instance->interface.release = release;
+  instance->interface.version = version;
+}
+
+void composite_datastream_set_routes(composite_datastream_t* instance, uint8_t* routes, uint16_t key_count)
+{
+  instance->routes = routes;
+  instance->route_count = key_count;
+  composite_datastream_rebuild_routes(instance);
+}
+
+void composite_datastream_set_batch_storage(composite_datastream_t* instance, bitset_word_t* dirty, uint16_t key_count, event_subscription_t* captures)
+{
+  bitset_init(&instance->dirty, dirty, key_count);
+  instance->captures = captures;
+  for(uint16_t i = 0; i < instance->count; i++) {
+    event_subscription_init(&captures[i], capture, instance);
+    datastream_subscribe_batch(instance->streams[i], &captures[i]);
+  }
+}
+
+void composite_datastream_rebuild_routes(composite_datastream_t* instance)
+{
+  for(uint16_t key = 0; key < instance->route_count; key++) {
+    instance->routes[key] = scan(instance, key);
+  }
 }
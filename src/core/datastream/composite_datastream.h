@@ -1,12 +1,61 @@
 #pragma once
 
+#include "bitset.h"
 #include "event.h"
 #include "i_datastream.h"
 
+enum {
+  COMPOSITE_DATASTREAM_NO_ROUTE = UINT8_MAX,
+};
+
 typedef struct {
   i_datastream_t interface;
   i_datastream_t** streams;
   uint8_t count;
+  uint8_t* routes;
+  uint16_t route_count;
+  // Batch coalescing; see composite_datastream_set_batch_storage().
+  event_t batch_on_change;
+  event_subscription_t* captures;
+  bitset_t dirty;
+  uint8_t batch_depth;
+  bool committing;
 } composite_datastream_t;
 
+#define COMPOSITE_DATASTREAM_ROUTES(name, key_count) uint8_t name[key_count]
+#define COMPOSITE_DATASTREAM_CAPTURES(name, stream_count) event_subscription_t name[stream_count]
+
 void composite_datastream_init(composite_datastream_t* instance, i_datastream_t** streams, uint8_t count);
+
+/**
+ * @brief Resolve keys through a dense key -> stream index table instead of asking every
+ * stream whether it contains the key.
+ *
+ * The table is built immediately by probing each key in [0, key_count) once. Keys outside
+ * that range still fall back to a linear scan.
+ *
+ * @param instance
+ * @param routes Storage for one entry per key (see COMPOSITE_DATASTREAM_ROUTES).
+ * @param key_count Number of keys covered by the table.
+ */
+void composite_datastream_set_routes(composite_datastream_t* instance, uint8_t* routes, uint16_t key_count);
+
+/**
+ * @brief Provide the key set that merges the streams' batches. A commit that changes keys in
+ * several streams then reaches batch subscribers once, with every changed key, instead of
+ * once per stream. Without it, subscribe_batch is forwarded to every stream.
+ *
+ * Call after the stream set is final; the composite subscribes to each stream's batches
+ * through that stream's own capture subscription.
+ *
+ * @param instance
+ * @param dirty One bit per key of the whole composite, e.g. BITSET_STORAGE(dirty, key_count).
+ * @param key_count
+ * @param captures One subscription per stream (see COMPOSITE_DATASTREAM_CAPTURES).
+ */
+void composite_datastream_set_batch_storage(composite_datastream_t* instance, bitset_word_t* dirty, uint16_t key_count, event_subscription_t* captures);
+
+/**
+ * @brief Rebuild the routing table after the stream set or its keys have changed.
+ */
+void composite_datastream_rebuild_routes(composite_datastream_t* instance);
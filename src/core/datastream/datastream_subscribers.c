@@ -0,0 +1,64 @@
+#include "datastream_subscribers.h"
+
+#include <stddef.h>
+
+bool datastream_subscribers_init(datastream_subscribers_t* subscribers, hash_map_slot_t* slots, event_t* events, uint16_t capacity)
+{
+  if(!hash_map_init(&subscribers->keys, slots, capacity)) {
+    return false;
+  }
+
+  // Any executor set before the storage arrived is kept for the keys claimed from now on.
+  subscribers->events = events;
+  subscribers->capacity = capacity;
+  subscribers->count = 0;
+
+  return true;
+}
+
+event_t* datastream_subscribers_find(const datastream_subscribers_t* subscribers, datastream_key_t key)
+{
+  void* event = NULL;
+  if(subscribers->events != NULL) {
+    hash_map_get(&subscribers->keys, key, &event);
+  }
+  return (event_t*)event;
+}
+
+event_t* datastream_subscribers_claim(datastream_subscribers_t* subscribers, datastream_key_t key)
+{
+  event_t* event = datastream_subscribers_find(subscribers, key);
+  if(event != NULL || subscribers->events == NULL || subscribers->count == subscribers->capacity) {
+    return event;
+  }
+
+  event = &subscribers->events[subscribers->count++];
+  event_init(event);
+#ifdef SIERA_EVENT_ASYNC
+  event_set_async(event, subscribers->async);
+#endif
+  hash_map_put(&subscribers->keys, key, event);
+
+  return event;
+}
+
+void datastream_subscribers_unsubscribe(datastream_subscribers_t* subscribers, event_subscription_t* subscription)
+{
+  // A subscription sits in at most one key's list; leave every other key's event untouched.
+  for(uint16_t i = 0; i < subscribers->count; i++) {
+    if(dlist_contains(&subscribers->events[i].subscribers, &subscription->node)) {
+      event_unsubscribe(&subscribers->events[i], subscription);
+      return;
+    }
+  }
+}
+
+#ifdef SIERA_EVENT_ASYNC
+void datastream_subscribers_set_async(datastream_subscribers_t* subscribers, const event_async_t* async)
+{
+  subscribers->async = async;
+  for(uint16_t i = 0; i < subscribers->count; i++) {
+    event_set_async(&subscribers->events[i], async);
+  }
+}
+#endif
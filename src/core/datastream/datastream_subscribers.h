@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "event.h"
+#include "hash_map.h"
+#include "i_datastream.h"
+
+/**
+ * Sparse per-key subscriber lists for datastream implementations: only keys that have been
+ * subscribed to own an event_t. Storage is caller-provided and sized to the number of keys
+ * with subscribers rather than to the number of keys.
+ */
+typedef struct {
+  hash_map_t keys;
+  event_t* events;
+  uint16_t capacity;
+  uint16_t count;
+#ifdef SIERA_EVENT_ASYNC
+  const event_async_t* async;
+#endif
+} datastream_subscribers_t;
+
+#define DATASTREAM_SUBSCRIBERS_STORAGE(name, capacity) \
+  HASH_MAP_STORAGE(name##_slots, capacity);            \
+  event_t name##_events[capacity]
+
+/**
+ * @brief Start with no keys claimed.
+ *
+ * @param subscribers
+ * @param slots
+ * @param events
+ * @param capacity Maximum number of keys with subscribers; must be a power of two.
+ * @return false if capacity is not supported.
+ */
+bool datastream_subscribers_init(datastream_subscribers_t* subscribers, hash_map_slot_t* slots, event_t* events, uint16_t capacity);
+
+/**
+ * @return The key's event, or NULL if the key has never been claimed.
+ */
+event_t* datastream_subscribers_find(const datastream_subscribers_t* subscribers, datastream_key_t key);
+
+/**
+ * @brief Find the key's event, claiming and initializing one if needed. A claimed key keeps
+ * its event for the lifetime of the table.
+ *
+ * @return The key's event, or NULL if the table is full or has no storage.
+ */
+event_t* datastream_subscribers_claim(datastream_subscribers_t* subscribers, datastream_key_t key);
+
+/**
+ * @brief Remove a subscription from the claimed key it was added to, if any.
+ */
+void datastream_subscribers_unsubscribe(datastream_subscribers_t* subscribers, event_subscription_t* subscription);
+
+#ifdef SIERA_EVENT_ASYNC
+/**
+ * @brief Apply event_set_async() to every claimed key and to keys claimed later.
+ */
+void datastream_subscribers_set_async(datastream_subscribers_t* subscribers, const event_async_t* async);
+#endif
@@ -3,25 +3,50 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "bitset.h"
 #include "event.h"
 
 typedef uint16_t datastream_key_t;
 
+// Entry size in bytes; wide enough for buffers such as waveform captures or lookup tables.
+typedef uint16_t datastream_size_t;
+
+// Stream-wide change sequence number a key last changed at; 0 means never changed.
+typedef uint32_t datastream_version_t;
+
 typedef struct {
   datastream_key_t key;
+  // The whole new value, even when only part of it changed.
   const void* data;
+  // Byte range of data that was written: the whole entry for write(), or the slice passed
+  // to write_range().
+  datastream_size_t offset;
+  datastream_size_t length;
 } datastream_on_change_args_t;
 
+// Published once per datastream_commit() on streams that had at least one key change.
+typedef struct {
+  const bitset_t* keys;
+} datastream_on_batch_args_t;
+
 typedef struct i_datastream_t i_datastream_t;
 
 typedef struct i_datastream_t {
   void (*read)(i_datastream_t* interface, datastream_key_t key, void* out);
   void (*write)(i_datastream_t* interface, datastream_key_t key, const void* data);
+  void (*write_range)(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data);
   bool (*contains)(i_datastream_t* interface, datastream_key_t key);
-  uint8_t (*size)(i_datastream_t* interface, datastream_key_t key);
-  void (*subscribe)(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription);
+  datastream_size_t (*size)(i_datastream_t* interface, datastream_key_t key);
+  bool (*subscribe)(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription);
   void (*subscribe_all)(i_datastream_t* interface, event_subscription_t* subscription);
   void (*unsubscribe)(i_datastream_t* interface, event_subscription_t* subscription);
+  void (*subscribe_batch)(i_datastream_t* interface, event_subscription_t* subscription);
+  void (*begin_batch)(i_datastream_t* interface);
+  void (*commit)(i_datastream_t* interface);
+  const void* (*peek)(i_datastream_t* interface, datastream_key_t key);
+  void* (*acquire)(i_datastream_t* interface, datastream_key_t key);
+  void (*release)(i_datastream_t* interface, datastream_key_t key);
+  datastream_version_t (*version)(i_datastream_t* interface, datastream_key_t key);
 } i_datastream_t;
 
 static inline void datastream_read(i_datastream_t* interface, datastream_key_t key, void* out)
@@ -34,19 +59,35 @@ static inline void datastream_write(i_datastream_t* interface, datastream_key_t
   interface->write(interface, key, data);
 }
 
+/**
+ * @brief Overwrite length bytes of a key starting at offset, e.g. one element of an array
+ * entry. Subscribers are notified only if those bytes changed, and the change args carry
+ * the range. Ranges that do not fit inside the entry are ignored.
+ */
+static inline void datastream_write_range(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  interface->write_range(interface, key, offset, length, data);
+}
+
 static inline bool datastream_contains(i_datastream_t* interface, datastream_key_t key)
 {
   return interface->contains(interface, key);
 }
 
-static inline uint8_t datastream_size(i_datastream_t* interface, datastream_key_t key)
+static inline datastream_size_t datastream_size(i_datastream_t* interface, datastream_key_t key)
 {
   return interface->size(interface, key);
 }
 
-static inline void datastream_subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+/**
+ * @brief Receive a datastream_on_change_args_t for every change of one key.
+ *
+ * @return false if the key does not exist or the stream has no room for another key with
+ * subscribers; the subscription was not added.
+ */
+static inline bool datastream_subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
 {
-  interface->subscribe(interface, key, subscription);
+  return interface->subscribe(interface, key, subscription);
 }
 
 static inline void datastream_subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
@@ -58,3 +99,71 @@ static inline void datastream_unsubscribe(i_datastream_t* interface, event_subsc
 {
   interface->unsubscribe(interface, subscription);
 }
+
+/**
+ * @brief Receive one datastream_on_batch_args_t per commit that changed keys.
+ */
+static inline void datastream_subscribe_batch(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  interface->subscribe_batch(interface, subscription);
+}
+
+/**
+ * @brief Start a batch. Writes until the matching datastream_commit() only mark keys dirty;
+ * batches may nest and only the outermost commit publishes.
+ */
+static inline void datastream_begin_batch(i_datastream_t* interface)
+{
+  interface->begin_batch(interface);
+}
+
+/**
+ * @brief End a batch: publish once per changed key with its final value, then one batch
+ * event carrying the set of changed keys.
+ */
+static inline void datastream_commit(i_datastream_t* interface)
+{
+  interface->commit(interface);
+}
+
+/**
+ * @brief Borrow the stored bytes of a key without copying them. The pointer stays valid for
+ * the lifetime of the stream, but the value changes under it on later writes.
+ *
+ * @return Pointer to datastream_size() bytes, or NULL if the key is not present.
+ */
+static inline const void* datastream_peek(i_datastream_t* interface, datastream_key_t key)
+{
+  return interface->peek(interface, key);
+}
+
+/**
+ * @brief Get a writable pointer to a key's storage for in-place mutation. Every successful
+ * acquire must be paired with datastream_release() on the same key.
+ *
+ * @return Pointer to datastream_size() bytes, or NULL if the key is not present.
+ */
+static inline void* datastream_acquire(i_datastream_t* interface, datastream_key_t key)
+{
+  return interface->acquire(interface, key);
+}
+
+/**
+ * @brief Finish an in-place mutation started with datastream_acquire() and publish the
+ * change. There is no previous copy to compare against, so release always notifies.
+ */
+static inline void datastream_release(i_datastream_t* interface, datastream_key_t key)
+{
+  interface->release(interface, key);
+}
+
+/**
+ * @brief Version of a key's value. It increases every time the value changes, so a poller
+ * can tell whether a key is dirty by comparing it with the version it last saw.
+ *
+ * @return 0 if the key is not present, has never changed or the stream does not track versions.
+ */
+static inline datastream_version_t datastream_version(i_datastream_t* interface, datastream_key_t key)
+{
+  return interface->version(interface, key);
+}
@@ -0,0 +1,322 @@
+#include "locked_datastream.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Batches span keys, so their acquisitions are not counted against any one of them.
+#define NO_KEY ((datastream_key_t)UINT16_MAX)
+
+static void lock(locked_datastream_t* instance, datastream_key_t key)
+{
+  locked_datastream_contention_t* contention = key < instance->contention_count ? &instance->contention[key] : NULL;
+
+  if(critical_section_try_enter(instance->section)) {
+    if(contention != NULL) {
+      contention->acquisitions++;
+    }
+    return;
+  }
+
+  event_profiler_ticks_t start = instance->clock != NULL ? instance->clock->now(instance->clock) : 0;
+  critical_section_enter(instance->section);
+
+  if(contention != NULL) {
+    contention->acquisitions++;
+    contention->contended++;
+    if(instance->clock != NULL) {
+      event_profiler_ticks_t waited = instance->clock->now(instance->clock) - start;
+      contention->wait_ticks += waited;
+      if(waited > contention->max_wait_ticks) {
+        contention->max_wait_ticks = waited;
+      }
+    }
+  }
+}
+
+static void unlock(locked_datastream_t* instance)
+{
+  critical_section_exit(instance->section);
+}
+
+static void publish(locked_datastream_t* instance, const datastream_on_change_args_t* args)
+{
+  event_t* entry_on_change = datastream_subscribers_find(&instance->subscribers, args->key);
+  const event_static_table_t* table = instance->static_subscriptions != NULL ? &instance->static_subscriptions[args->key] : NULL;
+  event_publish_with(entry_on_change, table, args);
+  event_publish(&instance->all_on_change, args);
+}
+
+// Runs inside the wrapped stream's write while the section is held: record the change for
+// the caller to publish once it has let go of the section.
+static void capture(void* context, const void* data)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)context;
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+
+  if(instance->committing) {
+    // The wrapped stream is flushing a batch; each of its keys is published after unlock.
+    if(args->key < instance->dirty.bit_count) {
+      bitset_set(&instance->dirty, args->key);
+      instance->values[args->key] = args->data;
+    }
+  }
+  else if(instance->pending != NULL) {
+    *instance->pending = *args;
+  }
+  else {
+    publish(instance, args);
+  }
+}
+
+// A recorded change always has a non-zero length, so zero means nothing changed.
+static void publish_pending(locked_datastream_t* instance, const datastream_on_change_args_t* change)
+{
+  if(change->length > 0) {
+    publish(instance, change);
+  }
+}
+
+static void read(i_datastream_t* interface, datastream_key_t key, void* out)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  lock(instance, key);
+  datastream_read(instance->inner, key, out);
+  unlock(instance);
+}
+
+static void write(i_datastream_t* interface, datastream_key_t key, const void* data)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  datastream_on_change_args_t change = { 0 };
+
+  lock(instance, key);
+  instance->pending = &change;
+  datastream_write(instance->inner, key, data);
+  instance->pending = NULL;
+  unlock(instance);
+
+  change.data = data;
+  publish_pending(instance, &change);
+}
+
+static void write_range(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  datastream_on_change_args_t change = { 0 };
+
+  lock(instance, key);
+  instance->pending = &change;
+  datastream_write_range(instance->inner, key, offset, length, data);
+  instance->pending = NULL;
+  unlock(instance);
+
+  publish_pending(instance, &change);
+}
+
+// The key layout is fixed once the wrapped stream is initialized, so lookups need no lock.
+static bool contains(i_datastream_t* interface, datastream_key_t key)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  return datastream_contains(instance->inner, key);
+}
+
+static datastream_size_t size(i_datastream_t* interface, datastream_key_t key)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  return datastream_size(instance->inner, key);
+}
+
+static bool subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  if(!datastream_contains(instance->inner, key)) {
+    return false;
+  }
+
+  event_t* event = datastream_subscribers_claim(&instance->subscribers, key);
+  if(event == NULL) {
+    return false;
+  }
+
+  event_subscribe(event, subscription);
+  return true;
+}
+
+static void subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  event_subscribe(&instance->all_on_change, subscription);
+}
+
+static void unsubscribe(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  datastream_subscribers_unsubscribe(&instance->subscribers, subscription);
+  event_unsubscribe(&instance->all_on_change, subscription);
+  event_unsubscribe(&instance->batch_on_change, subscription);
+}
+
+static void subscribe_batch(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  event_subscribe(&instance->batch_on_change, subscription);
+}
+
+static void begin_batch(i_datastream_t* interface)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  if(instance->dirty.words == NULL) {
+    return;
+  }
+
+  lock(instance, NO_KEY);
+  datastream_begin_batch(instance->inner);
+  unlock(instance);
+}
+
+static void commit(i_datastream_t* interface)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  if(instance->dirty.words == NULL) {
+    return;
+  }
+
+  lock(instance, NO_KEY);
+  instance->committing = true;
+  datastream_commit(instance->inner);
+  instance->committing = false;
+  unlock(instance);
+
+  if(bitset_is_empty(&instance->dirty)) {
+    return;
+  }
+
+  bitset_for_each(&instance->dirty, key)
+  {
+    datastream_on_change_args_t args = {
+      .key = key,
+      .data = instance->values[key],
+      .offset = 0,
+      .length = datastream_size(instance->inner, key),
+    };
+    publish(instance, &args);
+  }
+
+  datastream_on_batch_args_t args = {
+    .keys = &instance->dirty,
+  };
+  event_publish(&instance->batch_on_change, &args);
+
+  bitset_clear_all(&instance->dirty);
+}
+
+static const void* peek(i_datastream_t* interface, datastream_key_t key)
+{
+  (void)interface;
+  (void)key;
+  return NULL;
+}
+
+static void* acquire(i_datastream_t* interface, datastream_key_t key)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+
+  lock(instance, key);
+  void* value = datastream_acquire(instance->inner, key);
+  if(value == NULL) {
+    unlock(instance);
+  }
+
+  return value;
+}
+
+// Only valid after a successful acquire(), which left the section held.
+static void release(i_datastream_t* interface, datastream_key_t key)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  datastream_on_change_args_t change = { 0 };
+
+  instance->pending = &change;
+  datastream_release(instance->inner, key);
+  instance->pending = NULL;
+  unlock(instance);
+
+  publish_pending(instance, &change);
+}
+
+static datastream_version_t version(i_datastream_t* interface, datastream_key_t key)
+{
+  locked_datastream_t* instance = (locked_datastream_t*)interface;
+  lock(instance, key);
+  datastream_version_t value = datastream_version(instance->inner, key);
+  unlock(instance);
+  return value;
+}
+
+void locked_datastream_init(locked_datastream_t* instance, i_datastream_t* inner, i_critical_section_t* section)
+{
+  instance->interface = (i_datastream_t){
+    .read = read,
+    .write = write,
+    .write_range = write_range,
+    .contains = contains,
+    .size = size,
+    .subscribe = subscribe,
+    .subscribe_all = subscribe_all,
+    .unsubscribe = unsubscribe,
+    .subscribe_batch = subscribe_batch,
+    .begin_batch = begin_batch,
+    .commit = commit,
+    .peek = peek,
+    .acquire = acquire,
+    .release = release,
+    .version = version,
+  };
+
+  instance->inner = inner;
+  instance->section = section;
+  instance->pending = NULL;
+  event_init(&instance->all_on_change);
+  event_init(&instance->batch_on_change);
+  instance->subscribers = (datastream_subscribers_t){ 0 };
+  instance->static_subscriptions = NULL;
+  instance->dirty = (bitset_t){ 0 };
+  instance->values = NULL;
+  instance->committing = false;
+  instance->contention = NULL;
+  instance->contention_count = 0;
+  instance->clock = NULL;
+
+  event_subscription_init(&instance->capture, capture, instance);
+  datastream_subscribe_all(inner, &instance->capture);
+}
+
+void locked_datastream_set_subscriber_storage(locked_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity)
+{
+  datastream_subscribers_init(&instance->subscribers, slots, events, capacity);
+}
+
+void locked_datastream_set_static_subscriptions(locked_datastream_t* instance, const event_static_table_t* static_subscriptions)
+{
+  instance->static_subscriptions = static_subscriptions;
+}
+
+void locked_datastream_set_batch_storage(locked_datastream_t* instance, bitset_word_t* dirty, const void** values, uint16_t key_count)
+{
+  bitset_init(&instance->dirty, dirty, key_count);
+  instance->values = values;
+}
+
+void locked_datastream_track_contention(
+  locked_datastream_t* instance,
+  locked_datastream_contention_t* contention,
+  uint16_t key_count,
+  i_event_profiler_clock_t* clock)
+{
+  if(contention != NULL) {
+    memset(contention, 0, sizeof(*contention) * key_count);
+  }
+  instance->contention = contention;
+  instance->contention_count = contention != NULL ? key_count : 0;
+  instance->clock = clock;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "bitset.h"
+#include "datastream_subscribers.h"
+#include "event.h"
+#include "event_profiler.h"
+#include "i_critical_section.h"
+#include "i_datastream.h"
+
+/**
+ * Lock statistics for one key. contended counts acquisitions that found the section held;
+ * wait ticks are only recorded when a clock is attached.
+ */
+typedef struct {
+  uint32_t acquisitions;
+  uint32_t contended;
+  uint64_t wait_ticks;
+  event_profiler_ticks_t max_wait_ticks;
+} locked_datastream_contention_t;
+
+#define LOCKED_DATASTREAM_CONTENTION(name, key_count) locked_datastream_contention_t name[key_count]
+
+/**
+ * Declares the keys and value pointers that one commit of the wrapped stream reports:
+ *
+ * static LOCKED_DATASTREAM_BATCH(shared_batch, DATABASE_KEY_COUNT(ENTRIES));
+ * locked_datastream_set_batch_storage(&shared, shared_batch_dirty, shared_batch_values, DATABASE_KEY_COUNT(ENTRIES));
+ */
+#define LOCKED_DATASTREAM_BATCH(name, key_count) \
+  BITSET_STORAGE(name##_dirty, key_count);        \
+  const void* name##_values[key_count]
+
+/**
+ * Decorator that makes another datastream safe to share between threads by holding a
+ * critical section around every access to the wrapped stream's storage.
+ *
+ * Notifications are published by the decorator after the section has been released, so
+ * subscribers may read or write the stream again and never extend the hold time. Subscribe
+ * to the decorator rather than to the wrapped stream. For write() the change args carry the
+ * caller's buffer; for write_range() and release() they point at the stored value, which
+ * another thread may already be changing, so read() it if a stable copy is needed.
+ *
+ * acquire() returns with the section held until the matching release(). peek() returns NULL
+ * because the pointer would outlive the section. Subscription functions, like init, must not
+ * race with publishing. The wrapped stream must publish synchronously, i.e. without an event
+ * queue, and must only be written through the decorator.
+ *
+ * The wrapped stream's own subscribers, i.e. the static subscriptions in its config and anything
+ * subscribed to it directly, run inside the section and must not call back into the
+ * decorator. Give build-time subscriptions to the decorator instead, with
+ * locked_datastream_set_static_subscriptions().
+ *
+ * begin_batch and commit are forwarded to the wrapped stream under the section once
+ * locked_datastream_set_batch_storage() has been called; the batch's notifications are then
+ * published after the section is released. A batch covers the whole stream, so writes from
+ * other threads made while it is open join it, and commits must not race with each other.
+ */
+typedef struct
+{
+  i_datastream_t interface;
+  i_datastream_t* inner;
+  i_critical_section_t* section;
+  event_subscription_t capture;
+  datastream_on_change_args_t* pending;
+  event_t all_on_change;
+  event_t batch_on_change;
+  datastream_subscribers_t subscribers;
+  const event_static_table_t* static_subscriptions;
+  bitset_t dirty;
+  const void** values;
+  bool committing;
+  locked_datastream_contention_t* contention;
+  uint16_t contention_count;
+  i_event_profiler_clock_t* clock;
+} locked_datastream_t;
+
+/**
+ * @brief
+ *
+ * @param instance
+ * @param inner Stream to protect. It must not be used directly by other threads afterwards.
+ * @param section
+ */
+void locked_datastream_init(locked_datastream_t* instance, i_datastream_t* inner, i_critical_section_t* section);
+
+/**
+ * @brief Provide per-key subscriber storage; see ram_datastream_set_subscriber_storage().
+ * Until then datastream_subscribe() returns false.
+ */
+void locked_datastream_set_subscriber_storage(locked_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity);
+
+/**
+ * @brief Publish build-time subscriptions after the section is released, in place of
+ * static subscriptions on the wrapped stream.
+ *
+ * @param instance
+ * @param static_subscriptions One table per key of the wrapped stream, see
+ * DATABASE_EXPAND_AS_STATIC_TABLE, or NULL for none.
+ */
+void locked_datastream_set_static_subscriptions(locked_datastream_t* instance, const event_static_table_t* static_subscriptions);
+
+/**
+ * @brief Enable batches (see LOCKED_DATASTREAM_BATCH). The wrapped stream needs its own
+ * batch storage as well, e.g. ram_datastream_set_batch_storage(). Without this call
+ * begin_batch and commit do nothing and every write publishes immediately.
+ *
+ * @param instance
+ * @param dirty One bit per key.
+ * @param values One per key.
+ * @param key_count Number of keys of the wrapped stream.
+ */
+void locked_datastream_set_batch_storage(locked_datastream_t* instance, bitset_word_t* dirty, const void** values, uint16_t key_count);
+
+/**
+ * @brief Start counting lock acquisitions per key. Counters are updated while the section is
+ * held, so read them inside the same section or once the stream is idle.
+ *
+ * @param instance
+ * @param contention Zeroed here; see LOCKED_DATASTREAM_CONTENTION. Keys at or above
+ * key_count are not tracked. NULL stops tracking.
+ * @param key_count
+ * @param clock Times waits for a held section, or NULL to only count them.
+ */
+void locked_datastream_track_contention(
+  locked_datastream_t* instance,
+  locked_datastream_contention_t* contention,
+  uint16_t key_count,
+  i_event_profiler_clock_t* clock);
@@ -1,19 +1,163 @@
+#include <assert.h>
+#include <stdint.h>
 #include <string.h>
 #include "i_datastream.h"
 #include "ram_datastream.h"
+#include "utils.h"
 
-static uint16_t offset(ram_datastream_t* instance, datastream_key_t key)
+static uint32_t offset(ram_datastream_t* instance, datastream_key_t key)
 {
   return instance->config->entries[key].offset;
 }
 
+static void publish(ram_datastream_t* instance, const datastream_on_change_args_t* args)
+{
+  event_t* entry_on_change = datastream_subscribers_find(&instance->subscribers, args->key);
+  event_publish_with(entry_on_change, ram_datastream_static_subscriptions(instance->config, args->key), args);
+  event_publish(&instance->all_on_change, args);
+}
+
+// One queue entry per key carries both the key's and the all-keys publish; it is queued
+// against all_on_change, which leads back to the instance. Writes coalesced in the queue
+// may have touched different ranges, so report the whole entry.
+static void publish_deferred(event_t* event, uint16_t key, const void* payload, uint16_t size)
+{
+  ram_datastream_t* instance = CONTAINER_OF(event, ram_datastream_t, all_on_change);
+  datastream_on_change_args_t args = {
+    .key = key,
+    .data = payload,
+    .offset = 0,
+    .length = size,
+  };
+  publish(instance, &args);
+}
+
+#ifdef SIERA_EVENT_ASYNC
+// Packs the args and a copy of the value into one executor payload.
+static void copy_on_change_args(const event_async_t* async, void* destination, const void* data)
+{
+  const ram_datastream_t* instance = (const ram_datastream_t*)async->copy_context;
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  datastream_on_change_args_t* copy = (datastream_on_change_args_t*)destination;
+  uint8_t* value = (uint8_t*)destination + sizeof(datastream_on_change_args_t);
+
+  memcpy(value, args->data, instance->config->entries[args->key].size);
+  *copy = *args;
+  copy->data = value;
+}
+#endif
+
+// DATABASE_STORAGE aligns each entry to its type, so scalar entries sit at an address that
+// is a multiple of their size. An entry of the same size with a weaker type (e.g. char[4])
+// does not, hence the check. Once it passes, __builtin_assume_aligned lets the compiler turn
+// the fixed-size memcpy/memcmp into one aligned access on the storage side instead of a call
+// or a byte-wise sequence. The caller's buffer has no such guarantee and stays unaligned.
+#define STORED_SCALAR(stored, size) \
+  (((size) == 2 || (size) == 4 || (size) == 8) && ((uintptr_t)(stored) & ((size) - 1u)) == 0)
+
+static void load_value(void* out, const uint8_t* stored, datastream_size_t size)
+{
+  if(STORED_SCALAR(stored, size)) {
+    switch(size) {
+      case 2:
+        memcpy(out, __builtin_assume_aligned(stored, 2), 2);
+        return;
+      case 4:
+        memcpy(out, __builtin_assume_aligned(stored, 4), 4);
+        return;
+      default:
+        memcpy(out, __builtin_assume_aligned(stored, 8), 8);
+        return;
+    }
+  }
+  memcpy(out, stored, size);
+}
+
+static void store_value(uint8_t* stored, const void* in, datastream_size_t size)
+{
+  if(STORED_SCALAR(stored, size)) {
+    switch(size) {
+      case 2:
+        memcpy(__builtin_assume_aligned(stored, 2), in, 2);
+        return;
+      case 4:
+        memcpy(__builtin_assume_aligned(stored, 4), in, 4);
+        return;
+      default:
+        memcpy(__builtin_assume_aligned(stored, 8), in, 8);
+        return;
+    }
+  }
+  memcpy(stored, in, size);
+}
+
+static bool stored_value_differs(const uint8_t* stored, const void* in, datastream_size_t size)
+{
+  if(STORED_SCALAR(stored, size)) {
+    switch(size) {
+      case 2:
+        return memcmp(__builtin_assume_aligned(stored, 2), in, 2) != 0;
+      case 4:
+        return memcmp(__builtin_assume_aligned(stored, 4), in, 4) != 0;
+      default:
+        return memcmp(__builtin_assume_aligned(stored, 8), in, 8) != 0;
+    }
+  }
+  return memcmp(stored, in, size) != 0;
+}
+
+// Writer side of the snapshot protocol, wrapped around every change to storage. The odd
+// store_sequence and the generation loads are sequentially consistent, pairing with the
+// generation store and store_sequence load in ram_datastream_capture(): either this store
+// sees the new generation and saves the old value, or capture sees it in progress and
+// waits for it to finish.
+static void begin_store(ram_datastream_t* instance, datastream_key_t key)
+{
+  if(instance->snapshots.head == NULL) {
+    return;
+  }
+
+  if(instance->store_depth++ == 0) {
+    atomic_fetch_add(&instance->store_sequence, 1);
+    atomic_thread_fence(memory_order_release);
+  }
+
+  const ram_datastream_entry_t* entry = &instance->config->entries[key];
+  for(dlist_node_t* node = instance->snapshots.head; node != NULL; node = node->next) {
+    datastream_snapshot_t* snapshot = (datastream_snapshot_t*)node;
+    uint32_t generation = atomic_load(&snapshot->generation);
+
+    // Only the first change after a capture saves the key; later ones find it tagged.
+    if(generation != 0 && atomic_load_explicit(&snapshot->tags[key], memory_order_relaxed) != generation) {
+      load_value(snapshot->shadow + entry->offset, (const uint8_t*)instance->storage + entry->offset, entry->size);
+      atomic_store_explicit(&snapshot->tags[key], generation, memory_order_release);
+    }
+  }
+}
+
+static void end_store(ram_datastream_t* instance)
+{
+  if(instance->snapshots.head == NULL) {
+    return;
+  }
+
+  // A release() without its acquire() would wrap the depth and leave store_sequence odd.
+  assert(instance->store_depth > 0);
+
+  // Only the writer changes store_sequence, so closing the store needs no read-modify-write.
+  if(--instance->store_depth == 0) {
+    uint32_t sequence = atomic_load_explicit(&instance->store_sequence, memory_order_relaxed);
+    atomic_store_explicit(&instance->store_sequence, sequence + 1, memory_order_release);
+  }
+}
+
 static bool contains(i_datastream_t* interface, datastream_key_t key)
 {
   ram_datastream_t* instance = (ram_datastream_t*)interface;
   return key < instance->config->count && instance->config->entries[key].size > 0;
 }
 
-static uint8_t size(i_datastream_t* interface, datastream_key_t key)
+static datastream_size_t size(i_datastream_t* interface, datastream_key_t key)
 {
   if(contains(interface, key)) {
     ram_datastream_t* instance = (ram_datastream_t*)interface;
@@ -27,52 +171,189 @@ static void read(i_datastream_t* interface, datastream_key_t key, void* out)
   if(contains(interface, key)) {
     ram_datastream_t* instance = (ram_datastream_t*)interface;
     const ram_datastream_entry_t* entry = &instance->config->entries[key];
-    uint8_t* src = (uint8_t*)instance->storage + entry->offset;
-    memcpy(out, src, entry->size);
+    const uint8_t* src = (const uint8_t*)instance->storage + entry->offset;
+    load_value(out, src, entry->size);
   }
 }
 
+static void notify(ram_datastream_t* instance, const datastream_on_change_args_t* args)
+{
+  if(instance->deferred != NULL) {
+    datastream_size_t size = instance->config->entries[args->key].size;
+    event_queue_publish_with(instance->deferred, &instance->all_on_change, args->key, args->data, size, publish_deferred);
+    return;
+  }
+
+  publish(instance, args);
+}
+
+// Called after storage for key has taken its new value; data is the whole value and
+// [offset, offset + length) the part that was written.
+static void changed(ram_datastream_t* instance, datastream_key_t key, const void* data, datastream_size_t offset, datastream_size_t length)
+{
+  // 0 is reserved for "never changed", so skip it when the sequence wraps.
+  if(++instance->sequence == 0) {
+    instance->sequence = 1;
+  }
+  if(instance->versions != NULL) {
+    instance->versions[key] = instance->sequence;
+  }
+
+  if(instance->batch_depth > 0 && instance->dirty.words != NULL) {
+    bitset_set(&instance->dirty, key);
+    return;
+  }
+
+  datastream_on_change_args_t args = {
+    .key = key,
+    .data = data,
+    .offset = offset,
+    .length = length,
+  };
+  notify(instance, &args);
+}
+
 static void write(i_datastream_t* interface, datastream_key_t key, const void* data)
 {
   if(contains(interface, key)) {
     ram_datastream_t* instance = (ram_datastream_t*)interface;
-    uint8_t s = size(interface, key);
-    void* location = (uint8_t*)instance->storage + instance->config->entries[key].offset;
-    if(memcmp(location, data, s)) {
-      memcpy(location, data, s);
-      datastream_on_change_args_t args = {
-        .key = key,
-        .data = data,
-      };
-
-      ram_datastream_entry_t entry = instance->config->entries[key];
-      event_publish(&entry.entry_on_change, &args);
-      event_publish(&instance->all_on_change, &args);
+    datastream_size_t s = size(interface, key);
+    uint8_t* location = (uint8_t*)instance->storage + instance->config->entries[key].offset;
+    if(stored_value_differs(location, data, s)) {
+      begin_store(instance, key);
+      store_value(location, data, s);
+      end_store(instance);
+      changed(instance, key, data, 0, s);
     }
   }
 }
 
-void subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+static void write_range(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  datastream_size_t s = size(interface, key);
+  if(s == 0 || length == 0 || offset > s || length > s - offset) {
+    return;
+  }
+
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+  uint8_t* value = (uint8_t*)instance->storage + instance->config->entries[key].offset;
+  if(memcmp(value + offset, data, length)) {
+    begin_store(instance, key);
+    memcpy(value + offset, data, length);
+    end_store(instance);
+    changed(instance, key, value, offset, length);
+  }
+}
+
+static const void* peek(i_datastream_t* interface, datastream_key_t key)
 {
   if(contains(interface, key)) {
     ram_datastream_t* instance = (ram_datastream_t*)interface;
-    event_subscribe(&instance->config->entries[key].entry_on_change, subscription);
+    return (const uint8_t*)instance->storage + offset(instance, key);
   }
+  return NULL;
 }
 
-void subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
+// The caller mutates storage in place until release(), so the store spans both calls.
+static void* acquire(i_datastream_t* interface, datastream_key_t key)
+{
+  if(contains(interface, key)) {
+    ram_datastream_t* instance = (ram_datastream_t*)interface;
+    begin_store(instance, key);
+    return (uint8_t*)instance->storage + offset(instance, key);
+  }
+  return NULL;
+}
+
+static void release(i_datastream_t* interface, datastream_key_t key)
+{
+  if(contains(interface, key)) {
+    ram_datastream_t* instance = (ram_datastream_t*)interface;
+    end_store(instance);
+    changed(instance, key, (uint8_t*)instance->storage + offset(instance, key), 0, size(interface, key));
+  }
+}
+
+static datastream_version_t version(i_datastream_t* interface, datastream_key_t key)
 {
   ram_datastream_t* instance = (ram_datastream_t*)interface;
-  event_subscribe(&instance->all_on_change, subscription);
+  if(instance->versions != NULL && contains(interface, key)) {
+    return instance->versions[key];
+  }
+  return 0;
 }
 
-void unsubscribe(i_datastream_t* interface, event_subscription_t* subscription)
+static void begin_batch(i_datastream_t* interface)
 {
   ram_datastream_t* instance = (ram_datastream_t*)interface;
-  for(uint16_t i = 0; i < instance->config->count; i++) {
-    event_unsubscribe(&instance->config->entries[i].entry_on_change, subscription);
+  instance->batch_depth++;
+}
+
+static void commit(i_datastream_t* interface)
+{
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+
+  if(instance->batch_depth == 0 || --instance->batch_depth > 0) {
+    return;
   }
+  if(instance->dirty.words == NULL || bitset_is_empty(&instance->dirty)) {
+    return;
+  }
+
+  // Subscribers see every key of the batch already holding its final value.
+  bitset_for_each(&instance->dirty, key)
+  {
+    datastream_on_change_args_t args = {
+      .key = key,
+      .data = (uint8_t*)instance->storage + offset(instance, key),
+      .offset = 0,
+      .length = size(interface, key),
+    };
+    notify(instance, &args);
+  }
+
+  datastream_on_batch_args_t args = {
+    .keys = &instance->dirty,
+  };
+  event_publish(&instance->batch_on_change, &args);
+
+  bitset_clear_all(&instance->dirty);
+}
+
+static bool subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+{
+  if(!contains(interface, key)) {
+    return false;
+  }
+
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+  event_t* event = datastream_subscribers_claim(&instance->subscribers, key);
+  if(event == NULL) {
+    return false;
+  }
+
+  event_subscribe(event, subscription);
+  return true;
+}
+
+static void subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+  event_subscribe(&instance->all_on_change, subscription);
+}
+
+static void unsubscribe(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+  datastream_subscribers_unsubscribe(&instance->subscribers, subscription);
   event_unsubscribe(&instance->all_on_change, subscription);
+  event_unsubscribe(&instance->batch_on_change, subscription);
+}
+
+static void subscribe_batch(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  ram_datastream_t* instance = (ram_datastream_t*)interface;
+  event_subscribe(&instance->batch_on_change, subscription);
 }
 
 void ram_datastream_init(ram_datastream_t* instance, const ram_datastream_config_t* config, void* storage)
@@ -83,21 +364,185 @@ void ram_datastream_init(ram_datastream_t* instance, const ram_datastream_config
   instance->interface = (i_datastream_t){
     .read = read,
     .write = write,
+    .write_range = write_range,
     .contains = contains,
     .size = size,
     .subscribe = subscribe,
     .subscribe_all = subscribe_all,
     .unsubscribe = unsubscribe,
+    .subscribe_batch = subscribe_batch,
+    .begin_batch = begin_batch,
+    .commit = commit,
+    .peek = peek,
+    .acquire = acquire,
+    .release = release,
+    .version = version,
   };
 
-  datastream_key_t last_key = (datastream_key_t)(instance->config->count - 1);
-  uint16_t last_offset = offset(instance, last_key);
-  uint8_t last_size = size(&instance->interface, last_key);
-  memset(instance->storage, 0, last_offset + last_size);
-
+  // With DATABASE_SORTED_STORAGE the last key is not necessarily the last in memory.
+  uint32_t storage_size = 0;
   for(uint16_t i = 0; i < config->count; i++) {
-    event_init(&instance->config->entries[i].entry_on_change);
+    uint32_t end = config->entries[i].offset + config->entries[i].size;
+    if(end > storage_size) {
+      storage_size = end;
+    }
   }
+  memset(instance->storage, 0, storage_size);
 
   event_init(&instance->all_on_change);
+  event_init(&instance->batch_on_change);
+  instance->subscribers = (datastream_subscribers_t){ 0 };
+#ifdef SIERA_EVENT_ASYNC
+  instance->async = (event_async_t){ 0 };
+#endif
+  instance->deferred = NULL;
+  instance->dirty = (bitset_t){ 0 };
+  instance->batch_depth = 0;
+  instance->versions = NULL;
+  instance->sequence = 0;
+  dlist_init(&instance->snapshots);
+  atomic_init(&instance->store_sequence, 0);
+  instance->store_depth = 0;
+}
+
+void ram_datastream_set_subscriber_storage(ram_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity)
+{
+  datastream_subscribers_init(&instance->subscribers, slots, events, capacity);
+}
+
+void ram_datastream_set_batch_storage(ram_datastream_t* instance, bitset_word_t* dirty)
+{
+  bitset_init(&instance->dirty, dirty, instance->config->count);
+}
+
+void ram_datastream_set_deferred(ram_datastream_t* instance, event_queue_t* deferred)
+{
+  instance->deferred = deferred;
+}
+
+#ifdef SIERA_EVENT_ASYNC
+void ram_datastream_set_executor(ram_datastream_t* instance, i_event_executor_t* executor)
+{
+  datastream_size_t largest = 0;
+  for(uint16_t i = 0; i < instance->config->count; i++) {
+    if(instance->config->entries[i].size > largest) {
+      largest = instance->config->entries[i].size;
+    }
+  }
+
+  instance->async = (event_async_t){
+    .executor = executor,
+    .payload_size = (uint16_t)(sizeof(datastream_on_change_args_t) + largest),
+    .copy = copy_on_change_args,
+    .copy_context = instance,
+  };
+
+  const event_async_t* async = executor != NULL ? &instance->async : NULL;
+  datastream_subscribers_set_async(&instance->subscribers, async);
+  event_set_async(&instance->all_on_change, async);
+}
+#endif
+
+void ram_datastream_set_version_storage(ram_datastream_t* instance, datastream_version_t* versions)
+{
+  instance->versions = versions;
+  for(uint16_t i = 0; i < instance->config->count; i++) {
+    versions[i] = 0;
+  }
+}
+
+datastream_version_t ram_datastream_sequence(const ram_datastream_t* instance)
+{
+  return instance->sequence;
+}
+
+uint16_t ram_datastream_changed_since(const ram_datastream_t* instance, datastream_version_t sequence, bitset_t* changed)
+{
+  uint16_t count = 0;
+
+  bitset_clear_all(changed);
+  if(instance->versions == NULL) {
+    return 0;
+  }
+
+  for(uint16_t i = 0; i < instance->config->count; i++) {
+    // Wrap-safe: a version is newer if it is ahead of sequence by less than half the range.
+    if(instance->versions[i] != 0 && (int32_t)(instance->versions[i] - sequence) > 0) {
+      bitset_set(changed, i);
+      count++;
+    }
+  }
+
+  return count;
+}
+
+void ram_datastream_add_snapshot(ram_datastream_t* instance, datastream_snapshot_t* snapshot, void* shadow, SIERA_ATOMIC(uint32_t) * tags)
+{
+  snapshot->shadow = (uint8_t*)shadow;
+  snapshot->tags = tags;
+  for(uint16_t i = 0; i < instance->config->count; i++) {
+    atomic_init(&tags[i], 0);
+  }
+  atomic_init(&snapshot->generation, 0);
+  snapshot->last_generation = 0;
+
+  dlist_push_back(&instance->snapshots, &snapshot->node);
+}
+
+void ram_datastream_capture(ram_datastream_t* instance, datastream_snapshot_t* snapshot)
+{
+  uint32_t generation = snapshot->last_generation + 1;
+
+  // After a wrap, tags left from long-gone captures could match again.
+  if(generation == 0) {
+    for(uint16_t i = 0; i < instance->config->count; i++) {
+      atomic_store_explicit(&snapshot->tags[i], 0, memory_order_relaxed);
+    }
+    generation = 1;
+  }
+  snapshot->last_generation = generation;
+  atomic_store(&snapshot->generation, generation);
+
+  // A store that began before the new generation was visible does not save its key, so let
+  // it land before anything is read through the snapshot.
+  uint32_t sequence = atomic_load(&instance->store_sequence);
+  if(sequence & 1u) {
+    while(atomic_load_explicit(&instance->store_sequence, memory_order_acquire) == sequence) {
+    }
+  }
+}
+
+void ram_datastream_release_snapshot(ram_datastream_t* instance, datastream_snapshot_t* snapshot)
+{
+  (void)instance;
+  atomic_store(&snapshot->generation, 0);
+}
+
+void ram_datastream_snapshot_read(ram_datastream_t* instance, const datastream_snapshot_t* snapshot, datastream_key_t key, void* out)
+{
+  if(!contains(&instance->interface, key)) {
+    return;
+  }
+
+  const ram_datastream_entry_t* entry = &instance->config->entries[key];
+  uint32_t generation = atomic_load_explicit(&snapshot->generation, memory_order_relaxed);
+
+  while(true) {
+    uint32_t sequence = atomic_load_explicit(&instance->store_sequence, memory_order_acquire);
+    if(sequence & 1u) {
+      continue;
+    }
+
+    // A tagged key was saved before its first change since the capture.
+    if(generation != 0 && atomic_load_explicit(&snapshot->tags[key], memory_order_acquire) == generation) {
+      load_value(out, snapshot->shadow + entry->offset, entry->size);
+      return;
+    }
+
+    load_value(out, (const uint8_t*)instance->storage + entry->offset, entry->size);
+    atomic_thread_fence(memory_order_acquire);
+    if(atomic_load_explicit(&instance->store_sequence, memory_order_relaxed) == sequence) {
+      return;
+    }
+  }
 }
@@ -1,27 +1,203 @@
 #pragma once
 
+#include "atomic_utils.h"
+#include "bitset.h"
 #include "event.h"
+#include "datastream_subscribers.h"
+#include "dlist.h"
+#include "event_queue.h"
 #include "i_datastream.h"
 
 typedef struct
 {
-  uint16_t offset;
-  uint8_t size;
-  event_t entry_on_change;
+  uint32_t offset;
+  datastream_size_t size;
 } ram_datastream_entry_t;
 
 typedef struct
 {
-  ram_datastream_entry_t* entries;
+  const ram_datastream_entry_t* entries;
   uint16_t count;
+  // Optional, one table per key; see DATABASE_EXPAND_AS_STATIC_TABLE.
+  const event_static_table_t* static_subscriptions;
 } ram_datastream_config_t;
 
+/**
+ * @brief The key's build-time subscriptions, or NULL if the config has none.
+ */
+static inline const event_static_table_t* ram_datastream_static_subscriptions(const ram_datastream_config_t* config, datastream_key_t key)
+{
+  return config->static_subscriptions != NULL ? &config->static_subscriptions[key] : NULL;
+}
+
+/**
+ * A consistent view of every key of a ram_datastream as of ram_datastream_capture().
+ *
+ * Capturing copies nothing. Afterwards, the first write to each key saves that key's old
+ * bytes into the snapshot's shadow buffer, at the same offset as in storage, and tags the
+ * key with the capture's generation. Reads take tagged keys from the shadow and all other
+ * keys from live storage. A snapshot therefore costs O(bytes changed while it is held), and
+ * recapturing only bumps the generation.
+ */
+typedef struct
+{
+  dlist_node_t node;
+  uint8_t* shadow;
+  // Generation each key was last saved for.
+  SIERA_ATOMIC(uint32_t) * tags;
+  // Generation of the current capture, or 0 while released.
+  SIERA_ATOMIC(uint32_t) generation;
+  uint32_t last_generation;
+} datastream_snapshot_t;
+
 typedef struct
 {
   i_datastream_t interface;
   const ram_datastream_config_t* config;
   void* storage;
   event_t all_on_change;
+  event_t batch_on_change;
+  // Per-key events exist only for keys that have subscribers; see
+  // ram_datastream_set_subscriber_storage().
+  datastream_subscribers_t subscribers;
+  event_queue_t* deferred;
+#ifdef SIERA_EVENT_ASYNC
+  event_async_t async;
+#endif
+  bitset_t dirty;
+  uint8_t batch_depth;
+  datastream_version_t* versions;
+  datastream_version_t sequence;
+  dlist_t snapshots;
+  // Odd while storage is being modified; only maintained once a snapshot is added.
+  SIERA_ATOMIC(uint32_t) store_sequence;
+  uint8_t store_depth;
 } ram_datastream_t;
 
+#define RAM_DATASTREAM_VERSIONS(name, key_count) datastream_version_t name[key_count]
+
+/**
+ * Declares a shadow buffer shaped like the stream's storage and one generation tag per key:
+ *
+ * static RAM_DATASTREAM_SNAPSHOT(telemetry, ram_storage_t, DATABASE_KEY_COUNT(ENTRIES));
+ * ram_datastream_add_snapshot(&database, &snapshot, &telemetry_shadow, telemetry_tags);
+ */
+#define RAM_DATASTREAM_SNAPSHOT(name, storage_type, key_count) \
+  storage_type name##_shadow;                                  \
+  SIERA_ATOMIC(uint32_t) name##_tags[key_count]
+
+/**
+ * Declares storage for per-key subscriber lists, sized to the number of keys that will ever
+ * have a subscriber rather than to the number of keys:
+ *
+ * static RAM_DATASTREAM_SUBSCRIBERS(database_subscribers, 16);
+ * ram_datastream_set_subscriber_storage(&database, database_subscribers_slots, database_subscribers_events, 16);
+ */
+#define RAM_DATASTREAM_SUBSCRIBERS(name, capacity) DATASTREAM_SUBSCRIBERS_STORAGE(name, capacity)
+
+/**
+ * @brief Per-key subscriptions additionally need ram_datastream_set_subscriber_storage();
+ * until it is called, datastream_subscribe() returns false. Static subscriptions, subscribe_all
+ * and subscribe_batch work without it.
+ */
 void ram_datastream_init(ram_datastream_t* instance, const ram_datastream_config_t* config, void* storage);
+
+/**
+ * @brief Provide the per-key subscriber table (see RAM_DATASTREAM_SUBSCRIBERS). A key takes
+ * a slot the first time it is subscribed to and keeps it. Without this table, or once it is
+ * full, datastream_subscribe() adds nothing and returns false.
+ *
+ * @param instance
+ * @param slots
+ * @param events
+ * @param capacity Maximum number of keys with subscribers; must be a power of two.
+ */
+void ram_datastream_set_subscriber_storage(ram_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity);
+
+/**
+ * @brief Route change notifications through a deferred event queue instead of publishing
+ * them from inside write(). Repeated writes to a key before the queue is drained reach
+ * subscribers once, with the latest value; args.data then points into the queue's copy.
+ *
+ * @param instance
+ * @param deferred Queue to publish into, or NULL to publish synchronously.
+ */
+void ram_datastream_set_deferred(ram_datastream_t* instance, event_queue_t* deferred);
+
+#ifdef SIERA_EVENT_ASYNC
+/**
+ * @brief Run async-safe subscribers of this stream on an executor. Each receives its own
+ * copy of the change args and the new value. Only built with SIERA_EVENT_ASYNC.
+ *
+ * @param instance
+ * @param executor Executor to use, or NULL to run every subscriber inline.
+ */
+void ram_datastream_set_executor(ram_datastream_t* instance, i_event_executor_t* executor);
+#endif
+
+/**
+ * @brief Provide the dirty-key set that datastream_begin_batch() needs. Without it, writes
+ * inside a batch keep publishing immediately.
+ *
+ * @param instance
+ * @param dirty One bit per key, e.g. BITSET_STORAGE(dirty, DATABASE_KEY_COUNT(ENTRIES)).
+ */
+void ram_datastream_set_batch_storage(ram_datastream_t* instance, bitset_word_t* dirty);
+
+/**
+ * @brief Track a version per key (see RAM_DATASTREAM_VERSIONS). Every change takes the next
+ * value of the stream's sequence number as the key's version.
+ *
+ * @param instance
+ * @param versions One entry per key.
+ */
+void ram_datastream_set_version_storage(ram_datastream_t* instance, datastream_version_t* versions);
+
+/**
+ * @brief Sequence number of the most recent change to any key.
+ */
+datastream_version_t ram_datastream_sequence(const ram_datastream_t* instance);
+
+/**
+ * @brief Find every key that changed after sequence in one pass over the version table.
+ *
+ * @param instance
+ * @param sequence A value previously returned by ram_datastream_sequence().
+ * @param changed Cleared, then receives one bit per changed key; must hold config->count bits.
+ * @return uint16_t Number of changed keys.
+ */
+uint16_t ram_datastream_changed_since(const ram_datastream_t* instance, datastream_version_t sequence, bitset_t* changed);
+
+/**
+ * @brief Attach a snapshot to the stream (see RAM_DATASTREAM_SNAPSHOT). Like subscribing,
+ * this is setup work and must not race with writes, nor fall between datastream_acquire()
+ * and datastream_release(). The snapshot starts released.
+ *
+ * @param instance
+ * @param snapshot
+ * @param shadow At least as large as the stream's storage.
+ * @param tags One per key.
+ */
+void ram_datastream_add_snapshot(ram_datastream_t* instance, datastream_snapshot_t* snapshot, void* shadow, SIERA_ATOMIC(uint32_t) * tags);
+
+/**
+ * @brief Freeze the snapshot at the stream's current values.
+ *
+ * May be called from another thread than the writer. Writers never wait for snapshots;
+ * capture itself waits only if a store is in progress, including the span between
+ * datastream_acquire() and datastream_release(). A capture inside a batch sees the writes
+ * made so far.
+ */
+void ram_datastream_capture(ram_datastream_t* instance, datastream_snapshot_t* snapshot);
+
+/**
+ * @brief Stop saving old values for the snapshot until it is captured again.
+ */
+void ram_datastream_release_snapshot(ram_datastream_t* instance, datastream_snapshot_t* snapshot);
+
+/**
+ * @brief Read a key as it was when the snapshot was captured. Safe against one concurrent
+ * writer; retries instead of blocking it if a store lands during the copy. A released
+ * snapshot reads current values.
+ */
+void ram_datastream_snapshot_read(ram_datastream_t* instance, const datastream_snapshot_t* snapshot, datastream_key_t key, void* out);
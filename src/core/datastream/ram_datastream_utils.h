@@ -1,13 +1,36 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "event_static_subscription.h"
 #include "utils.h"
 
 #define DATABASE_EXPAND_AS_ENUM(name, type) name,
 
-#define DATABASE_EXPAND_AS_STORAGE_STRUCT(name, type) uint8_t name[sizeof(type)];
+// Byte arrays keep array-typed entries (e.g. char[16]) legal, and the alignment attribute
+// gives each value its natural alignment so reads and writes can move whole words.
+#define DATABASE_EXPAND_AS_STORAGE_STRUCT(name, type) uint8_t name[sizeof(type)] __attribute__((aligned(__alignof__(type))));
+
+// Alignment class of a type for DATABASE_SORTED_STORAGE; 8 also covers anything wider.
+#define DATABASE_ALIGNMENT_BAND(type) (__alignof__(type) >= 8 ? 8 : __alignof__(type))
+
+// One member per band pass; it is zero-length (a GNU extension) unless the type belongs to
+// the band, so each entry occupies storage exactly once.
+#define DATABASE_EXPAND_AS_BAND_MEMBER(name, type, band)                               \
+  uint8_t name##_band##band[DATABASE_ALIGNMENT_BAND(type) == (band) ? sizeof(type) : 0] \
+    __attribute__((aligned(DATABASE_ALIGNMENT_BAND(type) == (band) ? __alignof__(type) : 1)));
+
+#define DATABASE_EXPAND_AS_BAND8_MEMBER(name, type) DATABASE_EXPAND_AS_BAND_MEMBER(name, type, 8)
+#define DATABASE_EXPAND_AS_BAND4_MEMBER(name, type) DATABASE_EXPAND_AS_BAND_MEMBER(name, type, 4)
+#define DATABASE_EXPAND_AS_BAND2_MEMBER(name, type) DATABASE_EXPAND_AS_BAND_MEMBER(name, type, 2)
+#define DATABASE_EXPAND_AS_BAND1_MEMBER(name, type) DATABASE_EXPAND_AS_BAND_MEMBER(name, type, 1)
+
+#define DATABASE_EXPAND_AS_COUNT(name, type) +1
+
+// Number of entries in the list as a constant expression, e.g. for sizing a bitset of keys.
+#define DATABASE_KEY_COUNT(ENTRIES_LIST) (0 ENTRIES_LIST(DATABASE_EXPAND_AS_COUNT))
 
 #define DATABASE_ENUM(ENTRIES_LIST)       \
   enum {                                  \
@@ -21,8 +44,34 @@ typedef struct ram_storage_t ram_storage_t;
     ENTRIES_LIST(DATABASE_EXPAND_AS_STORAGE_STRUCT) \
   } ram_storage_t;
 
+/**
+ * Like DATABASE_STORAGE, but lays values out by descending alignment instead of declaration
+ * order, so no padding is needed between them. Use DATABASE_EXPAND_AS_SORTED_ENTRY for the
+ * entry table; values are then only reachable through the datastream, not by member name.
+ */
+#define DATABASE_SORTED_STORAGE(ENTRIES_LIST)      \
+  typedef struct ram_storage_t {                   \
+    ENTRIES_LIST(DATABASE_EXPAND_AS_BAND8_MEMBER)  \
+    ENTRIES_LIST(DATABASE_EXPAND_AS_BAND4_MEMBER)  \
+    ENTRIES_LIST(DATABASE_EXPAND_AS_BAND2_MEMBER)  \
+    ENTRIES_LIST(DATABASE_EXPAND_AS_BAND1_MEMBER)  \
+  } ram_storage_t;
+
 #define DATABASE_EXPAND_AS_ENTRY(name, type) { offsetof(ram_storage_t, name), sizeof(type) },
 
+#define DATABASE_SORTED_OFFSET(name, type)                                            \
+  (DATABASE_ALIGNMENT_BAND(type) == 8   ? offsetof(ram_storage_t, name##_band8)       \
+      : DATABASE_ALIGNMENT_BAND(type) == 4 ? offsetof(ram_storage_t, name##_band4)    \
+      : DATABASE_ALIGNMENT_BAND(type) == 2 ? offsetof(ram_storage_t, name##_band2)    \
+                                           : offsetof(ram_storage_t, name##_band1))
+
+#define DATABASE_EXPAND_AS_SORTED_ENTRY(name, type) { DATABASE_SORTED_OFFSET(name, type), sizeof(type) },
+
+// Build-time subscriptions per key: SIERA_STATIC_SUBSCRIBE(KEY_NAME, callback, context).
+#define DATABASE_EXPAND_AS_STATIC_DECLARATION(name, type) SIERA_STATIC_SUBSCRIPTIONS_DECLARE(name);
+
+#define DATABASE_EXPAND_AS_STATIC_TABLE(name, type) SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(name),
+
 // USAGE
 
 // DATABASE_ENUM(DATABASE_ENTRIES)
@@ -32,7 +81,24 @@ typedef struct ram_storage_t ram_storage_t;
 //   DATABASE_ENTRIES(DATABASE_EXPAND_AS_ENTRY)
 // };
 
+// Or, to drop the padding between mixed-size values:
+// DATABASE_SORTED_STORAGE(DATABASE_ENTRIES)
+// static const s_database_entry_t database_entries[] = {
+//   DATABASE_ENTRIES(DATABASE_EXPAND_AS_SORTED_ENTRY)
+// };
+
+// DATABASE_ENTRIES(DATABASE_EXPAND_AS_STATIC_DECLARATION)
+// static const event_static_table_t database_static_subscriptions[] = {
+//   DATABASE_ENTRIES(DATABASE_EXPAND_AS_STATIC_TABLE)
+// };
+
 // static const s_database_config_t database_config = {
 //   .entries = database_entries,
 //   .count = NUM_ELEMENTS(database_entries),
+//   .static_subscriptions = database_static_subscriptions,
 // };
+
+// Only keys that get subscribers need RAM for a subscriber list:
+// static RAM_DATASTREAM_SUBSCRIBERS(database_subscribers, 16);
+// ram_datastream_init(&database, &database_config, &database_storage);
+// ram_datastream_set_subscriber_storage(&database, database_subscribers_slots, database_subscribers_events, 16);
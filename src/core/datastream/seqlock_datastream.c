@@ -0,0 +1,283 @@
+#include "seqlock_datastream.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static bool contains(i_datastream_t* interface, datastream_key_t key)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  return key < instance->config->count && instance->config->entries[key].size > 0;
+}
+
+static datastream_size_t size(i_datastream_t* interface, datastream_key_t key)
+{
+  if(contains(interface, key)) {
+    seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+    return instance->config->entries[key].size;
+  }
+  return 0;
+}
+
+// Odd sequence: readers use copies[1] while the writer updates copies[0]; even: the reverse.
+static void advance(seqlock_datastream_t* instance)
+{
+  atomic_thread_fence(memory_order_release);
+  atomic_fetch_add_explicit(&instance->sequence, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+static void store(seqlock_datastream_t* instance, const ram_datastream_entry_t* entry, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  advance(instance);
+  memcpy(instance->copies[0] + entry->offset + offset, data, length);
+  advance(instance);
+  memcpy(instance->copies[1] + entry->offset + offset, data, length);
+}
+
+static void publish(seqlock_datastream_t* instance, datastream_key_t key, const void* data, datastream_size_t offset, datastream_size_t length)
+{
+  datastream_on_change_args_t args = {
+    .key = key,
+    .data = data,
+    .offset = offset,
+    .length = length,
+  };
+
+  event_t* entry_on_change = datastream_subscribers_find(&instance->subscribers, key);
+  event_publish_with(entry_on_change, ram_datastream_static_subscriptions(instance->config, key), &args);
+  event_publish(&instance->all_on_change, &args);
+}
+
+// Called after both copies hold the new value; mirrors ram_datastream's changed().
+static void notify(seqlock_datastream_t* instance, datastream_key_t key, const void* data, datastream_size_t offset, datastream_size_t length)
+{
+  // 0 is reserved for "never changed", so skip it when the sequence wraps.
+  if(++instance->change_sequence == 0) {
+    instance->change_sequence = 1;
+  }
+  if(instance->versions != NULL) {
+    instance->versions[key] = instance->change_sequence;
+  }
+
+  if(instance->batch_depth > 0 && instance->dirty.words != NULL) {
+    bitset_set(&instance->dirty, key);
+    return;
+  }
+
+  publish(instance, key, data, offset, length);
+}
+
+static void read(i_datastream_t* interface, datastream_key_t key, void* out)
+{
+  if(!contains(interface, key)) {
+    return;
+  }
+
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  const ram_datastream_entry_t* entry = &instance->config->entries[key];
+
+  while(true) {
+    uint32_t sequence = atomic_load_explicit(&instance->sequence, memory_order_acquire);
+    memcpy(out, instance->copies[sequence & 1u] + entry->offset, entry->size);
+    atomic_thread_fence(memory_order_acquire);
+
+    if(atomic_load_explicit(&instance->sequence, memory_order_relaxed) == sequence) {
+      return;
+    }
+    atomic_fetch_add_explicit(&instance->retries, 1, memory_order_relaxed);
+  }
+}
+
+// Only the writer modifies the copies, and between writes both hold the same bytes, so the
+// writer can compare against copies[0] without synchronizing.
+static void write(i_datastream_t* interface, datastream_key_t key, const void* data)
+{
+  if(contains(interface, key)) {
+    seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+    const ram_datastream_entry_t* entry = &instance->config->entries[key];
+
+    if(memcmp(instance->copies[0] + entry->offset, data, entry->size)) {
+      store(instance, entry, 0, entry->size, data);
+      notify(instance, key, data, 0, entry->size);
+    }
+  }
+}
+
+static void write_range(i_datastream_t* interface, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  datastream_size_t s = size(interface, key);
+  if(s == 0 || length == 0 || offset > s || length > s - offset) {
+    return;
+  }
+
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  const ram_datastream_entry_t* entry = &instance->config->entries[key];
+  if(memcmp(instance->copies[0] + entry->offset + offset, data, length)) {
+    store(instance, entry, offset, length, data);
+    notify(instance, key, instance->copies[0] + entry->offset, offset, length);
+  }
+}
+
+static bool subscribe(i_datastream_t* interface, datastream_key_t key, event_subscription_t* subscription)
+{
+  if(!contains(interface, key)) {
+    return false;
+  }
+
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  event_t* event = datastream_subscribers_claim(&instance->subscribers, key);
+  if(event == NULL) {
+    return false;
+  }
+
+  event_subscribe(event, subscription);
+  return true;
+}
+
+static void subscribe_all(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  event_subscribe(&instance->all_on_change, subscription);
+}
+
+static void unsubscribe(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  datastream_subscribers_unsubscribe(&instance->subscribers, subscription);
+  event_unsubscribe(&instance->all_on_change, subscription);
+}
+
+static void subscribe_batch(i_datastream_t* interface, event_subscription_t* subscription)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  event_subscribe(&instance->batch_on_change, subscription);
+}
+
+static void begin_batch(i_datastream_t* interface)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  instance->batch_depth++;
+}
+
+static void commit(i_datastream_t* interface)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+
+  if(instance->batch_depth == 0 || --instance->batch_depth > 0) {
+    return;
+  }
+  if(instance->dirty.words == NULL || bitset_is_empty(&instance->dirty)) {
+    return;
+  }
+
+  // The writer's copy is stable on the writer's thread, where subscribers run.
+  bitset_for_each(&instance->dirty, key)
+  {
+    const ram_datastream_entry_t* entry = &instance->config->entries[key];
+    publish(instance, key, instance->copies[0] + entry->offset, 0, entry->size);
+  }
+
+  datastream_on_batch_args_t args = {
+    .keys = &instance->dirty,
+  };
+  event_publish(&instance->batch_on_change, &args);
+
+  bitset_clear_all(&instance->dirty);
+}
+
+static const void* peek(i_datastream_t* interface, datastream_key_t key)
+{
+  (void)interface;
+  (void)key;
+  return NULL;
+}
+
+static void* acquire(i_datastream_t* interface, datastream_key_t key)
+{
+  (void)interface;
+  (void)key;
+  return NULL;
+}
+
+static void release(i_datastream_t* interface, datastream_key_t key)
+{
+  (void)interface;
+  (void)key;
+}
+
+static datastream_version_t version(i_datastream_t* interface, datastream_key_t key)
+{
+  seqlock_datastream_t* instance = (seqlock_datastream_t*)interface;
+  if(instance->versions != NULL && contains(interface, key)) {
+    return instance->versions[key];
+  }
+  return 0;
+}
+
+void seqlock_datastream_init(seqlock_datastream_t* instance, const ram_datastream_config_t* config, void* storage, void* shadow)
+{
+  instance->config = config;
+  instance->copies[0] = (uint8_t*)storage;
+  instance->copies[1] = (uint8_t*)shadow;
+
+  instance->interface = (i_datastream_t){
+    .read = read,
+    .write = write,
+    .write_range = write_range,
+    .contains = contains,
+    .size = size,
+    .subscribe = subscribe,
+    .subscribe_all = subscribe_all,
+    .unsubscribe = unsubscribe,
+    .subscribe_batch = subscribe_batch,
+    .begin_batch = begin_batch,
+    .commit = commit,
+    .peek = peek,
+    .acquire = acquire,
+    .release = release,
+    .version = version,
+  };
+
+  uint32_t storage_size = 0;
+  for(uint16_t i = 0; i < config->count; i++) {
+    uint32_t end = config->entries[i].offset + config->entries[i].size;
+    if(end > storage_size) {
+      storage_size = end;
+    }
+  }
+  memset(storage, 0, storage_size);
+  memset(shadow, 0, storage_size);
+
+  atomic_init(&instance->sequence, 0);
+  atomic_init(&instance->retries, 0);
+  event_init(&instance->all_on_change);
+  event_init(&instance->batch_on_change);
+  instance->subscribers = (datastream_subscribers_t){ 0 };
+  instance->dirty = (bitset_t){ 0 };
+  instance->batch_depth = 0;
+  instance->versions = NULL;
+  instance->change_sequence = 0;
+}
+
+void seqlock_datastream_set_subscriber_storage(seqlock_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity)
+{
+  datastream_subscribers_init(&instance->subscribers, slots, events, capacity);
+}
+
+void seqlock_datastream_set_batch_storage(seqlock_datastream_t* instance, bitset_word_t* dirty)
+{
+  bitset_init(&instance->dirty, dirty, instance->config->count);
+}
+
+void seqlock_datastream_set_version_storage(seqlock_datastream_t* instance, datastream_version_t* versions)
+{
+  instance->versions = versions;
+  for(uint16_t i = 0; i < instance->config->count; i++) {
+    versions[i] = 0;
+  }
+}
+
+uint32_t seqlock_datastream_retries(seqlock_datastream_t* instance)
+{
+  return atomic_load_explicit(&instance->retries, memory_order_relaxed);
+}
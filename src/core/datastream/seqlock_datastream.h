@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "atomic_utils.h"
+#include "datastream_subscribers.h"
+#include "event.h"
+#include "i_datastream.h"
+#include "ram_datastream.h"
+
+/**
+ * Datastream for one writer thread and any number of reader threads, without locks.
+ *
+ * Values live twice, in storage and shadow, behind one sequence counter (a "latch"
+ * seqlock). The writer updates one copy while readers are steered to the other, then
+ * swaps, so it never waits for readers. A reader copies from the copy selected by the
+ * sequence and retries only if the writer swapped during its copy.
+ *
+ * Only the writer thread may call write, write_range, version, the batch functions or the
+ * subscription functions; subscribers run on the writer's thread. Any thread may call read,
+ * contains and size. peek and acquire return NULL, because a pointer into either copy could
+ * be rewritten while the caller holds it.
+ *
+ * Batches and versions work as in ram_datastream once their storage is provided. A batch
+ * only defers notifications: readers see each write as soon as it is made.
+ */
+typedef struct
+{
+  i_datastream_t interface;
+  const ram_datastream_config_t* config;
+  uint8_t* copies[2];
+  SIERA_ATOMIC(uint32_t) sequence;
+  SIERA_ATOMIC(uint32_t) retries;
+  event_t all_on_change;
+  event_t batch_on_change;
+  datastream_subscribers_t subscribers;
+  bitset_t dirty;
+  uint8_t batch_depth;
+  datastream_version_t* versions;
+  datastream_version_t change_sequence;
+} seqlock_datastream_t;
+
+/**
+ * @brief
+ *
+ * @param instance
+ * @param config Same entry table format as ram_datastream.
+ * @param storage
+ * @param shadow A second buffer the same size as storage.
+ */
+void seqlock_datastream_init(seqlock_datastream_t* instance, const ram_datastream_config_t* config, void* storage, void* shadow);
+
+/**
+ * @brief Provide per-key subscriber storage; see ram_datastream_set_subscriber_storage().
+ * Until then datastream_subscribe() returns false.
+ */
+void seqlock_datastream_set_subscriber_storage(seqlock_datastream_t* instance, hash_map_slot_t* slots, event_t* events, uint16_t capacity);
+
+/**
+ * @brief Provide the dirty-key set that datastream_begin_batch() needs; see
+ * ram_datastream_set_batch_storage(). Without it, writes inside a batch keep publishing
+ * immediately.
+ */
+void seqlock_datastream_set_batch_storage(seqlock_datastream_t* instance, bitset_word_t* dirty);
+
+/**
+ * @brief Track a version per key; see ram_datastream_set_version_storage(). Without it,
+ * datastream_version() returns 0.
+ */
+void seqlock_datastream_set_version_storage(seqlock_datastream_t* instance, datastream_version_t* versions);
+
+/**
+ * @brief Number of reads that had to be repeated because the writer swapped copies.
+ */
+uint32_t seqlock_datastream_retries(seqlock_datastream_t* instance);
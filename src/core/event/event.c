@@ -1,26 +1,204 @@
 #include "event.h"
-#include "list.h"
+#include "dlist.h"
+
+#include <stddef.h>
+
+static bool invoke(const event_t* event, event_subscription_t* subscription, const void* data)
+{
+  if(subscription->has_handler) {
+    return subscription->handler(subscription->context, data) == EVENT_STOP;
+  }
+
+#ifdef SIERA_EVENT_ASYNC
+  if(subscription->async_safe && event->async != NULL) {
+    i_event_executor_t* executor = event->async->executor;
+    executor->submit(executor, event->async, subscription->callback, subscription->context, data);
+    return false;
+  }
+#else
+  (void)event;
+#endif
+
+  subscription->callback(subscription->context, data);
+  return false;
+}
 
 void event_init(event_t* event)
 {
-  list_init(&event->subscribers);
+  dlist_init(&event->subscribers);
+#ifdef SIERA_EVENT_PRIORITY
+  for(uint8_t band = 0; band < EVENT_PRIORITY_COUNT; band++) {
+    event->band_tail[band] = NULL;
+  }
+#endif
+#ifdef SIERA_EVENT_ASYNC
+  event->async = NULL;
+#endif
+  event->dispatch = NULL;
+  event->sequence = 0;
+#ifdef SIERA_EVENT_PROFILING
+  event->profile = (event_profile_t){ 0 };
+#endif
+}
+
+#ifdef SIERA_EVENT_ASYNC
+void event_set_async(event_t* event, const event_async_t* async)
+{
+  event->async = async;
 }
+#endif
 
 void event_subscribe(event_t* event, event_subscription_t* subscription)
 {
-  list_push(&event->subscribers, &subscription->node);
+#ifdef SIERA_EVENT_PRIORITY
+  uint8_t band = subscription->priority;
+  dlist_node_t* position = NULL;
+
+  // Insert behind the nearest non-empty band at or above ours.
+  for(int8_t b = (int8_t)band; b >= 0 && position == NULL; b--) {
+    position = event->band_tail[b];
+  }
+
+  dlist_insert_after(&event->subscribers, position, &subscription->node);
+  event->band_tail[band] = &subscription->node;
+#else
+  dlist_push_back(&event->subscribers, &subscription->node);
+#endif
+  subscription->sequence = ++event->sequence;
 }
 
 void event_unsubscribe(event_t* event, event_subscription_t* subscription)
 {
-  list_delete(&event->subscribers, &subscription->node);
+  dlist_node_t* node = &subscription->node;
+
+  // The cursors and band tails below belong to this event; a subscription of another event
+  // must not touch them.
+  if(!dlist_contains(&event->subscribers, node)) {
+    return;
+  }
+
+  for(event_dispatch_t* dispatch = event->dispatch; dispatch != NULL; dispatch = dispatch->outer) {
+    if(dispatch->next == node) {
+      dispatch->next = node->next;
+    }
+#ifdef SIERA_EVENT_PROFILING
+    if(dispatch->current == subscription) {
+      dispatch->current = NULL;
+    }
+#endif
+  }
+
+#ifdef SIERA_EVENT_PRIORITY
+  uint8_t band = subscription->priority;
+  if(event->band_tail[band] == node) {
+    dlist_node_t* prev = node->prev;
+    event->band_tail[band] = (prev != NULL && ((event_subscription_t*)prev)->priority == band) ? prev : NULL;
+  }
+#endif
+
+  dlist_remove(&event->subscribers, node);
+}
+
+#ifdef SIERA_EVENT_PRIORITY
+#define STATIC_BANDS EVENT_PRIORITY_COUNT
+#define BAND(priority) (priority)
+#else
+#define STATIC_BANDS 1
+#define BAND(priority) 0
+#endif
+
+// Runs the static subscribers of one band. The ROM table cannot change underneath us, so it
+// needs no cursor.
+static bool publish_static(const event_static_table_t* table, uint8_t band, const void* data, uint16_t* fan_out)
+{
+  bool stop = false;
+
+  for(const event_static_subscription_t* entry = table->begin; entry < table->end && !stop; entry++) {
+    if(BAND(entry->priority) != band) {
+      continue;
+    }
+
+    if(entry->handler != NULL) {
+      stop = entry->handler(entry->context, data) == EVENT_STOP;
+    }
+    else {
+      entry->callback(entry->context, data);
+    }
+    (*fan_out)++;
+  }
+
+  return stop;
 }
 
 void event_publish(event_t* event, const void* data)
 {
-  list_for_each(&event->subscribers, e)
-  {
-    event_subscription_t* subscription = (event_subscription_t*)e;
-    subscription->callback(subscription->context, data);
+  event_publish_with(event, NULL, data);
+}
+
+void event_publish_with(event_t* event, const event_static_table_t* table, const void* data)
+{
+  uint16_t fan_out = 0;
+  bool stop = false;
+
+  // Bands below static_band have had their static subscribers run.
+  uint8_t static_band = (table != NULL && table->begin != table->end) ? 0 : STATIC_BANDS;
+
+  if(event == NULL) {
+    while(!stop && static_band < STATIC_BANDS) {
+      stop = publish_static(table, static_band++, data, &fan_out);
+    }
+    return;
   }
+
+  // Subscribers added from here on carry a later sequence number and are skipped.
+  event_dispatch_t dispatch = {
+    .next = event->subscribers.head,
+    .sequence = event->sequence,
+    .outer = event->dispatch,
+  };
+  event->dispatch = &dispatch;
+
+  while(!stop && dispatch.next != NULL) {
+    event_subscription_t* subscription = (event_subscription_t*)dispatch.next;
+    dispatch.next = dispatch.next->next;
+
+    if((int32_t)(subscription->sequence - dispatch.sequence) > 0) {
+      continue;
+    }
+
+    while(!stop && static_band <= BAND(subscription->priority)) {
+      stop = publish_static(table, static_band++, data, &fan_out);
+    }
+    if(stop) {
+      break;
+    }
+
+#ifdef SIERA_EVENT_PROFILING
+    // Copied first: a callback may unsubscribe and free its own subscription.
+    void (*callback)(void* context, const void* data) = subscription->callback;
+    void* context = subscription->context;
+    dispatch.current = subscription;
+    event_profiler_ticks_t start = event_profiler_now();
+    stop = invoke(event, subscription, data);
+    event_profiler_ticks_t elapsed = event_profiler_now() - start;
+    if(dispatch.current != NULL) {
+      event_profiler_record_callback(&subscription->profile, subscription, callback, context, elapsed);
+    }
+#else
+    stop = invoke(event, subscription, data);
+#endif
+    fan_out++;
+  }
+
+  while(!stop && static_band < STATIC_BANDS) {
+    stop = publish_static(table, static_band++, data, &fan_out);
+  }
+
+  event->dispatch = dispatch.outer;
+
+#ifdef SIERA_EVENT_PROFILING
+  event_profiler_record_publish(&event->profile, fan_out);
+#else
+  (void)fan_out;
+#endif
 }
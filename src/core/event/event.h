@@ -1,14 +1,105 @@
 #pragma once
 
-#include "list.h"
+#include <stdint.h>
+
+#include "dlist.h"
+#include "event_profiler.h"
+#include "event_static_subscription.h"
 #include "event_subscription.h"
+#include "i_event_executor.h"
+
+/**
+ * Cursor for one in-flight event_publish(). It lives on the publisher's stack and is
+ * linked from the event so that event_unsubscribe() can step it past a node before the
+ * node is unlinked. Nested publishes of the same event chain through outer. With
+ * SIERA_EVENT_PROFILING, current is the subscriber being called; unsubscribing it clears
+ * current, so its timing is not recorded into a subscription that may have been freed.
+ */
+typedef struct event_dispatch_t
+{
+    dlist_node_t* next;
+    uint32_t sequence;
+    struct event_dispatch_t* outer;
+#ifdef SIERA_EVENT_PROFILING
+    event_subscription_t* current;
+#endif
+} event_dispatch_t;
 
+/**
+ * With SIERA_EVENT_PRIORITY (CMake option of the same name) subscribers are kept sorted by
+ * priority band; band_tail holds the last subscriber of each band so that subscribing is
+ * O(1) regardless of how many subscribers there are. Without it subscribers run in
+ * subscription order and the event is EVENT_PRIORITY_COUNT pointers smaller.
+ */
 typedef struct
 {
-    list_t subscribers;
+    dlist_t subscribers;
+#ifdef SIERA_EVENT_PRIORITY
+    dlist_node_t* band_tail[EVENT_PRIORITY_COUNT];
+#endif
+#ifdef SIERA_EVENT_ASYNC
+    const event_async_t* async;
+#endif
+    event_dispatch_t* dispatch;
+    uint32_t sequence;
+#ifdef SIERA_EVENT_PROFILING
+    event_profile_t profile;
+#endif
 } event_t;
 
 void event_init(event_t* event);
+
+/**
+ * @brief Add a subscriber after the existing subscribers of its priority band, or after
+ * all existing subscribers without SIERA_EVENT_PRIORITY. Safe to
+ * call from a callback of the same event; the new subscriber is first called on the next
+ * publish.
+ */
 void event_subscribe(event_t* event, event_subscription_t* subscription);
+
+#ifdef SIERA_EVENT_ASYNC
+/**
+ * @brief Hand this event's async-safe subscribers to an executor on publish. Only built
+ * with SIERA_EVENT_ASYNC (CMake option of the same name, implied by SIERA_HOST_EXECUTOR).
+ *
+ * @param event
+ * @param async Executor and payload description, or NULL to run every subscriber inline.
+ */
+void event_set_async(event_t* event, const event_async_t* async);
+#endif
+
+/**
+ * @brief Remove a subscriber. Safe to call from a callback of the same event, for any
+ * subscriber including the one currently running; a removed subscriber that has not been
+ * called yet by an in-flight publish will not be called by it.
+ */
 void event_unsubscribe(event_t* event, event_subscription_t* subscription);
-void event_publish(event_t* event, const void* data);
\ No newline at end of file
+
+/**
+ * @brief Call each subscriber in priority order until one with a handler returns
+ * EVENT_STOP.
+ */
+void event_publish(event_t* event, const void* data);
+
+/**
+ * @brief As event_publish(), also dispatching a ROM table of build-time subscriptions
+ * (see SIERA_STATIC_SUBSCRIBE). Each band runs its static subscribers before its dynamic
+ * ones; without SIERA_EVENT_PRIORITY all static subscribers run first.
+ *
+ * @param event Dynamic subscribers, or NULL if there are none.
+ * @param table Static subscribers, or NULL if there are none.
+ * @param data
+ */
+void event_publish_with(event_t* event, const event_static_table_t* table, const void* data);
+
+/**
+ * Publish a global event_t together with the static subscriptions tagged with its name.
+ * The table bounds are link-time constants, so the event carries nothing extra.
+ */
+#define SIERA_EVENT_PUBLISH(event, data)                       \
+  do {                                                         \
+    SIERA_STATIC_SUBSCRIPTIONS_DECLARE(event);                 \
+    static const event_static_table_t siera_static_table =     \
+      SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(event);           \
+    event_publish_with(&(event), &siera_static_table, (data)); \
+  } while(0)
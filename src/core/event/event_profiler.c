@@ -0,0 +1,101 @@
+#include "event_profiler.h"
+
+#ifdef SIERA_EVENT_PROFILING
+
+#include <stddef.h>
+
+static i_event_profiler_clock_t* profiler_clock;
+static event_profiler_entry_t top[EVENT_PROFILER_TOP_N];
+static uint16_t top_count;
+
+void event_profiler_set_clock(i_event_profiler_clock_t* clock)
+{
+  profiler_clock = clock;
+}
+
+event_profiler_ticks_t event_profiler_now(void)
+{
+  return profiler_clock != NULL ? profiler_clock->now(profiler_clock) : 0;
+}
+
+void event_profiler_record_publish(event_profile_t* profile, uint16_t fan_out)
+{
+  profile->publish_count++;
+  profile->callback_count += fan_out;
+  if(fan_out > profile->max_fan_out) {
+    profile->max_fan_out = fan_out;
+  }
+}
+
+// Keeps a bounded table of the costliest subscribers seen so far. Entries are copies, so
+// a subscription going out of scope never leaves a dangling pointer to read.
+static void track(const event_profiler_entry_t* entry)
+{
+  uint16_t cheapest = 0;
+
+  for(uint16_t i = 0; i < top_count; i++) {
+    if(top[i].subscription == entry->subscription) {
+      top[i] = *entry;
+      return;
+    }
+    if(top[i].profile.total_ticks < top[cheapest].profile.total_ticks) {
+      cheapest = i;
+    }
+  }
+
+  if(top_count < EVENT_PROFILER_TOP_N) {
+    top[top_count++] = *entry;
+  }
+  else if(entry->profile.total_ticks > top[cheapest].profile.total_ticks) {
+    top[cheapest] = *entry;
+  }
+}
+
+void event_profiler_record_callback(
+  event_subscription_profile_t* profile,
+  const void* subscription,
+  void (*callback)(void* context, const void* data),
+  void* context,
+  event_profiler_ticks_t elapsed)
+{
+  profile->call_count++;
+  profile->total_ticks += elapsed;
+  if(elapsed > profile->max_ticks) {
+    profile->max_ticks = elapsed;
+  }
+
+  event_profiler_entry_t entry = {
+    .subscription = subscription,
+    .callback = callback,
+    .context = context,
+    .profile = *profile,
+  };
+  track(&entry);
+}
+
+uint16_t event_profiler_top(event_profiler_entry_t* out, uint16_t max)
+{
+  uint16_t count = top_count < max ? top_count : max;
+  bool taken[EVENT_PROFILER_TOP_N] = { false };
+
+  // Selection sort: the table is tiny and this runs only when someone asks for a report.
+  for(uint16_t n = 0; n < count; n++) {
+    int32_t best = -1;
+    for(uint16_t i = 0; i < top_count; i++) {
+      if(!taken[i] && (best < 0 || top[i].profile.total_ticks > top[best].profile.total_ticks)) {
+        best = i;
+      }
+    }
+    taken[best] = true;
+    out[n] = top[best];
+  }
+
+  return count;
+}
+
+void event_profiler_reset(void)
+{
+  top_count = 0;
+}
+
+#endif
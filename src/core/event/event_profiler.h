@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * Opt-in dispatch profiling for event_t / event_subscription_t, enabled by defining
+ * SIERA_EVENT_PROFILING (CMake option of the same name). When it is not defined the
+ * profile fields and the timing in event_publish() are compiled out entirely.
+ *
+ * Only dynamic subscriptions are timed. Static subscriptions (SIERA_STATIC_SUBSCRIBE) live
+ * in ROM with nowhere to keep a profile; they count toward an event's fan-out but never
+ * appear in event_profiler_top(). A subscriber that unsubscribes itself from its own
+ * callback is not timed for that call.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef EVENT_PROFILER_TOP_N
+#define EVENT_PROFILER_TOP_N 8
+#endif
+
+typedef uint32_t event_profiler_ticks_t;
+
+typedef struct i_event_profiler_clock_t {
+  /**
+   * @brief Free-running high-resolution counter, e.g. a cycle counter. Only differences
+   * are used, so wrap-around is fine as long as a single callback is shorter than a wrap.
+   */
+  event_profiler_ticks_t (*now)(struct i_event_profiler_clock_t* instance);
+} i_event_profiler_clock_t;
+
+typedef struct {
+  uint32_t publish_count;
+  uint32_t callback_count;
+  uint16_t max_fan_out;
+} event_profile_t;
+
+typedef struct {
+  uint32_t call_count;
+  uint64_t total_ticks;
+  event_profiler_ticks_t max_ticks;
+} event_subscription_profile_t;
+
+/**
+ * Snapshot of one subscriber's statistics, identified by the subscription's address,
+ * callback and context.
+ */
+typedef struct {
+  const void* subscription;
+  void (*callback)(void* context, const void* data);
+  void* context;
+  event_subscription_profile_t profile;
+} event_profiler_entry_t;
+
+#ifdef SIERA_EVENT_PROFILING
+
+/**
+ * @brief Set the clock used to time subscriber callbacks. Without a clock only counts are
+ * recorded.
+ *
+ * @param clock Clock to use, or NULL to stop timing.
+ */
+void event_profiler_set_clock(i_event_profiler_clock_t* clock);
+
+event_profiler_ticks_t event_profiler_now(void);
+
+/**
+ * @brief Copy the most expensive subscribers by cumulative callback time, most expensive
+ * first. Up to EVENT_PROFILER_TOP_N subscribers are tracked.
+ *
+ * @param out
+ * @param max Capacity of out.
+ * @return uint16_t Number of entries written.
+ */
+uint16_t event_profiler_top(event_profiler_entry_t* out, uint16_t max);
+
+/**
+ * @brief Forget the tracked top subscribers. Per-event and per-subscription counters live
+ * in those objects and are not touched.
+ */
+void event_profiler_reset(void);
+
+void event_profiler_record_publish(event_profile_t* profile, uint16_t fan_out);
+
+void event_profiler_record_callback(
+  event_subscription_profile_t* profile,
+  const void* subscription,
+  void (*callback)(void* context, const void* data),
+  void* context,
+  event_profiler_ticks_t elapsed);
+
+#endif
@@ -0,0 +1,140 @@
+#include "event_queue.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static uint16_t aligned_size(uint16_t size)
+{
+  return (uint16_t)((size + EVENT_QUEUE_PAYLOAD_ALIGNMENT - 1u) & ~(EVENT_QUEUE_PAYLOAD_ALIGNMENT - 1u));
+}
+
+static void default_dispatch(event_t* event, uint16_t key, const void* payload, uint16_t size)
+{
+  (void)key;
+  (void)size;
+  event_publish(event, payload);
+}
+
+// Entries before next_dispatch were already delivered during the current drain.
+static event_queue_entry_t* find_pending(event_queue_t* queue, event_t* event, uint16_t key, event_queue_dispatch_t dispatch)
+{
+  for(uint16_t i = queue->next_dispatch; i < queue->count; i++) {
+    event_queue_entry_t* entry = &queue->entries[i];
+    if(entry->event == event && entry->key == key && entry->dispatch == dispatch) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static bool allocate_payload(event_queue_t* queue, uint16_t size, uint16_t* offset)
+{
+  uint16_t needed = aligned_size(size);
+
+  if(needed > queue->payload_capacity - queue->payload_used) {
+    return false;
+  }
+
+  *offset = queue->payload_used;
+  queue->payload_used += needed;
+  return true;
+}
+
+void event_queue_init(event_queue_t* queue, event_queue_entry_t* entries, uint16_t entry_capacity, void* payload, uint16_t payload_capacity)
+{
+  queue->entries = entries;
+  queue->payload = (uint8_t*)payload;
+  queue->entry_capacity = entry_capacity;
+  queue->payload_capacity = payload_capacity;
+  queue->count = 0;
+  queue->payload_used = 0;
+  queue->next_dispatch = 0;
+  queue->coalesced = 0;
+  queue->dropped = 0;
+}
+
+bool event_queue_publish(event_queue_t* queue, event_t* event, uint16_t key, const void* data, uint16_t size)
+{
+  return event_queue_publish_with(queue, event, key, data, size, default_dispatch);
+}
+
+bool event_queue_publish_with(event_queue_t* queue, event_t* event, uint16_t key, const void* data, uint16_t size, event_queue_dispatch_t dispatch)
+{
+  event_queue_entry_t* entry = find_pending(queue, event, key, dispatch);
+
+  if(entry != NULL) {
+    // A payload of a different size cannot be overwritten in place; its old bytes are
+    // reclaimed on the next drain.
+    if(size != entry->size) {
+      uint16_t offset;
+      if(!allocate_payload(queue, size, &offset)) {
+        queue->dropped++;
+        return false;
+      }
+      entry->offset = offset;
+      entry->size = size;
+    }
+
+    memcpy(queue->payload + entry->offset, data, size);
+    queue->coalesced++;
+    return true;
+  }
+
+  uint16_t offset;
+  if(queue->count >= queue->entry_capacity || !allocate_payload(queue, size, &offset)) {
+    queue->dropped++;
+    return false;
+  }
+
+  entry = &queue->entries[queue->count++];
+  entry->event = event;
+  entry->dispatch = dispatch;
+  entry->key = key;
+  entry->offset = offset;
+  entry->size = size;
+  memcpy(queue->payload + offset, data, size);
+
+  return true;
+}
+
+uint16_t event_queue_drain(event_queue_t* queue)
+{
+  uint16_t end = queue->count;
+  uint16_t payload_mark = queue->payload_used;
+
+  for(uint16_t i = 0; i < end; i++) {
+    queue->next_dispatch = (uint16_t)(i + 1u);
+    const event_queue_entry_t* entry = &queue->entries[i];
+    entry->dispatch(entry->event, entry->key, queue->payload + entry->offset, entry->size);
+  }
+
+  // Anything queued by subscribers was appended past both marks; slide it to the front.
+  uint16_t carried = (uint16_t)(queue->count - end);
+  memmove(queue->entries, &queue->entries[end], carried * sizeof(event_queue_entry_t));
+  memmove(queue->payload, queue->payload + payload_mark, queue->payload_used - payload_mark);
+
+  for(uint16_t i = 0; i < carried; i++) {
+    queue->entries[i].offset -= payload_mark;
+  }
+
+  queue->count = carried;
+  queue->payload_used -= payload_mark;
+  queue->next_dispatch = 0;
+
+  return end;
+}
+
+uint16_t event_queue_pending(const event_queue_t* queue)
+{
+  return queue->count;
+}
+
+uint32_t event_queue_coalesced(const event_queue_t* queue)
+{
+  return queue->coalesced;
+}
+
+uint32_t event_queue_dropped(const event_queue_t* queue)
+{
+  return queue->dropped;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "event.h"
+
+#define EVENT_QUEUE_PAYLOAD_ALIGNMENT sizeof(uint64_t)
+
+/**
+ * Declares the entry table and payload buffer for a deferred event queue. The payload
+ * buffer is uint64_t-backed so copied payloads can be read back as any scalar or struct.
+ *
+ * static EVENT_QUEUE_ENTRIES(deferred_entries, 32);
+ * static EVENT_QUEUE_PAYLOAD(deferred_payload, 256);
+ */
+#define EVENT_QUEUE_ENTRIES(name, count) event_queue_entry_t name[count]
+#define EVENT_QUEUE_PAYLOAD(name, bytes) uint64_t name[((bytes) + sizeof(uint64_t) - 1u) / sizeof(uint64_t)]
+
+/**
+ * Delivers a drained entry. The default publishes the copied payload as-is; publishers
+ * whose subscribers expect a wrapper (e.g. datastream_on_change_args_t) rebuild it here.
+ */
+typedef void (*event_queue_dispatch_t)(event_t* event, uint16_t key, const void* payload, uint16_t size);
+
+typedef struct {
+  event_t* event;
+  event_queue_dispatch_t dispatch;
+  uint16_t key;
+  uint16_t offset;
+  uint16_t size;
+} event_queue_entry_t;
+
+/**
+ * Bounded queue of deferred publishes. Publishing the same event/key again before the
+ * next drain overwrites the pending payload instead of queueing another callback.
+ */
+typedef struct {
+  event_queue_entry_t* entries;
+  uint8_t* payload;
+  uint16_t entry_capacity;
+  uint16_t payload_capacity;
+  uint16_t count;
+  uint16_t payload_used;
+  uint16_t next_dispatch;
+  uint32_t coalesced;
+  uint32_t dropped;
+} event_queue_t;
+
+/**
+ * @brief Initialize an empty queue over caller-provided storage.
+ *
+ * @param queue
+ * @param entries See EVENT_QUEUE_ENTRIES.
+ * @param entry_capacity Maximum number of distinct event/key pairs pending at once.
+ * @param payload See EVENT_QUEUE_PAYLOAD; must be EVENT_QUEUE_PAYLOAD_ALIGNMENT aligned.
+ * @param payload_capacity Size of the payload buffer in bytes.
+ */
+void event_queue_init(event_queue_t* queue, event_queue_entry_t* entries, uint16_t entry_capacity, void* payload, uint16_t payload_capacity);
+
+/**
+ * @brief Queue a publish of event with a copy of data, coalescing with any pending
+ * publish of the same event and key. The copy is passed to subscribers on drain.
+ *
+ * @return false if the queue or payload buffer is full; the publish is dropped.
+ */
+bool event_queue_publish(event_queue_t* queue, event_t* event, uint16_t key, const void* data, uint16_t size);
+
+/**
+ * @brief As event_queue_publish(), but deliver through dispatch instead of event_publish().
+ */
+bool event_queue_publish_with(event_queue_t* queue, event_t* event, uint16_t key, const void* data, uint16_t size, event_queue_dispatch_t dispatch);
+
+/**
+ * @brief Dispatch every pending publish in the order it was first queued. Publishes made
+ * by subscribers during the drain are kept for the next drain.
+ *
+ * @return uint16_t Number of publishes dispatched.
+ */
+uint16_t event_queue_drain(event_queue_t* queue);
+
+uint16_t event_queue_pending(const event_queue_t* queue);
+
+/**
+ * @brief Number of publishes folded into an already-pending entry.
+ */
+uint32_t event_queue_coalesced(const event_queue_t* queue);
+
+/**
+ * @brief Number of publishes dropped because the queue was full.
+ */
+uint32_t event_queue_dropped(const event_queue_t* queue);
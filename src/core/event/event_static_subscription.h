@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_subscription.h"
+#include "utils.h"
+
+/**
+ * Subscriptions fixed at build time. SIERA_STATIC_SUBSCRIBE places a const entry in a
+ * linker section named after a tag; the GNU linker defines __start_<section> and
+ * __stop_<section> around every such section, so all wirings for a tag form one ROM
+ * table with no runtime registration and no RAM. A tag is any identifier: the name of a
+ * global event_t, or a datastream key (see DATABASE_EXPAND_AS_STATIC_TABLE).
+ *
+ * // Anywhere in the program:
+ * SIERA_STATIC_SUBSCRIBE(button_pressed, on_button_pressed, NULL);
+ * SIERA_STATIC_SUBSCRIBE_HANDLER(button_pressed, EVENT_PRIORITY_CRITICAL, interlock, NULL);
+ *
+ * // Where the event is published:
+ * SIERA_EVENT_PUBLISH(button_pressed, &args);
+ *
+ * Static subscribers take part in priority dispatch like dynamic ones: each band runs its
+ * static subscribers, in unspecified order, before its dynamic subscribers, and a handler
+ * returning EVENT_STOP skips everything after it.
+ */
+
+typedef struct {
+  event_subscription_callback_t callback;
+  // Set instead of callback by SIERA_STATIC_SUBSCRIBE_HANDLER.
+  event_subscription_handler_t handler;
+  void* context;
+  uint8_t priority;
+} event_static_subscription_t;
+
+typedef struct {
+  const event_static_subscription_t* begin;
+  const event_static_subscription_t* end;
+} event_static_table_t;
+
+#define SIERA_STATIC_SUBSCRIPTION_ENTRY(tag, ...)                                           \
+  static const event_static_subscription_t CONCAT(siera_static_subscription_, __COUNTER__) \
+    __attribute__((used, section("siera_sub_" #tag), aligned(sizeof(void*)))) = { __VA_ARGS__ }
+
+#define SIERA_STATIC_SUBSCRIBE(tag, callback, context) \
+  SIERA_STATIC_SUBSCRIPTION_ENTRY(tag, (callback), NULL, (context), EVENT_PRIORITY_NORMAL)
+
+/**
+ * A static subscription in the given band whose handler can stop propagation.
+ */
+#define SIERA_STATIC_SUBSCRIBE_HANDLER(tag, priority, handler, context) \
+  SIERA_STATIC_SUBSCRIPTION_ENTRY(tag, NULL, (handler), (context), (priority))
+
+/**
+ * Declares the section bounds for a tag. They are weak so that a tag nobody subscribed to
+ * yields an empty table instead of a link error. Use at file or block scope.
+ */
+#define SIERA_STATIC_SUBSCRIPTIONS_DECLARE(tag)                                                    \
+  extern const event_static_subscription_t __start_siera_sub_##tag[] __attribute__((weak)); \
+  extern const event_static_subscription_t __stop_siera_sub_##tag[] __attribute__((weak))
+
+/**
+ * Brace initializer for the tag's event_static_table_t; usable in static initializers.
+ */
+#define SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(tag) { __start_siera_sub_##tag, __stop_siera_sub_##tag }
+
+#define SIERA_STATIC_SUBSCRIPTIONS(tag) ((event_static_table_t)SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(tag))
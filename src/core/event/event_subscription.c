@@ -2,6 +2,35 @@
 
 void event_subscription_init(event_subscription_t* subscription, event_subscription_callback_t callback, void* context)
 {
+  dlist_node_init(&subscription->node);
   subscription->callback = callback;
   subscription->context = context;
+  subscription->sequence = 0;
+  subscription->priority = EVENT_PRIORITY_NORMAL;
+  subscription->has_handler = false;
+#ifdef SIERA_EVENT_ASYNC
+  subscription->async_safe = false;
+#endif
+#ifdef SIERA_EVENT_PROFILING
+  subscription->profile = (event_subscription_profile_t){ 0 };
+#endif
 }
+
+void event_subscription_init_handler(event_subscription_t* subscription, event_subscription_handler_t handler, void* context)
+{
+  event_subscription_init(subscription, NULL, context);
+  subscription->handler = handler;
+  subscription->has_handler = true;
+}
+
+void event_subscription_set_priority(event_subscription_t* subscription, event_priority_t priority)
+{
+  subscription->priority = (uint8_t)priority;
+}
+
+#ifdef SIERA_EVENT_ASYNC
+void event_subscription_set_async_safe(event_subscription_t* subscription, bool async_safe)
+{
+  subscription->async_safe = async_safe;
+}
+#endif
@@ -1,13 +1,73 @@
 #pragma once
 
-#include "list.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dlist.h"
+#include "event_profiler.h"
 
 typedef void (*event_subscription_callback_t)(void* context, const void* data);
 
+typedef enum {
+  EVENT_CONTINUE,
+  EVENT_STOP,
+} event_propagation_t;
+
+/**
+ * Like event_subscription_callback_t, but returning EVENT_STOP skips the subscribers
+ * that would run after this one for the current publish.
+ */
+typedef event_propagation_t (*event_subscription_handler_t)(void* context, const void* data);
+
+/**
+ * Dispatch bands, highest first. Within a band subscribers run in subscription order.
+ */
+typedef enum {
+  EVENT_PRIORITY_CRITICAL,
+  EVENT_PRIORITY_HIGH,
+  EVENT_PRIORITY_NORMAL,
+  EVENT_PRIORITY_LOW,
+  EVENT_PRIORITY_COUNT,
+} event_priority_t;
+
 typedef struct {
-  list_node_t node;
-  event_subscription_callback_t callback;
+  dlist_node_t node;
+  union {
+    event_subscription_callback_t callback;
+    event_subscription_handler_t handler;
+  };
   void* context;
+  uint32_t sequence;
+  uint8_t priority;
+  bool has_handler;
+#ifdef SIERA_EVENT_ASYNC
+  bool async_safe;
+#endif
+#ifdef SIERA_EVENT_PROFILING
+  event_subscription_profile_t profile;
+#endif
 } event_subscription_t;
 
 void event_subscription_init(event_subscription_t* subscription, event_subscription_callback_t callback, void* context);
+
+/**
+ * @brief Initialize a subscription whose handler can stop propagation to the remaining
+ * subscribers of a publish.
+ */
+void event_subscription_init_handler(event_subscription_t* subscription, event_subscription_handler_t handler, void* context);
+
+/**
+ * @brief Set the dispatch band. Subscriptions default to EVENT_PRIORITY_NORMAL. Only call
+ * while the subscription is not subscribed to any event. Ignored by events unless
+ * SIERA_EVENT_PRIORITY is defined.
+ */
+void event_subscription_set_priority(event_subscription_t* subscription, event_priority_t priority);
+
+#ifdef SIERA_EVENT_ASYNC
+/**
+ * @brief Allow this subscriber to be run by an event's executor (see event_set_async())
+ * instead of on the publisher's stack. It then receives a copy of the payload and may run
+ * concurrently with itself and with other subscribers. Handlers always run inline.
+ */
+void event_subscription_set_async_safe(event_subscription_t* subscription, bool async_safe);
+#endif
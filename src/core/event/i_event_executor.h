@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "event_subscription.h"
+
+typedef struct event_async_t event_async_t;
+
+typedef struct i_event_executor_t {
+  /**
+   * @brief Arrange for callback(context, copy of data) to run later, possibly on another
+   * thread. The payload must be snapshotted with event_async_copy() before returning,
+   * since data belongs to the publisher.
+   *
+   * @param instance
+   * @param async The publishing event's async configuration.
+   * @param callback
+   * @param context
+   * @param data
+   */
+  void (*submit)(
+    struct i_event_executor_t* instance,
+    const event_async_t* async,
+    event_subscription_callback_t callback,
+    void* context,
+    const void* data);
+} i_event_executor_t;
+
+/**
+ * Per-event configuration for handing async-safe subscribers to an executor.
+ */
+struct event_async_t {
+  i_event_executor_t* executor;
+  // Bytes needed to hold a copied payload.
+  uint16_t payload_size;
+  // Deep copy for payloads that hold pointers; NULL copies payload_size bytes.
+  void (*copy)(const event_async_t* async, void* destination, const void* data);
+  void* copy_context;
+};
+
+static inline void event_async_copy(const event_async_t* async, void* destination, const void* data)
+{
+  if(async->copy != NULL) {
+    async->copy(async, destination, data);
+  }
+  else {
+    memcpy(destination, data, async->payload_size);
+  }
+}
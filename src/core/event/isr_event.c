@@ -0,0 +1,59 @@
+#include "isr_event.h"
+
+void isr_event_set_init(isr_event_set_t* set, isr_event_t** events, SIERA_ATOMIC(uint32_t) * pending, uint16_t capacity)
+{
+  set->events = events;
+  set->pending = pending;
+  set->capacity = capacity;
+  set->count = 0;
+
+  for(uint16_t i = 0; i < ISR_EVENT_WORDS(capacity); i++) {
+    atomic_init(&set->pending[i], 0);
+  }
+}
+
+bool isr_event_init(isr_event_t* event, isr_event_set_t* set)
+{
+  if(set->count >= set->capacity) {
+    return false;
+  }
+
+  event_init(&event->event);
+  atomic_init(&event->payload, 0);
+  event->set = set;
+  event->index = set->count;
+  set->events[set->count++] = event;
+
+  return true;
+}
+
+void event_publish_from_isr(isr_event_t* event, uint32_t payload)
+{
+  uint16_t index = event->index;
+
+  atomic_store_explicit(&event->payload, payload, memory_order_relaxed);
+  // Release orders the payload store before the bit becomes visible to the drain.
+  atomic_fetch_or_explicit(&event->set->pending[index / ISR_EVENT_WORD_BITS], 1u << (index % ISR_EVENT_WORD_BITS), memory_order_release);
+}
+
+uint16_t isr_event_set_drain(isr_event_set_t* set)
+{
+  uint16_t published = 0;
+
+  for(uint16_t word = 0; word < ISR_EVENT_WORDS(set->capacity); word++) {
+    // Take the whole word at once; anything an ISR sets after this lands in the next drain.
+    uint32_t bits = atomic_exchange_explicit(&set->pending[word], 0, memory_order_acquire);
+
+    while(bits != 0) {
+      uint16_t index = (uint16_t)(word * ISR_EVENT_WORD_BITS + (uint32_t)__builtin_ctz(bits));
+      bits &= bits - 1u;
+
+      isr_event_t* event = set->events[index];
+      uint32_t payload = atomic_load_explicit(&event->payload, memory_order_relaxed);
+      event_publish(&event->event, &payload);
+      published++;
+    }
+  }
+
+  return published;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "atomic_utils.h"
+#include "event.h"
+
+#define ISR_EVENT_WORD_BITS 32u
+#define ISR_EVENT_WORDS(capacity) (((capacity) + ISR_EVENT_WORD_BITS - 1u) / ISR_EVENT_WORD_BITS)
+
+/**
+ * Declares the registration table and pending bits for an isr_event_set_t:
+ *
+ * static ISR_EVENT_SET_STORAGE(isr_events, 8);
+ * isr_event_set_init(&set, isr_events_events, isr_events_pending, 8);
+ */
+#define ISR_EVENT_SET_STORAGE(name, capacity) \
+  isr_event_t* name##_events[capacity];       \
+  SIERA_ATOMIC(uint32_t) name##_pending[ISR_EVENT_WORDS(capacity)]
+
+typedef struct isr_event_set_t isr_event_set_t;
+
+/**
+ * An event that interrupt handlers and foreign threads may publish. Publishing only sets
+ * a pending bit; subscribers run later from isr_event_set_drain() on the main loop. The
+ * optional payload is a single word and the latest value wins.
+ */
+typedef struct {
+  event_t event;
+  SIERA_ATOMIC(uint32_t) payload;
+  isr_event_set_t* set;
+  uint16_t index;
+} isr_event_t;
+
+struct isr_event_set_t {
+  isr_event_t** events;
+  SIERA_ATOMIC(uint32_t) * pending;
+  uint16_t capacity;
+  uint16_t count;
+};
+
+/**
+ * @brief Initialize an empty set over caller-provided storage (see ISR_EVENT_SET_STORAGE).
+ */
+void isr_event_set_init(isr_event_set_t* set, isr_event_t** events, SIERA_ATOMIC(uint32_t) * pending, uint16_t capacity);
+
+/**
+ * @brief Initialize an ISR event and register it with a set. Call from the main context
+ * before the interrupt that publishes it is enabled.
+ *
+ * @return false if the set is full.
+ */
+bool isr_event_init(isr_event_t* event, isr_event_set_t* set);
+
+/**
+ * @brief Mark the event pending. Interrupt- and thread-safe, lock-free, never calls
+ * subscribers: one relaxed store for the payload and one atomic OR for the pending bit.
+ *
+ * @param event
+ * @param payload Delivered to subscribers as a const uint32_t*; later publishes before the
+ * next drain overwrite it.
+ */
+void event_publish_from_isr(isr_event_t* event, uint32_t payload);
+
+/**
+ * @brief Publish every pending event to its subscribers, in registration order. Main
+ * context only.
+ *
+ * @return uint16_t Number of events published.
+ */
+uint16_t isr_event_set_drain(isr_event_set_t* set);
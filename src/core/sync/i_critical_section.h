@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+
+/**
+ * Mutual exclusion for code shared between threads or between a task and an interrupt.
+ * Sections are not recursive: a holder must not enter again before exiting.
+ */
+typedef struct i_critical_section_t {
+  void (*enter)(struct i_critical_section_t* instance);
+  bool (*try_enter)(struct i_critical_section_t* instance);
+  void (*exit)(struct i_critical_section_t* instance);
+} i_critical_section_t;
+
+/**
+ * @brief Block until the caller owns the section.
+ */
+static inline void critical_section_enter(i_critical_section_t* instance)
+{
+  instance->enter(instance);
+}
+
+/**
+ * @brief Take the section only if nobody holds it.
+ *
+ * @return true if the caller now owns the section.
+ */
+static inline bool critical_section_try_enter(i_critical_section_t* instance)
+{
+  return instance->try_enter(instance);
+}
+
+static inline void critical_section_exit(i_critical_section_t* instance)
+{
+  instance->exit(instance);
+}
@@ -0,0 +1,26 @@
+#include "null_critical_section.h"
+
+static void enter(i_critical_section_t* interface)
+{
+  (void)interface;
+}
+
+static bool try_enter(i_critical_section_t* interface)
+{
+  (void)interface;
+  return true;
+}
+
+static void exit_section(i_critical_section_t* interface)
+{
+  (void)interface;
+}
+
+void null_critical_section_init(null_critical_section_t* instance)
+{
+  instance->interface = (i_critical_section_t){
+    .enter = enter,
+    .try_enter = try_enter,
+    .exit = exit_section,
+  };
+}
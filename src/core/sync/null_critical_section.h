@@ -0,0 +1,13 @@
+#pragma once
+
+#include "i_critical_section.h"
+
+/**
+ * Critical section that never excludes anyone, for single-threaded builds where a
+ * component still asks for an i_critical_section_t.
+ */
+typedef struct {
+  i_critical_section_t interface;
+} null_critical_section_t;
+
+void null_critical_section_init(null_critical_section_t* instance);
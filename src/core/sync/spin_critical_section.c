@@ -0,0 +1,36 @@
+#include "spin_critical_section.h"
+
+#include <stddef.h>
+
+static bool try_enter(i_critical_section_t* interface)
+{
+  spin_critical_section_t* instance = (spin_critical_section_t*)interface;
+  return !atomic_flag_test_and_set_explicit(&instance->flag, memory_order_acquire);
+}
+
+static void enter(i_critical_section_t* interface)
+{
+  spin_critical_section_t* instance = (spin_critical_section_t*)interface;
+  while(!try_enter(interface)) {
+    if(instance->relax != NULL) {
+      instance->relax();
+    }
+  }
+}
+
+static void exit_section(i_critical_section_t* interface)
+{
+  spin_critical_section_t* instance = (spin_critical_section_t*)interface;
+  atomic_flag_clear_explicit(&instance->flag, memory_order_release);
+}
+
+void spin_critical_section_init(spin_critical_section_t* instance, void (*relax)(void))
+{
+  instance->interface = (i_critical_section_t){
+    .enter = enter,
+    .try_enter = try_enter,
+    .exit = exit_section,
+  };
+  atomic_flag_clear(&instance->flag);
+  instance->relax = relax;
+}
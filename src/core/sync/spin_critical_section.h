@@ -0,0 +1,23 @@
+#pragma once
+
+#include "atomic_utils.h"
+#include "i_critical_section.h"
+
+/**
+ * Busy-waiting critical section on a single atomic flag, for very short sections on
+ * multi-core targets. On a single core a waiter can only make progress once the holder
+ * is scheduled again, so pass a relax hook that yields (e.g. sched_yield on a host) there.
+ */
+typedef struct {
+  i_critical_section_t interface;
+  SIERA_ATOMIC_FLAG flag;
+  void (*relax)(void);
+} spin_critical_section_t;
+
+/**
+ * @brief
+ *
+ * @param instance
+ * @param relax Called on every failed attempt while waiting, or NULL to spin.
+ */
+void spin_critical_section_init(spin_critical_section_t* instance, void (*relax)(void));
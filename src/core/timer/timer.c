@@ -4,33 +4,63 @@ void timer_controller_init(s_timer_controller_t* controller, i_timesource_t* tim
 {
   controller->timesource = timesource;
   controller->current_ticks = timesource->get_ticks(timesource);
-  list_init(&controller->timers);
+  dlist_init(&controller->timers);
+  controller->cursor = NULL;
+  controller->pass = 0;
+  controller->running = false;
+  dlist_init(&controller->pass_hooks);
 }
 
 timesource_ticks_t timer_controller_run(s_timer_controller_t* controller)
 {
   controller->current_ticks = controller->timesource->get_ticks(controller->timesource);
+
+  dlist_for_each_safe(&controller->pass_hooks, node, next)
+  {
+    timer_pass_hook_t* hook = (timer_pass_hook_t*)node;
+    hook->callback(hook->context);
+  }
+
   timesource_ticks_t min_ticks_to_next = UINT32_MAX;
 
-  list_node_t* current = controller->timers.head;
-  while(current != NULL) {
-    list_node_t* next = current->next;
+  controller->cursor = controller->timers.head;
+  controller->pass++;
+  controller->running = true;
+
+  while(controller->cursor != NULL) {
+    dlist_node_t* current = controller->cursor;
+    controller->cursor = current->next;
     s_timer_t* timer = (s_timer_t*)current;
 
     int32_t ticks_until_expiration = (int32_t)(timer->next_expiration_ticks - controller->current_ticks);
 
-    if(ticks_until_expiration <= 0) {
+    // Started by a callback of this pass: it waits for the next pass, which is due at once
+    // if the timer has already expired.
+    if(timer->started_pass == controller->pass) {
+      if(ticks_until_expiration <= 0) {
+        min_ticks_to_next = 0;
+      }
+      else if((timesource_ticks_t)ticks_until_expiration < min_ticks_to_next) {
+        min_ticks_to_next = (timesource_ticks_t)ticks_until_expiration;
+      }
+    }
+    else if(ticks_until_expiration <= 0) {
       if(timer->repeating) {
         timer->next_expiration_ticks += timer->interval_ticks;
         timer->callback(timer->context);
 
+        // A timer stopped by its own callback no longer bounds the sleep time.
+        if(!dlist_contains(&controller->timers, current)) {
+          continue;
+        }
+
         int32_t new_ticks_until = (int32_t)(timer->next_expiration_ticks - controller->current_ticks);
         if(new_ticks_until > 0 && (timesource_ticks_t)new_ticks_until < min_ticks_to_next) {
           min_ticks_to_next = (timesource_ticks_t)new_ticks_until;
         }
       }
       else {
-        list_delete(&controller->timers, current);
+        dlist_remove(&controller->timers, current);
         timer->callback(timer->context);
       }
     }
@@ -39,22 +69,46 @@ timesource_ticks_t timer_controller_run(s_timer_controller_t* controller)
         min_ticks_to_next = (timesource_ticks_t)ticks_until_expiration;
       }
     }
-
-    current = next;
   }
 
+  controller->running = false;
+
   return min_ticks_to_next;
 }
 
+void timer_init(s_timer_t* timer)
+{
+  dlist_node_init(&timer->node);
+  timer->controller = NULL;
+}
+
+static void detach(s_timer_controller_t* controller, s_timer_t* timer)
+{
+  if(controller->cursor == &timer->node) {
+    controller->cursor = timer->node.next;
+  }
+  dlist_remove(&controller->timers, &timer->node);
+}
+
 static void timer_start(s_timer_t* timer, s_timer_controller_t* controller, timesource_ticks_t interval_ticks, timer_callback_t callback, void* context, bool repeating)
 {
+  // Re-arming a running timer moves it to the back of its current controller's list.
+  if(timer->controller != NULL && dlist_contains(&timer->controller->timers, &timer->node)) {
+    detach(timer->controller, timer);
+  }
+
   timer->controller = controller;
   timer->callback = callback;
   timer->context = context;
   timer->interval_ticks = interval_ticks;
   timer->next_expiration_ticks = controller->current_ticks + interval_ticks;
   timer->repeating = repeating;
-  list_push(&controller->timers, &timer->node);
+  timer->started_pass = controller->pass;
+  dlist_push_back(&controller->timers, &timer->node);
+
+  if(controller->running && controller->cursor == NULL) {
+    controller->cursor = &timer->node;
+  }
 }
 
 void timer_start_one_shot(s_timer_t* timer, s_timer_controller_t* controller, timesource_ticks_t interval_ticks, timer_callback_t callback, void* context)
@@ -69,16 +123,24 @@ void timer_start_repeating(s_timer_t* timer, s_timer_controller_t* controller, t
 
 void timer_stop(s_timer_t* timer)
 {
-  list_delete(&timer->controller->timers, &timer->node);
+  if(timer->controller != NULL) {
+    detach(timer->controller, timer);
+  }
 }
 
 bool timer_is_active(s_timer_controller_t* controller, s_timer_t* timer)
 {
-  list_for_each(&controller->timers, node)
-  {
-    if(node == &timer->node) {
-      return true;
-    }
-  }
-  return false;
+  return dlist_contains(&controller->timers, &timer->node);
+}
+
+void timer_controller_add_pass_hook(s_timer_controller_t* controller, timer_pass_hook_t* hook, timer_pass_callback_t callback, void* context)
+{
+  hook->callback = callback;
+  hook->context = context;
+  dlist_push_back(&controller->pass_hooks, &hook->node);
+}
+
+void timer_controller_remove_pass_hook(s_timer_controller_t* controller, timer_pass_hook_t* hook)
+{
+  dlist_remove(&controller->pass_hooks, &hook->node);
 }
@@ -1,33 +1,93 @@
 #pragma once
 
 #include "i_timesource.h"
-#include "list.h"
+#include "dlist.h"
 
 #include <stdbool.h>
 
 typedef void (*timer_callback_t)(void* context);
 
+typedef void (*timer_pass_callback_t)(void* context);
+
+typedef struct
+{
+  dlist_node_t node;
+  timer_pass_callback_t callback;
+  void* context;
+} timer_pass_hook_t;
+
+/**
+ * cursor is the next timer a timer_controller_run() pass will visit. Stopping or re-arming
+ * that timer from a callback steps the cursor past it first, so the pass carries on with
+ * the remaining timers. pass counts passes; a timer started during one is stamped with it
+ * and first fires on the next pass, so a timer that re-arms itself runs once per pass. The
+ * pass still visits it to bound the returned sleep time.
+ */
 typedef struct
 {
   i_timesource_t* timesource;
   timesource_ticks_t current_ticks;
-  list_t timers;
+  dlist_t timers;
+  dlist_node_t* cursor;
+  uint32_t pass;
+  bool running;
+  dlist_t pass_hooks;
 } s_timer_controller_t;
 
 typedef struct
 {
-  list_node_t node;
+  dlist_node_t node;
   s_timer_controller_t* controller;
   timer_callback_t callback;
   void* context;
   timesource_ticks_t interval_ticks;
   timesource_ticks_t next_expiration_ticks;
+  uint32_t started_pass;
   bool repeating;
 } s_timer_t;
 
 void timer_controller_init(s_timer_controller_t* controller, i_timesource_t* timesource);
 timesource_ticks_t timer_controller_run(s_timer_controller_t* controller);
+/**
+ * @brief Put a timer in the stopped state. Needed before the first start unless the timer
+ * has static storage or is otherwise zero-initialized.
+ */
+void timer_init(s_timer_t* timer);
+
+/**
+ * @brief Start a timer, or re-arm it if it is already running. Safe to call from a timer
+ * callback.
+ */
 void timer_start_one_shot(s_timer_t* timer, s_timer_controller_t* controller, timesource_ticks_t interval_ticks, timer_callback_t callback, void* context);
+/**
+ * @brief See timer_start_one_shot().
+ */
 void timer_start_repeating(s_timer_t* timer, s_timer_controller_t* controller, timesource_ticks_t interval_ticks, timer_callback_t callback, void* context);
+
+/**
+ * @brief Stop a timer. Safe to call from any timer callback, including for a timer that
+ * has not run yet in the current pass.
+ */
 void timer_stop(s_timer_t* timer);
+
+/**
+ * @brief O(1). The timer must have been initialized; see timer_init().
+ */
 bool timer_is_active(s_timer_controller_t* controller, s_timer_t* timer);
+
+/**
+ * @brief Run callback at the start of every timer_controller_run() pass, before any timer
+ * is visited. Hooks run in the order they were added. See timer_pass_hooks.h for the
+ * usual ones: reset a scratch arena, publish pending ISR events, drain an event queue.
+ *
+ * @param controller
+ * @param hook Storage for the registration; must stay valid until removed.
+ * @param callback
+ * @param context
+ */
+void timer_controller_add_pass_hook(s_timer_controller_t* controller, timer_pass_hook_t* hook, timer_pass_callback_t callback, void* context);
+
+/**
+ * @brief Stop running a hook. Does nothing if it was not added to this controller.
+ */
+void timer_controller_remove_pass_hook(s_timer_controller_t* controller, timer_pass_hook_t* hook);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "arena.h"
+#include "event_queue.h"
+#include "isr_event.h"
+#include "timer.h"
+
+/**
+ * Pass hooks for timer_controller_add_pass_hook(). Add them in this order so that memory
+ * allocated by a previous pass is released before ISR events are published, and ISR events
+ * are published before the deferred queue they may feed is drained:
+ *
+ * timer_controller_add_pass_hook(&controller, &scratch_hook, timer_pass_reset_arena, &scratch);
+ * timer_controller_add_pass_hook(&controller, &isr_hook, timer_pass_drain_isr_events, &isr_events);
+ * timer_controller_add_pass_hook(&controller, &queue_hook, timer_pass_drain_event_queue, &queue);
+ */
+
+/**
+ * @brief Reset an arena_t; memory allocated from it is valid until the next pass.
+ */
+static inline void timer_pass_reset_arena(void* context)
+{
+  arena_reset((arena_t*)context);
+}
+
+/**
+ * @brief Publish the pending events of an isr_event_set_t.
+ */
+static inline void timer_pass_drain_isr_events(void* context)
+{
+  isr_event_set_drain((isr_event_set_t*)context);
+}
+
+/**
+ * @brief Publish everything queued in an event_queue_t.
+ */
+static inline void timer_pass_drain_event_queue(void* context)
+{
+  event_queue_drain((event_queue_t*)context);
+}
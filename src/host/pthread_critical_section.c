@@ -0,0 +1,36 @@
+#include "pthread_critical_section.h"
+
+#include <stddef.h>
+
+static void enter(i_critical_section_t* interface)
+{
+  pthread_critical_section_t* instance = (pthread_critical_section_t*)interface;
+  pthread_mutex_lock(&instance->mutex);
+}
+
+static bool try_enter(i_critical_section_t* interface)
+{
+  pthread_critical_section_t* instance = (pthread_critical_section_t*)interface;
+  return pthread_mutex_trylock(&instance->mutex) == 0;
+}
+
+static void exit_section(i_critical_section_t* interface)
+{
+  pthread_critical_section_t* instance = (pthread_critical_section_t*)interface;
+  pthread_mutex_unlock(&instance->mutex);
+}
+
+bool pthread_critical_section_init(pthread_critical_section_t* instance)
+{
+  instance->interface = (i_critical_section_t){
+    .enter = enter,
+    .try_enter = try_enter,
+    .exit = exit_section,
+  };
+  return pthread_mutex_init(&instance->mutex, NULL) == 0;
+}
+
+void pthread_critical_section_deinit(pthread_critical_section_t* instance)
+{
+  pthread_mutex_destroy(&instance->mutex);
+}
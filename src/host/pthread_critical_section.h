@@ -0,0 +1,22 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "i_critical_section.h"
+
+/**
+ * Host-only i_critical_section_t backed by a pthread mutex; waiters sleep instead of spinning.
+ * Built with the SIERA_HOST_PTHREAD CMake option.
+ */
+typedef struct {
+  i_critical_section_t interface;
+  pthread_mutex_t mutex;
+} pthread_critical_section_t;
+
+/**
+ * @return false if the mutex could not be created.
+ */
+bool pthread_critical_section_init(pthread_critical_section_t* instance);
+
+void pthread_critical_section_deinit(pthread_critical_section_t* instance);
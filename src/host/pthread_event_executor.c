@@ -0,0 +1,151 @@
+#include "pthread_event_executor.h"
+
+#include <stddef.h>
+
+static void* payload_of(pthread_event_executor_task_t* task)
+{
+  return task + 1;
+}
+
+static void run_inline(pthread_event_executor_t* executor, event_subscription_callback_t callback, void* context, const void* data)
+{
+  pthread_mutex_lock(&executor->lock);
+  executor->inline_runs++;
+  pthread_mutex_unlock(&executor->lock);
+
+  callback(context, data);
+}
+
+static void submit(
+  i_event_executor_t* interface,
+  const event_async_t* async,
+  event_subscription_callback_t callback,
+  void* context,
+  const void* data)
+{
+  pthread_event_executor_t* executor = (pthread_event_executor_t*)interface;
+
+  if(async->payload_size > executor->max_payload) {
+    run_inline(executor, callback, context, data);
+    return;
+  }
+
+  pthread_mutex_lock(&executor->lock);
+  pthread_event_executor_task_t* task = (pthread_event_executor_task_t*)pool_alloc(&executor->tasks);
+  pthread_mutex_unlock(&executor->lock);
+
+  if(task == NULL) {
+    run_inline(executor, callback, context, data);
+    return;
+  }
+
+  // The block is ours until it is queued, so the copy happens outside the lock.
+  dlist_node_init(&task->node);
+  task->callback = callback;
+  task->context = context;
+  event_async_copy(async, payload_of(task), data);
+
+  pthread_mutex_lock(&executor->lock);
+  dlist_push_back(&executor->queue, &task->node);
+  executor->pending++;
+  pthread_cond_signal(&executor->work);
+  pthread_mutex_unlock(&executor->lock);
+}
+
+static void* worker(void* arg)
+{
+  pthread_event_executor_t* executor = (pthread_event_executor_t*)arg;
+
+  pthread_mutex_lock(&executor->lock);
+
+  while(true) {
+    while(dlist_is_empty(&executor->queue) && !executor->stopping) {
+      pthread_cond_wait(&executor->work, &executor->lock);
+    }
+
+    pthread_event_executor_task_t* task = (pthread_event_executor_task_t*)dlist_pop_front(&executor->queue);
+    if(task == NULL) {
+      break;
+    }
+
+    pthread_mutex_unlock(&executor->lock);
+    task->callback(task->context, payload_of(task));
+    pthread_mutex_lock(&executor->lock);
+
+    pool_free(&executor->tasks, task);
+    if(--executor->pending == 0) {
+      pthread_cond_broadcast(&executor->idle);
+    }
+  }
+
+  pthread_mutex_unlock(&executor->lock);
+  return NULL;
+}
+
+bool pthread_event_executor_init(
+  pthread_event_executor_t* executor,
+  pthread_t* threads,
+  uint16_t thread_count,
+  void* task_buffer,
+  uint16_t task_count,
+  uint16_t max_payload)
+{
+  executor->interface.submit = submit;
+  pthread_mutex_init(&executor->lock, NULL);
+  pthread_cond_init(&executor->work, NULL);
+  pthread_cond_init(&executor->idle, NULL);
+  dlist_init(&executor->queue);
+  pool_init(&executor->tasks, task_buffer, sizeof(pthread_event_executor_task_t) + max_payload, task_count);
+  executor->threads = threads;
+  executor->thread_count = 0;
+  executor->max_payload = max_payload;
+  executor->pending = 0;
+  executor->inline_runs = 0;
+  executor->stopping = false;
+
+  for(uint16_t i = 0; i < thread_count; i++) {
+    if(pthread_create(&threads[i], NULL, worker, executor) != 0) {
+      pthread_event_executor_deinit(executor);
+      return false;
+    }
+    executor->thread_count++;
+  }
+
+  return true;
+}
+
+void pthread_event_executor_join(pthread_event_executor_t* executor)
+{
+  pthread_mutex_lock(&executor->lock);
+  while(executor->pending != 0) {
+    pthread_cond_wait(&executor->idle, &executor->lock);
+  }
+  pthread_mutex_unlock(&executor->lock);
+}
+
+void pthread_event_executor_deinit(pthread_event_executor_t* executor)
+{
+  pthread_event_executor_join(executor);
+
+  pthread_mutex_lock(&executor->lock);
+  executor->stopping = true;
+  pthread_cond_broadcast(&executor->work);
+  pthread_mutex_unlock(&executor->lock);
+
+  for(uint16_t i = 0; i < executor->thread_count; i++) {
+    pthread_join(executor->threads[i], NULL);
+  }
+  executor->thread_count = 0;
+
+  pthread_cond_destroy(&executor->idle);
+  pthread_cond_destroy(&executor->work);
+  pthread_mutex_destroy(&executor->lock);
+}
+
+uint32_t pthread_event_executor_inline_runs(pthread_event_executor_t* executor)
+{
+  pthread_mutex_lock(&executor->lock);
+  uint32_t runs = executor->inline_runs;
+  pthread_mutex_unlock(&executor->lock);
+  return runs;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dlist.h"
+#include "i_event_executor.h"
+#include "pool.h"
+
+/**
+ * Queued subscriber call. The copied payload follows the struct in the same pool block.
+ */
+typedef struct {
+  dlist_node_t node;
+  event_subscription_callback_t callback;
+  void* context;
+} pthread_event_executor_task_t;
+
+/**
+ * Declares backing storage for count in-flight tasks with payloads of up to max_payload
+ * bytes.
+ */
+#define PTHREAD_EVENT_EXECUTOR_TASKS(name, count, max_payload) \
+  POOL_BUFFER(name, sizeof(pthread_event_executor_task_t) + (max_payload), count)
+
+/**
+ * Host-only i_event_executor_t that runs async-safe subscribers on a fixed pool of
+ * worker threads. When the task pool is exhausted, or a payload is larger than
+ * max_payload, the subscriber runs inline on the publisher's thread instead.
+ */
+typedef struct {
+  i_event_executor_t interface;
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t idle;
+  dlist_t queue;
+  pool_t tasks;
+  pthread_t* threads;
+  uint16_t thread_count;
+  uint16_t max_payload;
+  uint32_t pending;
+  uint32_t inline_runs;
+  bool stopping;
+} pthread_event_executor_t;
+
+/**
+ * @brief Initialize the executor and start its worker threads.
+ *
+ * @param executor
+ * @param threads Storage for thread_count thread handles.
+ * @param thread_count
+ * @param task_buffer See PTHREAD_EVENT_EXECUTOR_TASKS.
+ * @param task_count
+ * @param max_payload
+ * @return false if a worker thread could not be started.
+ */
+bool pthread_event_executor_init(
+  pthread_event_executor_t* executor,
+  pthread_t* threads,
+  uint16_t thread_count,
+  void* task_buffer,
+  uint16_t task_count,
+  uint16_t max_payload);
+
+/**
+ * @brief Barrier: block until every task submitted so far has finished.
+ */
+void pthread_event_executor_join(pthread_event_executor_t* executor);
+
+/**
+ * @brief Finish outstanding tasks, then stop and join the worker threads.
+ */
+void pthread_event_executor_deinit(pthread_event_executor_t* executor);
+
+/**
+ * @brief Number of subscriber calls that fell back to running on the publisher's thread.
+ */
+uint32_t pthread_event_executor_inline_runs(pthread_event_executor_t* executor);
@@ -0,0 +1,107 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "arena.h"
+}
+
+enum {
+  ARENA_SIZE = 64,
+};
+
+TEST_GROUP(ArenaTests)
+{
+  arena_t arena;
+  uint64_t buffer[ARENA_SIZE / sizeof(uint64_t)];
+
+  void setup()
+  {
+    arena_init(&arena, buffer, sizeof(buffer));
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(ArenaTests, InitializesEmpty)
+{
+  LONGS_EQUAL(0, arena_used(&arena));
+  LONGS_EQUAL(ARENA_SIZE, arena_remaining(&arena));
+  LONGS_EQUAL(0, arena_peak(&arena));
+}
+
+TEST(ArenaTests, AllocationsAreContiguousAndDefaultAligned)
+{
+  uint8_t* a = (uint8_t*)arena_alloc(&arena, 3);
+  uint8_t* b = (uint8_t*)arena_alloc(&arena, 8);
+
+  POINTERS_EQUAL(buffer, a);
+  POINTERS_EQUAL((uint8_t*)buffer + ARENA_DEFAULT_ALIGNMENT, b);
+  LONGS_EQUAL(ARENA_DEFAULT_ALIGNMENT + 8, arena_used(&arena));
+}
+
+TEST(ArenaTests, AlignedAllocationPadsToRequestedAlignment)
+{
+  arena_alloc_aligned(&arena, 1, 1);
+  uint8_t* aligned = (uint8_t*)arena_alloc_aligned(&arena, 4, 4);
+
+  POINTERS_EQUAL((uint8_t*)buffer + 4, aligned);
+  LONGS_EQUAL(8, arena_used(&arena));
+}
+
+TEST(ArenaTests, AlignmentIsRelativeToAbsoluteAddress)
+{
+  arena_init(&arena, (uint8_t*)buffer + 1, sizeof(buffer) - 1);
+
+  void* aligned = arena_alloc_aligned(&arena, 4, 8);
+
+  POINTERS_EQUAL((uint8_t*)buffer + 8, aligned);
+}
+
+TEST(ArenaTests, AllocFailsWhenFullAndCountsFailure)
+{
+  CHECK(arena_alloc(&arena, ARENA_SIZE) != NULL);
+  CHECK(arena_alloc_aligned(&arena, 1, 1) == NULL);
+  LONGS_EQUAL(1, arena_failed_allocations(&arena));
+}
+
+TEST(ArenaTests, AllocFailsWhenPaddingDoesNotFit)
+{
+  arena_alloc_aligned(&arena, ARENA_SIZE - 2, 1);
+
+  CHECK(arena_alloc_aligned(&arena, 1, 8) == NULL);
+  LONGS_EQUAL(ARENA_SIZE - 2, arena_used(&arena));
+}
+
+TEST(ArenaTests, RewindDiscardsAllocationsAfterMark)
+{
+  arena_alloc(&arena, 8);
+  arena_mark_t mark = arena_mark(&arena);
+  void* temporary = arena_alloc(&arena, 16);
+
+  arena_rewind(&arena, mark);
+
+  LONGS_EQUAL(8, arena_used(&arena));
+  POINTERS_EQUAL(temporary, arena_alloc(&arena, 16));
+}
+
+TEST(ArenaTests, RewindToStaleMarkDoesNothing)
+{
+  arena_alloc(&arena, 16);
+  arena_mark_t mark = arena_mark(&arena);
+  arena_reset(&arena);
+
+  arena_rewind(&arena, mark);
+
+  LONGS_EQUAL(0, arena_used(&arena));
+}
+
+TEST(ArenaTests, ResetKeepsPeakUsage)
+{
+  arena_alloc(&arena, 40);
+  arena_reset(&arena);
+  arena_alloc(&arena, 8);
+
+  LONGS_EQUAL(8, arena_used(&arena));
+  LONGS_EQUAL(40, arena_peak(&arena));
+}
@@ -0,0 +1,127 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "bitset.h"
+#include "ram_datastream_utils.h"
+}
+
+#define BITSET_TEST_ENTRIES(ENTRY) \
+  ENTRY(KEY_A, uint8_t)            \
+  ENTRY(KEY_B, uint16_t)           \
+  ENTRY(KEY_C, uint32_t)
+
+enum {
+  BIT_COUNT = 70,
+};
+
+TEST_GROUP(BitsetTests)
+{
+  bitset_t bitset;
+  BITSET_STORAGE(words, BIT_COUNT);
+
+  void setup()
+  {
+    bitset_init(&bitset, words, BIT_COUNT);
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(BitsetTests, StorageIsSizedFromDatabaseKeyCount)
+{
+  BITSET_STORAGE(key_words, DATABASE_KEY_COUNT(BITSET_TEST_ENTRIES));
+
+  LONGS_EQUAL(3, DATABASE_KEY_COUNT(BITSET_TEST_ENTRIES));
+  LONGS_EQUAL(1, sizeof(key_words) / sizeof(key_words[0]));
+  LONGS_EQUAL(3, BITSET_WORDS(BIT_COUNT));
+}
+
+TEST(BitsetTests, InitializesEmpty)
+{
+  CHECK_TRUE(bitset_is_empty(&bitset));
+  LONGS_EQUAL(0, bitset_count(&bitset));
+  LONGS_EQUAL(BITSET_NONE, bitset_next(&bitset, 0));
+}
+
+TEST(BitsetTests, SetTestAndClearAcrossWords)
+{
+  bitset_set(&bitset, 0);
+  bitset_set(&bitset, 33);
+  bitset_set(&bitset, 69);
+
+  CHECK_TRUE(bitset_test(&bitset, 0));
+  CHECK_TRUE(bitset_test(&bitset, 33));
+  CHECK_TRUE(bitset_test(&bitset, 69));
+  CHECK_FALSE(bitset_test(&bitset, 32));
+
+  bitset_clear(&bitset, 33);
+  CHECK_FALSE(bitset_test(&bitset, 33));
+  LONGS_EQUAL(2, bitset_count(&bitset));
+}
+
+TEST(BitsetTests, SetAllOnlySetsBitsInRange)
+{
+  bitset_set_all(&bitset);
+
+  LONGS_EQUAL(BIT_COUNT, bitset_count(&bitset));
+  LONGS_EQUAL(BITSET_NONE, bitset_next(&bitset, BIT_COUNT));
+
+  bitset_clear_all(&bitset);
+  CHECK_TRUE(bitset_is_empty(&bitset));
+}
+
+TEST(BitsetTests, NextSkipsEmptyWords)
+{
+  bitset_set(&bitset, 3);
+  bitset_set(&bitset, 64);
+
+  LONGS_EQUAL(3, bitset_next(&bitset, 0));
+  LONGS_EQUAL(3, bitset_next(&bitset, 3));
+  LONGS_EQUAL(64, bitset_next(&bitset, 4));
+  LONGS_EQUAL(BITSET_NONE, bitset_next(&bitset, 65));
+}
+
+TEST(BitsetTests, ForEachVisitsSetBitsInOrder)
+{
+  const uint16_t expected[] = { 1, 31, 32, 40, 69 };
+  for(uint16_t bit : expected) {
+    bitset_set(&bitset, bit);
+  }
+
+  int i = 0;
+  bitset_for_each(&bitset, index)
+  {
+    LONGS_EQUAL(expected[i], index);
+    i++;
+  }
+  LONGS_EQUAL(5, i);
+}
+
+TEST(BitsetTests, AndOrAndNotOperateWordWide)
+{
+  bitset_t other;
+  BITSET_STORAGE(other_words, BIT_COUNT);
+  bitset_init(&other, other_words, BIT_COUNT);
+
+  bitset_set(&bitset, 1);
+  bitset_set(&bitset, 40);
+  bitset_set(&other, 40);
+  bitset_set(&other, 65);
+
+  CHECK_TRUE(bitset_intersects(&bitset, &other));
+
+  bitset_or(&bitset, &other);
+  LONGS_EQUAL(3, bitset_count(&bitset));
+
+  bitset_and_not(&bitset, &other);
+  LONGS_EQUAL(1, bitset_count(&bitset));
+  CHECK_TRUE(bitset_test(&bitset, 1));
+  CHECK_FALSE(bitset_intersects(&bitset, &other));
+
+  bitset_set(&bitset, 65);
+  bitset_and(&bitset, &other);
+  LONGS_EQUAL(1, bitset_count(&bitset));
+  CHECK_TRUE(bitset_test(&bitset, 65));
+}
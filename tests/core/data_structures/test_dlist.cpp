@@ -0,0 +1,307 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "dlist.h"
+}
+
+TEST_GROUP(DListTests)
+{
+  dlist_t list;
+
+  void setup()
+  {
+    dlist_init(&list);
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(DListTests, InitializesEmpty)
+{
+  CHECK(list.head == NULL);
+  CHECK(list.tail == NULL);
+  CHECK_TRUE(dlist_is_empty(&list));
+}
+
+TEST(DListTests, PushBackToEmptyList)
+{
+  dlist_node_t node;
+
+  dlist_push_back(&list, &node);
+
+  CHECK(list.head == &node);
+  CHECK(list.tail == &node);
+  CHECK(node.next == NULL);
+  CHECK(node.prev == NULL);
+}
+
+TEST(DListTests, PushBackPreservesOrder)
+{
+  dlist_node_t node1, node2, node3;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+  dlist_push_back(&list, &node3);
+
+  CHECK(list.head == &node1);
+  CHECK(list.tail == &node3);
+  CHECK(node1.next == &node2);
+  CHECK(node2.next == &node3);
+  CHECK(node3.next == NULL);
+  CHECK(node3.prev == &node2);
+  CHECK(node2.prev == &node1);
+  CHECK(node1.prev == NULL);
+}
+
+TEST(DListTests, PushFrontMultipleElements)
+{
+  dlist_node_t node1, node2, node3;
+
+  dlist_push_front(&list, &node1);
+  dlist_push_front(&list, &node2);
+  dlist_push_front(&list, &node3);
+
+  CHECK(list.head == &node3);
+  CHECK(list.tail == &node1);
+  CHECK(node3.next == &node2);
+  CHECK(node2.next == &node1);
+  CHECK(node1.prev == &node2);
+}
+
+TEST(DListTests, RemoveHead)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+
+  dlist_remove(&list, &node1);
+
+  CHECK(list.head == &node2);
+  CHECK(list.tail == &node2);
+  CHECK(node2.prev == NULL);
+}
+
+TEST(DListTests, RemoveMiddle)
+{
+  dlist_node_t node1, node2, node3;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+  dlist_push_back(&list, &node3);
+
+  dlist_remove(&list, &node2);
+
+  CHECK(node1.next == &node3);
+  CHECK(node3.prev == &node1);
+  CHECK(list.head == &node1);
+  CHECK(list.tail == &node3);
+}
+
+TEST(DListTests, RemoveTailUpdatesTail)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+
+  dlist_remove(&list, &node2);
+
+  CHECK(list.tail == &node1);
+  CHECK(node1.next == NULL);
+
+  dlist_node_t node3;
+  dlist_push_back(&list, &node3);
+  CHECK(node1.next == &node3);
+}
+
+TEST(DListTests, RemoveOnlyElement)
+{
+  dlist_node_t node;
+
+  dlist_push_back(&list, &node);
+  dlist_remove(&list, &node);
+
+  CHECK_TRUE(dlist_is_empty(&list));
+  CHECK(list.tail == NULL);
+}
+
+TEST(DListTests, RemoveUnlinksNode)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+  dlist_remove(&list, &node1);
+
+  CHECK(node1.next == NULL);
+  CHECK(node1.prev == NULL);
+}
+
+TEST(DListTests, RemoveTwiceDoesNothing)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+  dlist_remove(&list, &node1);
+  dlist_remove(&list, &node1);
+
+  CHECK(list.head == &node2);
+  CHECK(list.tail == &node2);
+}
+
+TEST(DListTests, RemoveUnlinkedNodeDoesNothing)
+{
+  dlist_node_t node1, node2;
+  dlist_node_init(&node2);
+
+  dlist_push_back(&list, &node1);
+  dlist_remove(&list, &node2);
+
+  CHECK(list.head == &node1);
+  CHECK(list.tail == &node1);
+}
+
+TEST(DListTests, RemoveHeadOfOtherListDoesNothing)
+{
+  dlist_t other;
+  dlist_node_t node1, node2;
+  dlist_init(&other);
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&other, &node2);
+  dlist_remove(&list, &node2);
+
+  CHECK(list.head == &node1);
+  CHECK(other.head == &node2);
+}
+
+TEST(DListTests, RemoveFromEmptyListDoesNothing)
+{
+  dlist_node_t node;
+  dlist_node_init(&node);
+
+  dlist_remove(&list, &node);
+
+  CHECK_TRUE(dlist_is_empty(&list));
+}
+
+TEST(DListTests, ContainsOnlyLinkedNodes)
+{
+  dlist_t other;
+  dlist_node_t node1, node2, node3;
+  dlist_init(&other);
+  dlist_node_init(&node3);
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&other, &node2);
+
+  CHECK_TRUE(dlist_contains(&list, &node1));
+  CHECK_FALSE(dlist_contains(&list, &node2));
+  CHECK_FALSE(dlist_contains(&list, &node3));
+
+  dlist_remove(&list, &node1);
+
+  CHECK_FALSE(dlist_contains(&list, &node1));
+}
+
+TEST(DListTests, MiddleNodeOfAnotherListIsNeitherContainedNorRemoved)
+{
+  dlist_t other;
+  dlist_node_t mine, first, middle, last;
+  dlist_init(&other);
+
+  dlist_push_back(&list, &mine);
+  dlist_push_back(&other, &first);
+  dlist_push_back(&other, &middle);
+  dlist_push_back(&other, &last);
+
+  CHECK_FALSE(dlist_contains(&list, &middle));
+  dlist_remove(&list, &middle);
+
+  CHECK_TRUE(dlist_contains(&other, &middle));
+  POINTERS_EQUAL(&middle, first.next);
+  POINTERS_EQUAL(&middle, last.prev);
+  POINTERS_EQUAL(&mine, list.head);
+  POINTERS_EQUAL(&mine, list.tail);
+}
+
+TEST(DListTests, InsertAfterMiddleAndTail)
+{
+  dlist_node_t node1, node2, node3, node4;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node3);
+  dlist_insert_after(&list, &node1, &node2);
+  dlist_insert_after(&list, &node3, &node4);
+
+  CHECK(list.head == &node1);
+  CHECK(node1.next == &node2);
+  CHECK(node2.prev == &node1);
+  CHECK(node2.next == &node3);
+  CHECK(node3.prev == &node2);
+  CHECK(node3.next == &node4);
+  CHECK(list.tail == &node4);
+}
+
+TEST(DListTests, InsertAfterNullPushesFront)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_insert_after(&list, NULL, &node2);
+
+  CHECK(list.head == &node2);
+  CHECK(node2.next == &node1);
+  CHECK(node1.prev == &node2);
+}
+
+TEST(DListTests, PopFrontReturnsHeadInOrder)
+{
+  dlist_node_t node1, node2;
+
+  dlist_push_back(&list, &node1);
+  dlist_push_back(&list, &node2);
+
+  CHECK(dlist_pop_front(&list) == &node1);
+  CHECK(dlist_pop_front(&list) == &node2);
+  CHECK(dlist_pop_front(&list) == NULL);
+  CHECK(list.tail == NULL);
+}
+
+TEST(DListTests, ForEachVisitsAllNodesInOrder)
+{
+  dlist_node_t nodes[4];
+  for(auto& node : nodes) {
+    dlist_push_back(&list, &node);
+  }
+
+  int i = 0;
+  dlist_for_each(&list, node)
+  {
+    CHECK(node == &nodes[i]);
+    i++;
+  }
+  LONGS_EQUAL(4, i);
+}
+
+TEST(DListTests, ForEachSafeAllowsRemovingCurrent)
+{
+  dlist_node_t nodes[4];
+  for(auto& node : nodes) {
+    dlist_push_back(&list, &node);
+  }
+
+  int visited = 0;
+  dlist_for_each_safe(&list, node, next)
+  {
+    dlist_remove(&list, node);
+    visited++;
+  }
+
+  LONGS_EQUAL(4, visited);
+  CHECK_TRUE(dlist_is_empty(&list));
+}
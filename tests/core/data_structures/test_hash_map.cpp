@@ -0,0 +1,122 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "hash_map.h"
+}
+
+enum {
+  CAPACITY = 16,
+};
+
+TEST_GROUP(HashMapTests)
+{
+  hash_map_t map;
+  HASH_MAP_STORAGE(slots, CAPACITY);
+  int values[CAPACITY * 2];
+
+  void setup()
+  {
+    CHECK_TRUE(hash_map_init(&map, slots, CAPACITY));
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(HashMapTests, RejectsNonPowerOfTwoCapacity)
+{
+  hash_map_t other;
+  CHECK_FALSE(hash_map_init(&other, slots, 12));
+  CHECK_FALSE(hash_map_init(&other, slots, 0));
+}
+
+TEST(HashMapTests, InitializesEmpty)
+{
+  LONGS_EQUAL(0, hash_map_count(&map));
+  LONGS_EQUAL(CAPACITY, hash_map_capacity(&map));
+  CHECK_FALSE(hash_map_contains(&map, 0));
+}
+
+TEST(HashMapTests, GetReturnsStoredValue)
+{
+  void* value = NULL;
+
+  CHECK_TRUE(hash_map_put(&map, 0x8001, &values[0]));
+  CHECK_TRUE(hash_map_put(&map, 0x0042, &values[1]));
+
+  CHECK_TRUE(hash_map_get(&map, 0x8001, &value));
+  POINTERS_EQUAL(&values[0], value);
+  CHECK_TRUE(hash_map_get(&map, 0x0042, &value));
+  POINTERS_EQUAL(&values[1], value);
+  CHECK_FALSE(hash_map_get(&map, 0x1234, &value));
+  LONGS_EQUAL(2, hash_map_count(&map));
+}
+
+TEST(HashMapTests, PutReplacesExistingValue)
+{
+  void* value = NULL;
+
+  hash_map_put(&map, 7, &values[0]);
+  hash_map_put(&map, 7, &values[1]);
+
+  LONGS_EQUAL(1, hash_map_count(&map));
+  CHECK_TRUE(hash_map_get(&map, 7, &value));
+  POINTERS_EQUAL(&values[1], value);
+}
+
+TEST(HashMapTests, StoresIndicesThroughUintptr)
+{
+  void* value = NULL;
+
+  hash_map_put(&map, 0xFFFF, (void*)(uintptr_t)0);
+  CHECK_TRUE(hash_map_get(&map, 0xFFFF, &value));
+  LONGS_EQUAL(0, (uintptr_t)value);
+}
+
+TEST(HashMapTests, FillsToCapacityThenRejectsNewKeys)
+{
+  for(uint16_t i = 0; i < CAPACITY; i++) {
+    CHECK_TRUE(hash_map_put(&map, (uint16_t)(i * 1000u), &values[i]));
+  }
+
+  CHECK_FALSE(hash_map_put(&map, 1, &values[0]));
+  CHECK_TRUE(hash_map_put(&map, 0, &values[1]));
+
+  for(uint16_t i = 0; i < CAPACITY; i++) {
+    CHECK_TRUE(hash_map_contains(&map, (uint16_t)(i * 1000u)));
+  }
+  CHECK_FALSE(hash_map_contains(&map, 1));
+}
+
+TEST(HashMapTests, RemoveKeepsCollidingKeysReachable)
+{
+  // Strided keys exercise long probe chains; remove every other one and verify the rest.
+  for(uint16_t i = 0; i < CAPACITY - 2; i++) {
+    hash_map_put(&map, (uint16_t)(i << 8), &values[i]);
+  }
+
+  for(uint16_t i = 0; i < CAPACITY - 2; i += 2) {
+    CHECK_TRUE(hash_map_remove(&map, (uint16_t)(i << 8)));
+  }
+  CHECK_FALSE(hash_map_remove(&map, 0));
+
+  for(uint16_t i = 0; i < CAPACITY - 2; i++) {
+    void* value = NULL;
+    bool expected = (i % 2) != 0;
+    CHECK_EQUAL(expected, hash_map_get(&map, (uint16_t)(i << 8), &value));
+    if(expected) {
+      POINTERS_EQUAL(&values[i], value);
+    }
+  }
+  LONGS_EQUAL((CAPACITY - 2) / 2, hash_map_count(&map));
+}
+
+TEST(HashMapTests, ClearEmptiesMap)
+{
+  hash_map_put(&map, 3, &values[0]);
+  hash_map_clear(&map);
+
+  LONGS_EQUAL(0, hash_map_count(&map));
+  CHECK_FALSE(hash_map_contains(&map, 3));
+}
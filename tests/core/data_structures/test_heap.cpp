@@ -0,0 +1,185 @@
+#include "CppUTest/TestHarness.h"
+
+#include <stdlib.h>
+
+extern "C" {
+#include "heap.h"
+#include "utils.h"
+}
+
+typedef struct {
+  int key;
+  heap_node_t node;
+} heap_item_t;
+
+static heap_item_t* item_of(const heap_node_t* node)
+{
+  return (heap_item_t*)((char*)node - OFFSET_OF(heap_item_t, node));
+}
+
+static bool key_less(const heap_node_t* a, const heap_node_t* b)
+{
+  return item_of(a)->key < item_of(b)->key;
+}
+
+enum {
+  CAPACITY = 8,
+};
+
+TEST_GROUP(HeapTests)
+{
+  heap_t heap;
+  heap_node_t* storage[CAPACITY];
+  heap_item_t items[CAPACITY];
+
+  void setup()
+  {
+    heap_init(&heap, storage, CAPACITY, key_less);
+  }
+
+  void teardown()
+  {
+  }
+
+  void insert_keys(const int* keys, int count)
+  {
+    for(int i = 0; i < count; i++) {
+      items[i].key = keys[i];
+      CHECK_TRUE(heap_insert(&heap, &items[i].node));
+    }
+  }
+
+  int pop_key()
+  {
+    heap_node_t* node = heap_pop(&heap);
+    CHECK(node != NULL);
+    return item_of(node)->key;
+  }
+};
+
+TEST(HeapTests, InitializesEmpty)
+{
+  CHECK_TRUE(heap_is_empty(&heap));
+  CHECK(heap_peek(&heap) == NULL);
+  CHECK(heap_pop(&heap) == NULL);
+}
+
+TEST(HeapTests, PeekReturnsMinimum)
+{
+  const int keys[] = { 5, 3, 8, 1, 4 };
+  insert_keys(keys, 5);
+
+  LONGS_EQUAL(1, item_of(heap_peek(&heap))->key);
+  LONGS_EQUAL(5, heap_count(&heap));
+}
+
+TEST(HeapTests, PopReturnsKeysInOrder)
+{
+  const int keys[] = { 7, 2, 9, 4, 1, 8, 3 };
+  insert_keys(keys, 7);
+
+  const int sorted[] = { 1, 2, 3, 4, 7, 8, 9 };
+  for(int expected : sorted) {
+    LONGS_EQUAL(expected, pop_key());
+  }
+  CHECK_TRUE(heap_is_empty(&heap));
+}
+
+TEST(HeapTests, InsertFailsWhenFull)
+{
+  const int keys[CAPACITY] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  insert_keys(keys, CAPACITY);
+
+  heap_item_t extra = { 0, {} };
+  CHECK_FALSE(heap_insert(&heap, &extra.node));
+  LONGS_EQUAL(1, item_of(heap_peek(&heap))->key);
+}
+
+TEST(HeapTests, RemoveArbitraryNodeKeepsOrder)
+{
+  const int keys[] = { 6, 2, 9, 4, 1, 8 };
+  insert_keys(keys, 6);
+
+  heap_remove(&heap, &items[3].node); // key 4
+  heap_remove(&heap, &items[4].node); // key 1 (root)
+
+  CHECK_FALSE(heap_contains(&heap, &items[3].node));
+  const int sorted[] = { 2, 6, 8, 9 };
+  for(int expected : sorted) {
+    LONGS_EQUAL(expected, pop_key());
+  }
+}
+
+TEST(HeapTests, RemoveNodeNotInHeapDoesNothing)
+{
+  const int keys[] = { 3, 1 };
+  insert_keys(keys, 2);
+
+  heap_item_t stranger = { 0, {} };
+  heap_remove(&heap, &stranger.node);
+
+  LONGS_EQUAL(2, heap_count(&heap));
+}
+
+TEST(HeapTests, UpdateAfterDecreaseKeyMovesNodeUp)
+{
+  const int keys[] = { 2, 5, 7, 9 };
+  insert_keys(keys, 4);
+
+  items[3].key = 1;
+  heap_update(&heap, &items[3].node);
+
+  POINTERS_EQUAL(&items[3].node, heap_peek(&heap));
+}
+
+TEST(HeapTests, UpdateAfterIncreaseKeyMovesNodeDown)
+{
+  const int keys[] = { 2, 5, 7, 9 };
+  insert_keys(keys, 4);
+
+  items[0].key = 10;
+  heap_update(&heap, &items[0].node);
+
+  const int sorted[] = { 5, 7, 9, 10 };
+  for(int expected : sorted) {
+    LONGS_EQUAL(expected, pop_key());
+  }
+}
+
+TEST(HeapTests, ContainsTracksMembership)
+{
+  const int keys[] = { 4, 2 };
+  insert_keys(keys, 2);
+
+  CHECK_TRUE(heap_contains(&heap, &items[0].node));
+  heap_pop(&heap);
+  CHECK_FALSE(heap_contains(&heap, &items[1].node));
+  CHECK_TRUE(heap_contains(&heap, &items[0].node));
+}
+
+TEST(HeapTests, RandomOperationsMatchSortedOrder)
+{
+  static heap_node_t* big_storage[256];
+  static heap_item_t big_items[256];
+  heap_init(&heap, big_storage, 256, key_less);
+  srand(1234);
+
+  for(int i = 0; i < 256; i++) {
+    big_items[i].key = rand() % 1000;
+    heap_insert(&heap, &big_items[i].node);
+  }
+  for(int i = 0; i < 256; i += 3) {
+    heap_remove(&heap, &big_items[i].node);
+  }
+  for(int i = 1; i < 256; i += 3) {
+    big_items[i].key = rand() % 1000;
+    heap_update(&heap, &big_items[i].node);
+  }
+
+  int previous = -1;
+  while(!heap_is_empty(&heap)) {
+    int key = pop_key();
+    CHECK(key >= previous);
+    previous = key;
+  }
+}
@@ -0,0 +1,169 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "mpsc_queue.h"
+#include "utils.h"
+}
+
+TEST_GROUP(MpscQueueTests)
+{
+  mpsc_queue_t queue;
+
+  void setup()
+  {
+    mpsc_queue_init(&queue);
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(MpscQueueTests, InitializesEmpty)
+{
+  CHECK_TRUE(mpsc_queue_is_empty(&queue));
+  CHECK(mpsc_queue_pop(&queue) == NULL);
+}
+
+TEST(MpscQueueTests, PushSingleThenPop)
+{
+  mpsc_node_t node;
+
+  mpsc_queue_push(&queue, &node);
+
+  CHECK_FALSE(mpsc_queue_is_empty(&queue));
+  CHECK(mpsc_queue_pop(&queue) == &node);
+  CHECK_TRUE(mpsc_queue_is_empty(&queue));
+  CHECK(mpsc_queue_pop(&queue) == NULL);
+}
+
+TEST(MpscQueueTests, PopIsFIFO)
+{
+  mpsc_node_t node1, node2, node3;
+
+  mpsc_queue_push(&queue, &node1);
+  mpsc_queue_push(&queue, &node2);
+  mpsc_queue_push(&queue, &node3);
+
+  CHECK(mpsc_queue_pop(&queue) == &node1);
+  CHECK(mpsc_queue_pop(&queue) == &node2);
+  CHECK(mpsc_queue_pop(&queue) == &node3);
+  CHECK(mpsc_queue_pop(&queue) == NULL);
+}
+
+TEST(MpscQueueTests, NodeCanBeRequeuedAfterPop)
+{
+  mpsc_node_t node1, node2;
+
+  mpsc_queue_push(&queue, &node1);
+  CHECK(mpsc_queue_pop(&queue) == &node1);
+
+  mpsc_queue_push(&queue, &node2);
+  mpsc_queue_push(&queue, &node1);
+
+  CHECK(mpsc_queue_pop(&queue) == &node2);
+  CHECK(mpsc_queue_pop(&queue) == &node1);
+  CHECK_TRUE(mpsc_queue_is_empty(&queue));
+}
+
+TEST(MpscQueueTests, InterleavedPushAndPop)
+{
+  mpsc_node_t nodes[3];
+
+  mpsc_queue_push(&queue, &nodes[0]);
+  mpsc_queue_push(&queue, &nodes[1]);
+  CHECK(mpsc_queue_pop(&queue) == &nodes[0]);
+  mpsc_queue_push(&queue, &nodes[2]);
+  CHECK(mpsc_queue_pop(&queue) == &nodes[1]);
+  CHECK(mpsc_queue_pop(&queue) == &nodes[2]);
+  CHECK(mpsc_queue_pop(&queue) == NULL);
+}
+
+TEST(MpscQueueTests, EmbeddedNodeRecoversContainer)
+{
+  struct work_item {
+    int payload;
+    mpsc_node_t node;
+  } item;
+  item.payload = 42;
+
+  mpsc_queue_push(&queue, &item.node);
+
+  mpsc_node_t* node = mpsc_queue_pop(&queue);
+  work_item* recovered = (work_item*)((char*)node - OFFSET_OF(work_item, node));
+  LONGS_EQUAL(42, recovered->payload);
+}
+
+// ---------------------------------------------------------------------------
+// Host-thread stress: several producers, one consumer, per-producer ordering
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_PRODUCERS = 4,
+  STRESS_PER_PRODUCER = 20000,
+};
+
+typedef struct {
+  mpsc_node_t node;
+  uint32_t producer;
+  uint32_t sequence;
+} stress_item_t;
+
+typedef struct {
+  mpsc_queue_t* queue;
+  stress_item_t* items;
+  uint32_t id;
+} stress_producer_t;
+
+static stress_item_t stress_items[STRESS_PRODUCERS][STRESS_PER_PRODUCER];
+
+static void* stress_producer(void* arg)
+{
+  stress_producer_t* producer = (stress_producer_t*)arg;
+
+  for(uint32_t i = 0; i < STRESS_PER_PRODUCER; i++) {
+    producer->items[i].producer = producer->id;
+    producer->items[i].sequence = i;
+    mpsc_queue_push(producer->queue, &producer->items[i].node);
+    if(i % 64 == 0) {
+      sched_yield();
+    }
+  }
+
+  return nullptr;
+}
+
+TEST(MpscQueueTests, StressMultipleProducersPreservePerProducerOrder)
+{
+  pthread_t threads[STRESS_PRODUCERS];
+  stress_producer_t producers[STRESS_PRODUCERS];
+  uint32_t next_expected[STRESS_PRODUCERS] = {};
+
+  for(uint32_t p = 0; p < STRESS_PRODUCERS; p++) {
+    producers[p] = { &queue, stress_items[p], p };
+    pthread_create(&threads[p], nullptr, stress_producer, &producers[p]);
+  }
+
+  uint32_t received = 0;
+  bool in_order = true;
+  while(received < STRESS_PRODUCERS * STRESS_PER_PRODUCER) {
+    stress_item_t* item = (stress_item_t*)mpsc_queue_pop(&queue);
+    if(item == NULL) {
+      sched_yield();
+      continue;
+    }
+    in_order &= item->sequence == next_expected[item->producer];
+    next_expected[item->producer] = item->sequence + 1;
+    received++;
+  }
+
+  for(uint32_t p = 0; p < STRESS_PRODUCERS; p++) {
+    pthread_join(threads[p], nullptr);
+  }
+
+  CHECK_TRUE(in_order);
+  CHECK_TRUE(mpsc_queue_is_empty(&queue));
+}
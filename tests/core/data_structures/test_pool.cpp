@@ -0,0 +1,175 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+
+extern "C" {
+#include "double_timesource.h"
+#include "pool.h"
+#include "timer.h"
+}
+
+enum {
+  BLOCK_COUNT = 4,
+};
+
+TEST_GROUP(PoolTests)
+{
+  pool_t pool;
+  POOL_BUFFER(buffer, sizeof(s_timer_t), BLOCK_COUNT);
+
+  void setup()
+  {
+    pool_init(&pool, buffer, sizeof(s_timer_t), BLOCK_COUNT);
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(PoolTests, BlockSizeIsRoundedToAlignment)
+{
+  LONGS_EQUAL(POOL_ALIGNMENT, POOL_BLOCK_SIZE(1));
+  LONGS_EQUAL(16, POOL_BLOCK_SIZE(9));
+  LONGS_EQUAL(16, POOL_BLOCK_SIZE(16));
+}
+
+TEST(PoolTests, InitializesWithAllBlocksAvailable)
+{
+  LONGS_EQUAL(BLOCK_COUNT, pool_capacity(&pool));
+  LONGS_EQUAL(0, pool_used(&pool));
+  LONGS_EQUAL(BLOCK_COUNT, pool_available(&pool));
+  LONGS_EQUAL(0, pool_high_water_mark(&pool));
+}
+
+TEST(PoolTests, AllocReturnsDistinctAlignedBlocksFromBuffer)
+{
+  void* blocks[BLOCK_COUNT];
+
+  for(int i = 0; i < BLOCK_COUNT; i++) {
+    blocks[i] = pool_alloc(&pool);
+    CHECK(blocks[i] != NULL);
+    CHECK_TRUE(pool_owns(&pool, blocks[i]));
+    LONGS_EQUAL(0, (uintptr_t)blocks[i] % POOL_ALIGNMENT);
+    for(int j = 0; j < i; j++) {
+      CHECK(blocks[i] != blocks[j]);
+    }
+  }
+}
+
+TEST(PoolTests, AllocFailsWhenExhausted)
+{
+  for(int i = 0; i < BLOCK_COUNT; i++) {
+    pool_alloc(&pool);
+  }
+
+  CHECK(pool_alloc(&pool) == NULL);
+  CHECK(pool_alloc(&pool) == NULL);
+  LONGS_EQUAL(2, pool_failed_allocations(&pool));
+  LONGS_EQUAL(0, pool_available(&pool));
+}
+
+TEST(PoolTests, FreedBlockIsReused)
+{
+  for(int i = 0; i < BLOCK_COUNT - 1; i++) {
+    pool_alloc(&pool);
+  }
+  void* last = pool_alloc(&pool);
+
+  pool_free(&pool, last);
+
+  POINTERS_EQUAL(last, pool_alloc(&pool));
+}
+
+TEST(PoolTests, FreeNullDoesNothing)
+{
+  pool_free(&pool, NULL);
+  LONGS_EQUAL(0, pool_used(&pool));
+}
+
+TEST(PoolTests, HighWaterMarkTracksPeakUsage)
+{
+  void* a = pool_alloc(&pool);
+  void* b = pool_alloc(&pool);
+  void* c = pool_alloc(&pool);
+  pool_free(&pool, b);
+  pool_free(&pool, c);
+  pool_alloc(&pool);
+
+  LONGS_EQUAL(2, pool_used(&pool));
+  LONGS_EQUAL(3, pool_high_water_mark(&pool));
+
+  pool_free(&pool, a);
+  pool_reset_statistics(&pool);
+  LONGS_EQUAL(1, pool_high_water_mark(&pool));
+}
+
+TEST(PoolTests, OwnsRejectsForeignAndMisalignedPointers)
+{
+  uint64_t other;
+  void* block = pool_alloc(&pool);
+
+  CHECK_FALSE(pool_owns(&pool, &other));
+  CHECK_FALSE(pool_owns(&pool, (uint8_t*)block + 1));
+}
+
+TEST(PoolTests, PooledTimersCanBeStartedAndStopped)
+{
+  double_timesource_t timesource;
+  s_timer_controller_t controller;
+  double_timesource_init(&timesource);
+  timer_controller_init(&controller, &timesource.interface);
+
+  s_timer_t* timer = (s_timer_t*)pool_alloc(&pool);
+  timer_init(timer);
+
+  timer_start_one_shot(timer, &controller, 10, nullptr, nullptr);
+  CHECK_TRUE(timer_is_active(&controller, timer));
+
+  timer_stop(timer);
+  pool_free(&pool, timer);
+  LONGS_EQUAL(0, pool_used(&pool));
+}
+
+// ---------------------------------------------------------------------------
+// Thread-safe variant
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_THREADS = 4,
+  STRESS_ITERATIONS = 20000,
+};
+
+static void* stress_worker(void* arg)
+{
+  pool_t* shared = (pool_t*)arg;
+
+  for(int i = 0; i < STRESS_ITERATIONS; i++) {
+    uint32_t* block = (uint32_t*)pool_alloc(shared);
+    if(block != NULL) {
+      *block = (uint32_t)i;
+      pool_free(shared, block);
+    }
+  }
+
+  return nullptr;
+}
+
+TEST(PoolTests, ThreadSafePoolKeepsCountsConsistentUnderContention)
+{
+  static POOL_BUFFER(shared_buffer, sizeof(uint32_t), 2);
+  pool_t shared;
+  pool_init_thread_safe(&shared, shared_buffer, sizeof(uint32_t), 2);
+
+  pthread_t threads[STRESS_THREADS];
+  for(auto& thread : threads) {
+    pthread_create(&thread, nullptr, stress_worker, &shared);
+  }
+  for(auto& thread : threads) {
+    pthread_join(thread, nullptr);
+  }
+
+  LONGS_EQUAL(0, pool_used(&shared));
+  LONGS_EQUAL(2, pool_available(&shared));
+  CHECK(pool_high_water_mark(&shared) <= 2);
+}
@@ -0,0 +1,259 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "spsc_ring.h"
+}
+
+TEST_GROUP(SpscRingTests)
+{
+  spsc_ring_t ring;
+  uint32_t buffer[8];
+
+  void setup()
+  {
+    spsc_ring_init(&ring, buffer, sizeof(uint32_t), 8);
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(SpscRingTests, InitRejectsNonPowerOfTwoCapacity)
+{
+  CHECK_FALSE(spsc_ring_init(&ring, buffer, sizeof(uint32_t), 6));
+  CHECK_FALSE(spsc_ring_init(&ring, buffer, sizeof(uint32_t), 0));
+  CHECK_TRUE(spsc_ring_init(&ring, buffer, sizeof(uint32_t), 4));
+}
+
+TEST(SpscRingTests, InitializesEmpty)
+{
+  CHECK_TRUE(spsc_ring_is_empty(&ring));
+  LONGS_EQUAL(0, spsc_ring_count(&ring));
+  LONGS_EQUAL(8, spsc_ring_space(&ring));
+  LONGS_EQUAL(8, spsc_ring_capacity(&ring));
+}
+
+TEST(SpscRingTests, PopFromEmptyReturnsFalse)
+{
+  uint32_t value = 0xAA;
+  CHECK_FALSE(spsc_ring_pop(&ring, &value));
+  LONGS_EQUAL(0xAA, value);
+}
+
+TEST(SpscRingTests, PushPopFIFOOrder)
+{
+  for(uint32_t i = 1; i <= 3; i++) {
+    CHECK_TRUE(spsc_ring_push(&ring, &i));
+  }
+
+  uint32_t value;
+  for(uint32_t i = 1; i <= 3; i++) {
+    CHECK_TRUE(spsc_ring_pop(&ring, &value));
+    LONGS_EQUAL(i, value);
+  }
+  CHECK_TRUE(spsc_ring_is_empty(&ring));
+}
+
+TEST(SpscRingTests, AllSlotsAreUsable)
+{
+  for(uint32_t i = 0; i < 8; i++) {
+    CHECK_TRUE(spsc_ring_push(&ring, &i));
+  }
+
+  uint32_t extra = 99;
+  CHECK_FALSE(spsc_ring_push(&ring, &extra));
+  LONGS_EQUAL(8, spsc_ring_count(&ring));
+  LONGS_EQUAL(0, spsc_ring_space(&ring));
+}
+
+TEST(SpscRingTests, PushNIsTruncatedToFreeSpace)
+{
+  uint32_t in[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+  LONGS_EQUAL(8, spsc_ring_push_n(&ring, in, 10));
+  LONGS_EQUAL(0, spsc_ring_push_n(&ring, in, 1));
+}
+
+TEST(SpscRingTests, PopNWrapsAroundTheEnd)
+{
+  uint32_t in[6] = { 1, 2, 3, 4, 5, 6 };
+  uint32_t out[6] = {};
+
+  spsc_ring_push_n(&ring, in, 6);
+  LONGS_EQUAL(6, spsc_ring_pop_n(&ring, out, 6));
+
+  LONGS_EQUAL(6, spsc_ring_push_n(&ring, in, 6));
+  LONGS_EQUAL(6, spsc_ring_pop_n(&ring, out, 10));
+  MEMCMP_EQUAL(in, out, sizeof(in));
+}
+
+TEST(SpscRingTests, IndicesSurviveWrapOfCounter)
+{
+  atomic_store(&ring.head, UINT32_MAX - 2);
+  atomic_store(&ring.tail, UINT32_MAX - 2);
+
+  uint32_t in[5] = { 1, 2, 3, 4, 5 };
+  uint32_t out[5] = {};
+
+  LONGS_EQUAL(5, spsc_ring_push_n(&ring, in, 5));
+  LONGS_EQUAL(5, spsc_ring_count(&ring));
+  LONGS_EQUAL(5, spsc_ring_pop_n(&ring, out, 5));
+  MEMCMP_EQUAL(in, out, sizeof(in));
+}
+
+TEST(SpscRingTests, WriteRegionStopsAtBufferEnd)
+{
+  uint32_t in[6] = {};
+  uint32_t out[6];
+  spsc_ring_push_n(&ring, in, 6);
+  spsc_ring_pop_n(&ring, out, 6);
+
+  void* region;
+  LONGS_EQUAL(2, spsc_ring_write_region(&ring, &region));
+  POINTERS_EQUAL(&buffer[6], region);
+}
+
+TEST(SpscRingTests, WriteCommitPublishesInPlaceElements)
+{
+  void* region;
+  uint32_t available = spsc_ring_write_region(&ring, &region);
+  LONGS_EQUAL(8, available);
+
+  uint32_t* slots = (uint32_t*)region;
+  slots[0] = 10;
+  slots[1] = 20;
+  spsc_ring_write_commit(&ring, 2);
+
+  LONGS_EQUAL(2, spsc_ring_count(&ring));
+
+  uint32_t value;
+  spsc_ring_pop(&ring, &value);
+  LONGS_EQUAL(10, value);
+}
+
+TEST(SpscRingTests, ReadRegionExposesContiguousElements)
+{
+  uint32_t in[3] = { 7, 8, 9 };
+  spsc_ring_push_n(&ring, in, 3);
+
+  const void* region;
+  LONGS_EQUAL(3, spsc_ring_read_region(&ring, &region));
+  LONGS_EQUAL(7, ((const uint32_t*)region)[0]);
+  LONGS_EQUAL(9, ((const uint32_t*)region)[2]);
+
+  spsc_ring_read_commit(&ring, 2);
+  LONGS_EQUAL(1, spsc_ring_count(&ring));
+}
+
+TEST(SpscRingTests, ReadRegionEmptyReturnsZero)
+{
+  const void* region;
+  LONGS_EQUAL(0, spsc_ring_read_region(&ring, &region));
+}
+
+TEST(SpscRingTests, ByteRingWriteAndRead)
+{
+  spsc_byte_ring_t bytes;
+  uint8_t storage[16];
+  CHECK_TRUE(spsc_byte_ring_init(&bytes, storage, sizeof(storage)));
+
+  const uint8_t message[] = "hello, ring";
+  LONGS_EQUAL(sizeof(message), spsc_byte_ring_write(&bytes, message, sizeof(message)));
+  LONGS_EQUAL(sizeof(message), spsc_byte_ring_count(&bytes));
+
+  uint8_t out[sizeof(message)];
+  LONGS_EQUAL(sizeof(message), spsc_byte_ring_read(&bytes, out, sizeof(out)));
+  STRCMP_EQUAL((const char*)message, (const char*)out);
+}
+
+TEST(SpscRingTests, ByteRingWriteIsTruncatedWhenFull)
+{
+  spsc_byte_ring_t bytes;
+  uint8_t storage[4];
+  spsc_byte_ring_init(&bytes, storage, sizeof(storage));
+
+  const uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+  LONGS_EQUAL(4, spsc_byte_ring_write(&bytes, data, sizeof(data)));
+}
+
+// ---------------------------------------------------------------------------
+// Host-thread stress: one producer thread, one consumer thread, sequence check
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_COUNT = 200000,
+  STRESS_BATCH = 5,
+};
+
+static void* stress_producer(void* arg)
+{
+  spsc_ring_t* ring = (spsc_ring_t*)arg;
+  uint32_t next = 0;
+
+  while(next < STRESS_COUNT) {
+    if(next % 3 == 0) {
+      uint32_t batch[STRESS_BATCH];
+      uint32_t n = 0;
+      for(; n < STRESS_BATCH && next + n < STRESS_COUNT; n++) {
+        batch[n] = next + n;
+      }
+      uint32_t pushed = spsc_ring_push_n(ring, batch, n);
+      next += pushed;
+      if(pushed == 0) {
+        sched_yield();
+      }
+    }
+    else if(spsc_ring_push(ring, &next)) {
+      next++;
+    }
+    else {
+      sched_yield();
+    }
+  }
+
+  return nullptr;
+}
+
+TEST(SpscRingTests, StressProducerConsumerThreadsPreserveSequence)
+{
+  static uint32_t storage[64];
+  spsc_ring_t shared;
+  spsc_ring_init(&shared, storage, sizeof(uint32_t), 64);
+
+  pthread_t producer;
+  pthread_create(&producer, nullptr, stress_producer, &shared);
+
+  uint32_t expected = 0;
+  bool in_order = true;
+  while(expected < STRESS_COUNT) {
+    const void* region;
+    uint32_t available = spsc_ring_read_region(&shared, &region);
+    if(available > 0 && expected % 2 == 0) {
+      const uint32_t* values = (const uint32_t*)region;
+      for(uint32_t i = 0; i < available; i++) {
+        in_order &= values[i] == expected + i;
+      }
+      spsc_ring_read_commit(&shared, available);
+      expected += available;
+    }
+    else {
+      uint32_t value;
+      if(spsc_ring_pop(&shared, &value)) {
+        in_order &= value == expected;
+        expected++;
+      }
+      else {
+        sched_yield();
+      }
+    }
+  }
+
+  pthread_join(producer, nullptr);
+
+  CHECK_TRUE(in_order);
+  CHECK_TRUE(spsc_ring_is_empty(&shared));
+}
@@ -5,7 +5,7 @@ extern "C" {
 #include "composite_datastream.h"
 #include "event_subscription.h"
 #include "i_datastream.h"
-#include <stdio.h>
+#include "ram_datastream.h"
 }
 
 #include "double_datastream.hpp"
@@ -36,6 +36,11 @@ TEST_GROUP(CompositeDatastreamTests)
   double_datastream_t streamB;
   double_datastream_t streamC;
 
+  // The composite keeps a pointer to the stream list, so it must outlive each call.
+  i_datastream_t* streams[3];
+  COMPOSITE_DATASTREAM_ROUTES(routes, KEY_FLOAT + 1);
+  COMPOSITE_DATASTREAM_CAPTURES(captures, 3);
+
   void setup()
   {
     double_datastream_init(&streamA);
@@ -44,12 +49,13 @@ TEST_GROUP(CompositeDatastreamTests)
 
     datastream = &composite.interface;
 
+    streams[0] = &streamA.interface;
+    streams[1] = &streamB.interface;
+    streams[2] = &streamC.interface;
+
     // Default: single stream
-    i_datastream_t* streams[] = { &streamA.interface };
     composite_datastream_init(&composite, streams, 1);
-  
-    printf("initted\n");
-}
+  }
 
   void teardown()
   {
@@ -59,15 +65,27 @@ TEST_GROUP(CompositeDatastreamTests)
 
   void use_two_streams()
   {
-    i_datastream_t* streams[] = { &streamA.interface, &streamB.interface };
     composite_datastream_init(&composite, streams, 2);
   }
 
   void use_three_streams()
   {
-    i_datastream_t* streams[] = { &streamA.interface, &streamB.interface, &streamC.interface };
     composite_datastream_init(&composite, streams, 3);
   }
+
+  // Route KEY_U8..KEY_FLOAT with even keys in streamA and odd keys in streamB.
+  void use_routes()
+  {
+    use_two_streams();
+
+    mock().disable();
+    composite_datastream_set_routes(&composite, routes, KEY_FLOAT + 1);
+    mock().enable();
+
+    for(uint16_t key = 0; key <= KEY_FLOAT; key++) {
+      routes[key] = (uint8_t)(key % 2);
+    }
+  }
 };
 
 // ────────────────────────────────────────────────
@@ -183,6 +201,19 @@ TEST(CompositeDatastreamTests, Write_ForwardsToFirstMatchingStreamOnly)
   datastream_write(datastream, KEY_U16, &value);
 }
 
+TEST(CompositeDatastreamTests, WriteRange_ForwardsToMatchingStream)
+{
+  use_two_streams();
+
+  uint8_t slice[2] = { 1, 2 };
+
+  double_expect_contains(&streamA, KEY_STRUCT, false);
+  double_expect_contains(&streamB, KEY_STRUCT, true);
+  double_expect_write_range(&streamB, KEY_STRUCT, 4, sizeof(slice), slice);
+
+  datastream_write_range(datastream, KEY_STRUCT, 4, sizeof(slice), slice);
+}
+
 TEST(CompositeDatastreamTests, Write_Silent_WhenKeyNotFound)
 {
   uint8_t value = 42;
@@ -193,6 +224,85 @@ TEST(CompositeDatastreamTests, Write_Silent_WhenKeyNotFound)
   // no crash, no call expected
 }
 
+// ────────────────────────────────────────────────
+// peek() / acquire() / release()
+// ────────────────────────────────────────────────
+
+TEST(CompositeDatastreamTests, ZeroCopyAccess_ForwardsToMatchingStream)
+{
+  use_two_streams();
+
+  uint32_t stored = 7;
+
+  double_expect_contains(&streamA, KEY_U32, false);
+  double_expect_contains(&streamB, KEY_U32, true);
+  double_expect_peek(&streamB, KEY_U32, &stored);
+  double_expect_contains(&streamA, KEY_U32, false);
+  double_expect_contains(&streamB, KEY_U32, true);
+  double_expect_acquire(&streamB, KEY_U32, &stored);
+  double_expect_contains(&streamA, KEY_U32, false);
+  double_expect_contains(&streamB, KEY_U32, true);
+  double_expect_release(&streamB, KEY_U32);
+
+  POINTERS_EQUAL(&stored, datastream_peek(datastream, KEY_U32));
+  POINTERS_EQUAL(&stored, datastream_acquire(datastream, KEY_U32));
+  datastream_release(datastream, KEY_U32);
+}
+
+TEST(CompositeDatastreamTests, ZeroCopyAccess_ReturnsNull_WhenKeyNotFound)
+{
+  double_expect_contains(&streamA, KEY_U32, false);
+  double_expect_contains(&streamA, KEY_U32, false);
+
+  POINTERS_EQUAL(nullptr, datastream_peek(datastream, KEY_U32));
+  POINTERS_EQUAL(nullptr, datastream_acquire(datastream, KEY_U32));
+}
+
+TEST(CompositeDatastreamTests, Version_ForwardsToMatchingStream)
+{
+  use_two_streams();
+
+  double_expect_contains(&streamA, KEY_U16, false);
+  double_expect_contains(&streamB, KEY_U16, true);
+  double_expect_version(&streamB, KEY_U16, 17);
+  double_expect_contains(&streamA, KEY_INVALID, false);
+  double_expect_contains(&streamB, KEY_INVALID, false);
+
+  UNSIGNED_LONGS_EQUAL(17, datastream_version(datastream, KEY_U16));
+  UNSIGNED_LONGS_EQUAL(0, datastream_version(datastream, KEY_INVALID));
+}
+
+// ────────────────────────────────────────────────
+// subscribe()
+// ────────────────────────────────────────────────
+
+TEST(CompositeDatastreamTests, Subscribe_ReportsMatchingStreamsResult)
+{
+  use_two_streams();
+
+  event_subscription_t sub = {};
+  event_subscription_init(&sub, dummy_callback, nullptr);
+
+  double_expect_contains(&streamA, KEY_U16, false);
+  double_expect_contains(&streamB, KEY_U16, true);
+  double_expect_subscribe(&streamB, KEY_U16, &sub, false);
+
+  CHECK_FALSE(datastream_subscribe(datastream, KEY_U16, &sub));
+}
+
+TEST(CompositeDatastreamTests, Subscribe_Fails_WhenKeyNotFound)
+{
+  use_two_streams();
+
+  event_subscription_t sub = {};
+  event_subscription_init(&sub, dummy_callback, nullptr);
+
+  double_expect_contains(&streamA, KEY_INVALID, false);
+  double_expect_contains(&streamB, KEY_INVALID, false);
+
+  CHECK_FALSE(datastream_subscribe(datastream, KEY_INVALID, &sub));
+}
+
 // ────────────────────────────────────────────────
 // subscribe_all()
 // ────────────────────────────────────────────────
@@ -211,6 +321,238 @@ TEST(CompositeDatastreamTests, SubscribeAll_CallsEveryUnderlyingStream)
   datastream_subscribe_all(datastream, &sub);
 }
 
+// ────────────────────────────────────────────────
+// Batches
+// ────────────────────────────────────────────────
+
+TEST(CompositeDatastreamTests, Batch_ForwardsToEveryUnderlyingStream)
+{
+  use_two_streams();
+
+  event_subscription_t sub = {};
+  event_subscription_init(&sub, dummy_callback, nullptr);
+
+  double_expect_subscribe_batch(&streamA, &sub);
+  double_expect_subscribe_batch(&streamB, &sub);
+  double_expect_begin_batch(&streamA);
+  double_expect_begin_batch(&streamB);
+  double_expect_commit(&streamA);
+  double_expect_commit(&streamB);
+
+  datastream_subscribe_batch(datastream, &sub);
+  datastream_begin_batch(datastream);
+  datastream_commit(datastream);
+}
+
+TEST(CompositeDatastreamTests, BatchStorage_SubscribesToEveryStreamsBatches)
+{
+  use_two_streams();
+  BITSET_STORAGE(dirty, KEY_FLOAT + 1);
+
+  double_expect_subscribe_batch(&streamA, &captures[0]);
+  double_expect_subscribe_batch(&streamB, &captures[1]);
+
+  composite_datastream_set_batch_storage(&composite, dirty, KEY_FLOAT + 1, captures);
+}
+
+TEST(CompositeDatastreamTests, BatchStorage_SubscribeBatchStaysOnTheComposite)
+{
+  use_two_streams();
+  BITSET_STORAGE(dirty, KEY_FLOAT + 1);
+  mock().disable();
+  composite_datastream_set_batch_storage(&composite, dirty, KEY_FLOAT + 1, captures);
+  mock().enable();
+
+  event_subscription_t sub = {};
+  event_subscription_init(&sub, dummy_callback, nullptr);
+
+  datastream_subscribe_batch(datastream, &sub);
+
+  POINTERS_EQUAL(&sub.node, composite.batch_on_change.subscribers.head);
+}
+
+// Two real streams: keys 0 and 1 live in the first, key 2 in the second.
+typedef struct {
+  uint16_t a;
+  uint16_t b;
+  uint16_t c;
+} split_storage_t;
+
+static const ram_datastream_entry_t first_entries[] = {
+  { offsetof(split_storage_t, a), sizeof(uint16_t) },
+  { offsetof(split_storage_t, b), sizeof(uint16_t) },
+};
+
+static const ram_datastream_entry_t second_entries[] = {
+  { 0, 0 },
+  { 0, 0 },
+  { offsetof(split_storage_t, c), sizeof(uint16_t) },
+};
+
+static const ram_datastream_config_t first_config = { first_entries, 2, nullptr };
+static const ram_datastream_config_t second_config = { second_entries, 3, nullptr };
+
+static void batch_keys_callback(void* context, const void* data)
+{
+  const datastream_on_batch_args_t* args = (const datastream_on_batch_args_t*)data;
+  mock().actualCall("on_batch").withPointerParameter("context", context).withIntParameter("count", bitset_count(args->keys)).withBoolParameter("k0", bitset_test(args->keys, 0)).withBoolParameter("k2", bitset_test(args->keys, 2));
+}
+
+TEST(CompositeDatastreamTests, BatchAcrossStreams_PublishesOneCoalescedBatch)
+{
+  ram_datastream_t first;
+  ram_datastream_t second;
+  split_storage_t first_storage;
+  split_storage_t second_storage;
+  BITSET_STORAGE(first_dirty, 2);
+  BITSET_STORAGE(second_dirty, 3);
+  BITSET_STORAGE(dirty, 3);
+
+  ram_datastream_init(&first, &first_config, &first_storage);
+  ram_datastream_init(&second, &second_config, &second_storage);
+  ram_datastream_set_batch_storage(&first, first_dirty);
+  ram_datastream_set_batch_storage(&second, second_dirty);
+  streams[0] = &first.interface;
+  streams[1] = &second.interface;
+  use_two_streams();
+  composite_datastream_set_batch_storage(&composite, dirty, 3, captures);
+
+  event_subscription_t sub;
+  int ctx = 1;
+  event_subscription_init(&sub, batch_keys_callback, &ctx);
+  datastream_subscribe_batch(datastream, &sub);
+
+  uint16_t value = 7;
+  datastream_begin_batch(datastream);
+  datastream_begin_batch(datastream);
+  datastream_write(datastream, 0, &value);
+  datastream_commit(datastream);
+  datastream_write(datastream, 2, &value);
+  mock().checkExpectations(); // nothing before the outermost commit
+
+  mock().expectOneCall("on_batch").withPointerParameter("context", &ctx).withIntParameter("count", 2).withBoolParameter("k0", true).withBoolParameter("k2", true);
+  datastream_commit(datastream);
+  mock().checkExpectations();
+
+  // A stream committed on its own still reaches the composite's batch subscribers.
+  value = 8;
+  datastream_begin_batch(&second.interface);
+  datastream_write(&second.interface, 2, &value);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &ctx).withIntParameter("count", 1).withBoolParameter("k0", false).withBoolParameter("k2", true);
+  datastream_commit(&second.interface);
+}
+
+TEST(CompositeDatastreamTests, BatchAcrossStreams_ChildCommitsStayOnTheirOwnStream)
+{
+  ram_datastream_t first;
+  ram_datastream_t second;
+  split_storage_t first_storage;
+  split_storage_t second_storage;
+  BITSET_STORAGE(first_dirty, 2);
+  BITSET_STORAGE(second_dirty, 3);
+  BITSET_STORAGE(dirty, 3);
+
+  ram_datastream_init(&first, &first_config, &first_storage);
+  ram_datastream_init(&second, &second_config, &second_storage);
+  ram_datastream_set_batch_storage(&first, first_dirty);
+  ram_datastream_set_batch_storage(&second, second_dirty);
+  streams[0] = &first.interface;
+  streams[1] = &second.interface;
+  use_two_streams();
+  composite_datastream_set_batch_storage(&composite, dirty, 3, captures);
+
+  event_subscription_t sub;
+  event_subscription_t first_sub;
+  event_subscription_t second_sub;
+  int ctx = 1;
+  int first_ctx = 2;
+  int second_ctx = 3;
+  event_subscription_init(&sub, batch_keys_callback, &ctx);
+  event_subscription_init(&first_sub, batch_keys_callback, &first_ctx);
+  event_subscription_init(&second_sub, batch_keys_callback, &second_ctx);
+  datastream_subscribe_batch(datastream, &sub);
+  datastream_subscribe_batch(&first.interface, &first_sub);
+  datastream_subscribe_batch(&second.interface, &second_sub);
+
+  uint16_t value = 7;
+  datastream_begin_batch(&first.interface);
+  datastream_write(&first.interface, 0, &value);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &ctx).withIntParameter("count", 1).withBoolParameter("k0", true).withBoolParameter("k2", false);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &first_ctx).withIntParameter("count", 1).withBoolParameter("k0", true).withBoolParameter("k2", false);
+  datastream_commit(&first.interface);
+  mock().checkExpectations();
+
+  datastream_begin_batch(&second.interface);
+  datastream_write(&second.interface, 2, &value);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &ctx).withIntParameter("count", 1).withBoolParameter("k0", false).withBoolParameter("k2", true);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &second_ctx).withIntParameter("count", 1).withBoolParameter("k0", false).withBoolParameter("k2", true);
+  datastream_commit(&second.interface);
+}
+
+// ────────────────────────────────────────────────
+// Routing table
+// ────────────────────────────────────────────────
+
+TEST(CompositeDatastreamTests, SetRoutes_ProbesEachKeyOnceInStreamOrder)
+{
+  use_two_streams();
+  COMPOSITE_DATASTREAM_ROUTES(small, 2);
+
+  double_expect_contains(&streamA, 0, false);
+  double_expect_contains(&streamB, 0, true);
+  double_expect_contains(&streamA, 1, false);
+  double_expect_contains(&streamB, 1, false);
+
+  composite_datastream_set_routes(&composite, small, 2);
+
+  BYTES_EQUAL(1, small[0]);
+  BYTES_EQUAL(COMPOSITE_DATASTREAM_NO_ROUTE, small[1]);
+}
+
+TEST(CompositeDatastreamTests, Routes_ForwardWithoutAskingStreams)
+{
+  use_routes();
+
+  uint32_t expected_value = 0xDEADBEEF;
+  double_expect_read(&streamB, KEY_U16, &expected_value, sizeof(expected_value));
+  double_expect_size(&streamA, KEY_U32, sizeof(uint32_t));
+
+  uint32_t result = 0;
+  datastream_read(datastream, KEY_U16, &result);
+
+  UNSIGNED_LONGS_EQUAL(0xDEADBEEF, result);
+  LONGS_EQUAL(sizeof(uint32_t), datastream_size(datastream, KEY_U32));
+  CHECK_TRUE(datastream_contains(datastream, KEY_CHAR));
+}
+
+TEST(CompositeDatastreamTests, Routes_MissingKeyIsResolvedWithoutProbing)
+{
+  use_routes();
+  routes[KEY_U8] = COMPOSITE_DATASTREAM_NO_ROUTE;
+
+  CHECK_FALSE(datastream_contains(datastream, KEY_U8));
+}
+
+TEST(CompositeDatastreamTests, Routes_KeysBeyondTableFallBackToScan)
+{
+  use_routes();
+
+  double_expect_contains(&streamA, KEY_INVALID, false);
+  double_expect_contains(&streamB, KEY_INVALID, false);
+
+  CHECK_FALSE(datastream_contains(datastream, KEY_INVALID));
+}
+
+TEST(CompositeDatastreamTests, Init_ClearsRoutes)
+{
+  use_routes();
+  use_two_streams();
+
+  double_expect_contains(&streamA, KEY_U16, true);
+
+  CHECK_TRUE(datastream_contains(datastream, KEY_U16));
+}
+
 // ────────────────────────────────────────────────
 // Edge cases
 // ────────────────────────────────────────────────
@@ -229,6 +571,7 @@ TEST(CompositeDatastreamTests, ZeroStreams_InitIsSafe)
 TEST(CompositeDatastreamTests, NullReadBuffer_DoesNotCrash)
 {
   double_expect_contains(&streamA, KEY_CHAR, true);
+  double_expect_read(&streamA, KEY_CHAR, nullptr, 0);
 
   datastream_read(datastream, KEY_CHAR, nullptr);
   // should not segfault
@@ -0,0 +1,369 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+
+extern "C" {
+#include "event_subscription.h"
+#include "locked_datastream.h"
+#include "ram_datastream.h"
+#include "spin_critical_section.h"
+#include "utils.h"
+}
+
+enum {
+  LOCKED_U32,
+  LOCKED_BYTES,
+  LOCKED_KEY_COUNT,
+};
+
+typedef struct {
+  uint32_t u32;
+  uint8_t bytes[4];
+} locked_storage_t;
+
+static const ram_datastream_entry_t locked_entries[] = {
+  { offsetof(locked_storage_t, u32), sizeof(uint32_t) },
+  { offsetof(locked_storage_t, bytes), 4 },
+};
+
+static const ram_datastream_config_t locked_config = {
+  .entries = locked_entries,
+  .count = NUM_ELEMENTS(locked_entries),
+};
+
+// Records how the decorator drives its section; try_enter can be scripted to report a
+// holder so the contended path runs without a second thread.
+typedef struct {
+  i_critical_section_t interface;
+  bool held;
+  int enters;
+  int busy_tries;
+} fake_section_t;
+
+static void fake_enter(i_critical_section_t* interface)
+{
+  fake_section_t* section = (fake_section_t*)interface;
+  CHECK_FALSE(section->held);
+  section->held = true;
+  section->enters++;
+}
+
+static bool fake_try_enter(i_critical_section_t* interface)
+{
+  fake_section_t* section = (fake_section_t*)interface;
+  if(section->busy_tries > 0) {
+    section->busy_tries--;
+    return false;
+  }
+  fake_enter(interface);
+  return true;
+}
+
+static void fake_exit(i_critical_section_t* interface)
+{
+  fake_section_t* section = (fake_section_t*)interface;
+  CHECK_TRUE(section->held);
+  section->held = false;
+}
+
+typedef struct {
+  i_event_profiler_clock_t interface;
+  event_profiler_ticks_t ticks;
+} step_clock_t;
+
+static event_profiler_ticks_t step_clock_now(i_event_profiler_clock_t* interface)
+{
+  step_clock_t* clock = (step_clock_t*)interface;
+  clock->ticks += 10;
+  return clock->ticks;
+}
+
+static fake_section_t* observed_section;
+
+static void mock_callback(void* context, const void* data)
+{
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  mock()
+    .actualCall("callback")
+    .withPointerParameter("context", context)
+    .withIntParameter("key", args->key)
+    .withIntParameter("offset", args->offset)
+    .withIntParameter("length", args->length)
+    .withBoolParameter("held", observed_section->held);
+}
+
+static void mock_batch_callback(void* context, const void* data)
+{
+  const datastream_on_batch_args_t* args = (const datastream_on_batch_args_t*)data;
+  mock()
+    .actualCall("batch")
+    .withPointerParameter("context", context)
+    .withIntParameter("count", bitset_count(args->keys))
+    .withBoolParameter("held", observed_section->held);
+}
+
+TEST_GROUP(LockedDatastreamTests)
+{
+  ram_datastream_t ram;
+  locked_storage_t storage;
+  fake_section_t section;
+  locked_datastream_t ds;
+  DATASTREAM_SUBSCRIBERS_STORAGE(subscribers, 2);
+
+  void setup()
+  {
+    ram_datastream_init(&ram, &locked_config, &storage);
+    section = { { fake_enter, fake_try_enter, fake_exit }, false, 0, 0 };
+    observed_section = &section;
+    locked_datastream_init(&ds, &ram.interface, &section.interface);
+    locked_datastream_set_subscriber_storage(&ds, subscribers_slots, subscribers_events, 2);
+  }
+
+  void teardown()
+  {
+    CHECK_FALSE(section.held);
+    mock().checkExpectations();
+    mock().clear();
+  }
+};
+
+TEST(LockedDatastreamTests, AccessesTheWrappedStreamInsideTheSection)
+{
+  uint32_t value = 42;
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+
+  uint32_t out = 0;
+  datastream_read(&ds.interface, LOCKED_U32, &out);
+  LONGS_EQUAL(42, out);
+  LONGS_EQUAL(42, storage.u32);
+  LONGS_EQUAL(2, section.enters);
+
+  CHECK_TRUE(datastream_version(&ds.interface, LOCKED_U32) == 0);
+  LONGS_EQUAL(3, section.enters);
+  LONGS_EQUAL(4, datastream_size(&ds.interface, LOCKED_BYTES));
+  CHECK_FALSE(datastream_contains(&ds.interface, LOCKED_KEY_COUNT));
+  LONGS_EQUAL(3, section.enters);
+}
+
+TEST(LockedDatastreamTests, SubscribersRunAfterTheSectionIsReleased)
+{
+  event_subscription_t key_sub;
+  event_subscription_t all_sub;
+  int key_ctx = 1;
+  int all_ctx = 2;
+  event_subscription_init(&key_sub, mock_callback, &key_ctx);
+  event_subscription_init(&all_sub, mock_callback, &all_ctx);
+  datastream_subscribe(&ds.interface, LOCKED_U32, &key_sub);
+  datastream_subscribe_all(&ds.interface, &all_sub);
+
+  uint32_t value = 0; // unchanged
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+  mock().checkExpectations();
+
+  value = 7;
+  mock().expectOneCall("callback").withPointerParameter("context", &key_ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  mock().expectOneCall("callback").withPointerParameter("context", &all_ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+  mock().checkExpectations();
+
+  const uint8_t slice[2] = { 1, 2 };
+  mock().expectOneCall("callback").withPointerParameter("context", &all_ctx).withIntParameter("key", LOCKED_BYTES).withIntParameter("offset", 1).withIntParameter("length", 2).withBoolParameter("held", false);
+  datastream_write_range(&ds.interface, LOCKED_BYTES, 1, sizeof(slice), slice);
+  mock().checkExpectations();
+
+  datastream_unsubscribe(&ds.interface, &key_sub);
+  datastream_unsubscribe(&ds.interface, &all_sub);
+  value = 8;
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+}
+
+// Writes back through the decorator, which would deadlock if it ran inside the section.
+static locked_datastream_t* write_back_stream;
+
+static void write_back_callback(void* context, const void* data)
+{
+  mock_callback(context, data);
+  const uint8_t bytes[4] = { 9, 9, 9, 9 };
+  datastream_write(&write_back_stream->interface, LOCKED_BYTES, bytes);
+}
+
+static int static_u32_ctx = 3;
+
+SIERA_STATIC_SUBSCRIBE(LOCKED_U32, write_back_callback, &static_u32_ctx);
+
+SIERA_STATIC_SUBSCRIPTIONS_DECLARE(LOCKED_U32);
+SIERA_STATIC_SUBSCRIPTIONS_DECLARE(LOCKED_BYTES);
+
+static const event_static_table_t locked_static_subscriptions[] = {
+  SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(LOCKED_U32),
+  SIERA_STATIC_SUBSCRIPTIONS_INITIALIZER(LOCKED_BYTES),
+};
+
+TEST(LockedDatastreamTests, StaticSubscribersRunAfterTheSectionIsReleased)
+{
+  write_back_stream = &ds;
+  locked_datastream_set_static_subscriptions(&ds, locked_static_subscriptions);
+
+  uint32_t value = 5;
+  mock().expectOneCall("callback").withPointerParameter("context", &static_u32_ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+
+  LONGS_EQUAL(9, storage.bytes[3]);
+  LONGS_EQUAL(2, section.enters);
+}
+
+TEST(LockedDatastreamTests, BatchIsForwardedAndPublishedAfterTheSectionIsReleased)
+{
+  BITSET_STORAGE(ram_dirty, LOCKED_KEY_COUNT);
+  LOCKED_DATASTREAM_BATCH(batch, LOCKED_KEY_COUNT);
+  ram_datastream_set_batch_storage(&ram, ram_dirty);
+  locked_datastream_set_batch_storage(&ds, batch_dirty, batch_values, LOCKED_KEY_COUNT);
+
+  event_subscription_t all_sub;
+  event_subscription_t batch_sub;
+  int ctx = 3;
+  event_subscription_init(&all_sub, mock_callback, &ctx);
+  event_subscription_init(&batch_sub, mock_batch_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &all_sub);
+  datastream_subscribe_batch(&ds.interface, &batch_sub);
+
+  datastream_begin_batch(&ds.interface);
+  datastream_begin_batch(&ds.interface);
+  uint32_t value = 7;
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+  const uint8_t slice[2] = { 1, 2 };
+  datastream_write_range(&ds.interface, LOCKED_BYTES, 1, sizeof(slice), slice);
+  datastream_commit(&ds.interface);
+  mock().checkExpectations();
+  LONGS_EQUAL(5, section.enters);
+
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", LOCKED_BYTES).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  mock().expectOneCall("batch").withPointerParameter("context", &ctx).withIntParameter("count", 2).withBoolParameter("held", false);
+  datastream_commit(&ds.interface);
+  mock().checkExpectations();
+  LONGS_EQUAL(6, section.enters);
+  POINTERS_EQUAL(&storage.bytes, batch_values[LOCKED_BYTES]);
+
+  datastream_unsubscribe(&ds.interface, &all_sub);
+  datastream_unsubscribe(&ds.interface, &batch_sub);
+}
+
+TEST(LockedDatastreamTests, BatchWithoutStorageLeavesTheWrappedStreamAlone)
+{
+  BITSET_STORAGE(ram_dirty, LOCKED_KEY_COUNT);
+  ram_datastream_set_batch_storage(&ram, ram_dirty);
+
+  event_subscription_t sub;
+  int ctx = 4;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+
+  datastream_begin_batch(&ds.interface);
+  LONGS_EQUAL(0, section.enters);
+
+  uint32_t value = 9;
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  datastream_write(&ds.interface, LOCKED_U32, &value);
+  mock().checkExpectations();
+
+  datastream_commit(&ds.interface);
+  LONGS_EQUAL(1, section.enters);
+  datastream_unsubscribe(&ds.interface, &sub);
+}
+
+TEST(LockedDatastreamTests, AcquireHoldsTheSectionUntilRelease)
+{
+  event_subscription_t sub;
+  int ctx = 3;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+
+  POINTERS_EQUAL(nullptr, datastream_peek(&ds.interface, LOCKED_U32));
+
+  uint32_t* value = (uint32_t*)datastream_acquire(&ds.interface, LOCKED_U32);
+  POINTERS_EQUAL(&storage.u32, value);
+  CHECK_TRUE(section.held);
+  *value = 9;
+
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", LOCKED_U32).withIntParameter("offset", 0).withIntParameter("length", 4).withBoolParameter("held", false);
+  datastream_release(&ds.interface, LOCKED_U32);
+  CHECK_FALSE(section.held);
+
+  POINTERS_EQUAL(nullptr, datastream_acquire(&ds.interface, LOCKED_KEY_COUNT));
+  CHECK_FALSE(section.held);
+}
+
+TEST(LockedDatastreamTests, ContendedAcquisitionsAreCountedPerKey)
+{
+  LOCKED_DATASTREAM_CONTENTION(contention, LOCKED_KEY_COUNT);
+  step_clock_t clock = { { step_clock_now }, 0 };
+  locked_datastream_track_contention(&ds, contention, LOCKED_KEY_COUNT, &clock.interface);
+
+  uint32_t out;
+  datastream_read(&ds.interface, LOCKED_U32, &out);
+  section.busy_tries = 1;
+  datastream_read(&ds.interface, LOCKED_U32, &out);
+  section.busy_tries = 1;
+  datastream_read(&ds.interface, LOCKED_BYTES, &out);
+  datastream_read(&ds.interface, LOCKED_KEY_COUNT, &out); // untracked key
+
+  LONGS_EQUAL(2, contention[LOCKED_U32].acquisitions);
+  LONGS_EQUAL(1, contention[LOCKED_U32].contended);
+  LONGS_EQUAL(10, contention[LOCKED_U32].wait_ticks);
+  LONGS_EQUAL(10, contention[LOCKED_U32].max_wait_ticks);
+  LONGS_EQUAL(1, contention[LOCKED_BYTES].acquisitions);
+  LONGS_EQUAL(1, contention[LOCKED_BYTES].contended);
+}
+
+// ---------------------------------------------------------------------------
+// Concurrent writers
+// ---------------------------------------------------------------------------
+
+enum {
+  WRITER_THREADS = 4,
+  WRITER_INCREMENTS = 5000,
+};
+
+static void yield(void)
+{
+  sched_yield();
+}
+
+static void* increment_worker(void* arg)
+{
+  i_datastream_t* datastream = (i_datastream_t*)arg;
+  for(int i = 0; i < WRITER_INCREMENTS; i++) {
+    uint32_t* counter = (uint32_t*)datastream_acquire(datastream, LOCKED_U32);
+    uint32_t value = *counter;
+    if((i & 0x3Fu) == 0) {
+      sched_yield();
+    }
+    *counter = value + 1;
+    datastream_release(datastream, LOCKED_U32);
+  }
+  return nullptr;
+}
+
+TEST(LockedDatastreamTests, ConcurrentReadModifyWritesAreNotLost)
+{
+  spin_critical_section_t spin;
+  spin_critical_section_init(&spin, yield);
+  ram_datastream_init(&ram, &locked_config, &storage);
+  locked_datastream_init(&ds, &ram.interface, &spin.interface);
+
+  pthread_t threads[WRITER_THREADS];
+  for(int t = 0; t < WRITER_THREADS; t++) {
+    pthread_create(&threads[t], nullptr, increment_worker, &ds.interface);
+  }
+  for(int t = 0; t < WRITER_THREADS; t++) {
+    pthread_join(threads[t], nullptr);
+  }
+
+  uint32_t out = 0;
+  datastream_read(&ds.interface, LOCKED_U32, &out);
+  LONGS_EQUAL(WRITER_THREADS * WRITER_INCREMENTS, out);
+}
@@ -1,6 +1,8 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTestExt/MockSupport.h"
 
+#include <pthread.h>
+#include <sched.h>
 #include <string.h>
 
 extern "C" {
@@ -20,16 +22,21 @@ typedef struct {
   int16_t y;
 } point_t;
 
-#define DS_ENTRIES(ENTRY) \
-  ENTRY(DS_U8, uint8_t)   \
-  ENTRY(DS_U16, uint16_t) \
-  ENTRY(DS_U32, uint32_t) \
-  ENTRY(DS_POINT, point_t)
+typedef struct {
+  int16_t samples[1024];
+} waveform_t;
+
+#define DS_ENTRIES(ENTRY)     \
+  ENTRY(DS_U8, uint8_t)       \
+  ENTRY(DS_U16, uint16_t)     \
+  ENTRY(DS_U32, uint32_t)     \
+  ENTRY(DS_POINT, point_t)    \
+  ENTRY(DS_WAVEFORM, waveform_t)
 
 DATABASE_ENUM(DS_ENTRIES)
 DATABASE_STORAGE(DS_ENTRIES)
 
-static ram_datastream_entry_t g_entries[] = {
+static const ram_datastream_entry_t g_entries[] = {
   DS_ENTRIES(DATABASE_EXPAND_AS_ENTRY)
 };
 
@@ -55,11 +62,13 @@ TEST_GROUP(RamDatastreamTests)
 {
   ram_datastream_t ds;
   ram_storage_t storage;
+  RAM_DATASTREAM_SUBSCRIBERS(subscribers, 4);
 
   void setup()
   {
     memset(&storage, 0, sizeof(storage));
     ram_datastream_init(&ds, &g_config, &storage);
+    ram_datastream_set_subscriber_storage(&ds, subscribers_slots, subscribers_events, 4);
   }
 
   void teardown()
@@ -115,6 +124,7 @@ TEST(RamDatastreamTests, SizeReturnsCorrectSizeForEachType)
   LONGS_EQUAL(sizeof(uint16_t), datastream_size(&ds.interface, DS_U16));
   LONGS_EQUAL(sizeof(uint32_t), datastream_size(&ds.interface, DS_U32));
   LONGS_EQUAL(sizeof(point_t), datastream_size(&ds.interface, DS_POINT));
+  LONGS_EQUAL(sizeof(waveform_t), datastream_size(&ds.interface, DS_WAVEFORM));
 }
 
 TEST(RamDatastreamTests, SizeReturnsZeroForInvalidKey)
@@ -156,6 +166,19 @@ TEST(RamDatastreamTests, WriteAndReadStruct)
   LONGS_EQUAL(200, r.y);
 }
 
+TEST(RamDatastreamTests, WriteAndReadEntryLargerThan255Bytes)
+{
+  static waveform_t w;
+  static waveform_t r;
+  for(int i = 0; i < 1024; i++) {
+    w.samples[i] = (int16_t)(i * 3);
+  }
+  datastream_write(&ds.interface, DS_WAVEFORM, &w);
+
+  datastream_read(&ds.interface, DS_WAVEFORM, &r);
+  MEMCMP_EQUAL(&w, &r, sizeof(w));
+}
+
 TEST(RamDatastreamTests, MultipleKeysAreStoredIndependently)
 {
   uint8_t u8 = 0xAB;
@@ -190,6 +213,296 @@ TEST(RamDatastreamTests, ReadFromInvalidKeyDoesNotModifyOut)
   BYTES_EQUAL(0xCC, out);
 }
 
+// --- storage layout ---
+
+TEST(RamDatastreamTests, StorageValuesAreNaturallyAligned)
+{
+  LONGS_EQUAL(0, g_entries[DS_U16].offset % alignof(uint16_t));
+  LONGS_EQUAL(0, g_entries[DS_U32].offset % alignof(uint32_t));
+  LONGS_EQUAL(0, g_entries[DS_POINT].offset % alignof(point_t));
+  LONGS_EQUAL(0, g_entries[DS_WAVEFORM].offset % alignof(waveform_t));
+}
+
+namespace sorted {
+
+#define SORTED_ENTRIES(ENTRY)   \
+  ENTRY(SORTED_U8, uint8_t)     \
+  ENTRY(SORTED_U64, uint64_t)   \
+  ENTRY(SORTED_U16, uint16_t)   \
+  ENTRY(SORTED_NAME, char[3])   \
+  ENTRY(SORTED_U32, uint32_t)
+
+DATABASE_ENUM(SORTED_ENTRIES)
+DATABASE_SORTED_STORAGE(SORTED_ENTRIES)
+
+static const ram_datastream_entry_t entries[] = {
+  SORTED_ENTRIES(DATABASE_EXPAND_AS_SORTED_ENTRY)
+};
+
+}
+
+TEST(RamDatastreamTests, SortedStorageOrdersByAlignmentWithoutPadding)
+{
+  // Declaration order would need 28 bytes before tail padding; sorted needs 18.
+  LONGS_EQUAL(24, sizeof(sorted::ram_storage_t));
+  LONGS_EQUAL(0, sorted::entries[sorted::SORTED_U64].offset);
+  LONGS_EQUAL(8, sorted::entries[sorted::SORTED_U32].offset);
+  LONGS_EQUAL(12, sorted::entries[sorted::SORTED_U16].offset);
+  LONGS_EQUAL(14, sorted::entries[sorted::SORTED_U8].offset);
+  LONGS_EQUAL(15, sorted::entries[sorted::SORTED_NAME].offset);
+  LONGS_EQUAL(3, sorted::entries[sorted::SORTED_NAME].size);
+}
+
+TEST(RamDatastreamTests, SortedStorageReadsAndWritesEveryKey)
+{
+  const ram_datastream_config_t config = { sorted::entries, NUM_ELEMENTS(sorted::entries), NULL };
+  sorted::ram_storage_t sorted_storage;
+  memset(&sorted_storage, 0xFF, sizeof(sorted_storage));
+  ram_datastream_init(&ds, &config, &sorted_storage);
+
+  uint64_t u64 = 0x0102030405060708ULL;
+  uint8_t u8 = 9;
+  datastream_write(&ds.interface, sorted::SORTED_U64, &u64);
+  datastream_write(&ds.interface, sorted::SORTED_U8, &u8);
+
+  uint64_t r64 = 0;
+  uint32_t r32 = 1;
+  uint8_t r8 = 0;
+  datastream_read(&ds.interface, sorted::SORTED_U64, &r64);
+  datastream_read(&ds.interface, sorted::SORTED_U32, &r32); // zeroed by init
+  datastream_read(&ds.interface, sorted::SORTED_U8, &r8);
+  CHECK(u64 == r64);
+  LONGS_EQUAL(0, r32);
+  LONGS_EQUAL(9, r8);
+}
+
+TEST(RamDatastreamTests, ScalarSizedEntriesNeedNotBeAligned)
+{
+  // char[4] and friends are placed without alignment; only the size looks like a scalar.
+  static const ram_datastream_entry_t entries[] = { { 1, 4 }, { 5, 2 }, { 7, 8 } };
+  const ram_datastream_config_t config = { entries, NUM_ELEMENTS(entries), NULL };
+  uint8_t packed[16] = { 0 };
+  ram_datastream_t stream;
+  ram_datastream_init(&stream, &config, packed);
+
+  const uint8_t word[4] = { 1, 2, 3, 4 };
+  const uint8_t half[2] = { 5, 6 };
+  const uint8_t wide[8] = { 7, 8, 9, 10, 11, 12, 13, 14 };
+  datastream_write(&stream.interface, 0, word);
+  datastream_write(&stream.interface, 1, half);
+  datastream_write(&stream.interface, 2, wide);
+
+  const uint8_t expected[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 0 };
+  MEMCMP_EQUAL(expected, packed, sizeof(packed));
+
+  uint8_t out[8] = { 0 };
+  datastream_read(&stream.interface, 2, out);
+  MEMCMP_EQUAL(wide, out, sizeof(wide));
+  LONGS_EQUAL(3, ram_datastream_sequence(&stream));
+  datastream_write(&stream.interface, 0, word);
+  LONGS_EQUAL(3, ram_datastream_sequence(&stream));
+}
+
+// --- zero-copy access ---
+
+TEST(RamDatastreamTests, PeekReturnsStoredBytesInPlace)
+{
+  uint32_t w = 0xCAFEF00DUL;
+  datastream_write(&ds.interface, DS_U32, &w);
+
+  const void* stored = datastream_peek(&ds.interface, DS_U32);
+  POINTERS_EQUAL((uint8_t*)&storage + g_entries[DS_U32].offset, stored);
+  MEMCMP_EQUAL(&w, stored, sizeof(w));
+}
+
+TEST(RamDatastreamTests, PeekAndAcquireReturnNullForInvalidKey)
+{
+  POINTERS_EQUAL(NULL, datastream_peek(&ds.interface, g_config.count));
+  POINTERS_EQUAL(NULL, datastream_acquire(&ds.interface, g_config.count));
+  datastream_release(&ds.interface, g_config.count); // must not crash
+}
+
+TEST(RamDatastreamTests, ReleasePublishesInPlaceMutation)
+{
+  event_subscription_t key_sub;
+  event_subscription_t all_sub;
+  int key_ctx = 1;
+  int all_ctx = 2;
+  event_subscription_init(&key_sub, mock_callback, &key_ctx);
+  event_subscription_init(&all_sub, mock_callback, &all_ctx);
+  datastream_subscribe(&ds.interface, DS_WAVEFORM, &key_sub);
+  datastream_subscribe_all(&ds.interface, &all_sub);
+
+  waveform_t* waveform = (waveform_t*)datastream_acquire(&ds.interface, DS_WAVEFORM);
+  CHECK(waveform != NULL);
+  waveform->samples[512] = 1234;
+  mock().checkExpectations(); // nothing published until release
+
+  mock().expectOneCall("callback").withPointerParameter("context", &key_ctx).ignoreOtherParameters();
+  mock().expectOneCall("callback").withPointerParameter("context", &all_ctx).ignoreOtherParameters();
+  datastream_release(&ds.interface, DS_WAVEFORM);
+  mock().checkExpectations();
+
+  const waveform_t* stored = (const waveform_t*)datastream_peek(&ds.interface, DS_WAVEFORM);
+  LONGS_EQUAL(1234, stored->samples[512]);
+}
+
+// --- ranged writes ---
+
+static void range_callback(void* context, const void* data)
+{
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  const waveform_t* waveform = (const waveform_t*)args->data;
+  mock().actualCall("on_range").withPointerParameter("context", context).withIntParameter("offset", args->offset).withIntParameter("length", args->length).withIntParameter("sample", waveform->samples[args->offset / sizeof(int16_t)]);
+}
+
+TEST(RamDatastreamTests, WriteRangePatchesSliceAndReportsIt)
+{
+  event_subscription_t sub;
+  int ctx = 1;
+  event_subscription_init(&sub, range_callback, &ctx);
+  datastream_subscribe(&ds.interface, DS_WAVEFORM, &sub);
+
+  const int16_t samples[] = { 11, 12 };
+  datastream_size_t offset = 100 * sizeof(int16_t);
+
+  mock().expectOneCall("on_range").withPointerParameter("context", &ctx).withIntParameter("offset", offset).withIntParameter("length", sizeof(samples)).withIntParameter("sample", 11);
+  datastream_write_range(&ds.interface, DS_WAVEFORM, offset, sizeof(samples), samples);
+  mock().checkExpectations();
+
+  const waveform_t* stored = (const waveform_t*)datastream_peek(&ds.interface, DS_WAVEFORM);
+  LONGS_EQUAL(0, stored->samples[99]);
+  LONGS_EQUAL(11, stored->samples[100]);
+  LONGS_EQUAL(12, stored->samples[101]);
+  LONGS_EQUAL(0, stored->samples[102]);
+}
+
+TEST(RamDatastreamTests, WriteRangeDoesNotPublishWhenSliceUnchanged)
+{
+  event_subscription_t sub;
+  int ctx = 2;
+  event_subscription_init(&sub, range_callback, &ctx);
+  datastream_subscribe(&ds.interface, DS_WAVEFORM, &sub);
+
+  const int16_t zero = 0; // storage already zero
+  datastream_write_range(&ds.interface, DS_WAVEFORM, 8, sizeof(zero), &zero);
+
+  mock().checkExpectations();
+}
+
+TEST(RamDatastreamTests, WriteRangeIgnoresRangesOutsideTheEntry)
+{
+  const uint8_t bytes[4] = { 1, 2, 3, 4 };
+
+  datastream_write_range(&ds.interface, DS_U32, 1, sizeof(bytes), bytes);
+  datastream_write_range(&ds.interface, DS_U32, 5, 1, bytes);
+  datastream_write_range(&ds.interface, g_config.count, 0, 1, bytes);
+
+  uint32_t r = 0xFF;
+  datastream_read(&ds.interface, DS_U32, &r);
+  UNSIGNED_LONGS_EQUAL(0, r);
+}
+
+TEST(RamDatastreamTests, FullWriteReportsWholeEntryAsRange)
+{
+  event_subscription_t sub;
+  int ctx = 3;
+  event_subscription_init(&sub, range_callback, &ctx);
+  datastream_subscribe(&ds.interface, DS_WAVEFORM, &sub);
+
+  static waveform_t w;
+  w.samples[0] = 5;
+
+  mock().expectOneCall("on_range").withPointerParameter("context", &ctx).withIntParameter("offset", 0).withIntParameter("length", sizeof(w)).withIntParameter("sample", 5);
+  datastream_write(&ds.interface, DS_WAVEFORM, &w);
+  mock().checkExpectations();
+}
+
+// --- versions ---
+
+TEST(RamDatastreamTests, VersionsAreZeroWithoutStorage)
+{
+  uint8_t val = 1;
+  datastream_write(&ds.interface, DS_U8, &val);
+
+  LONGS_EQUAL(0, datastream_version(&ds.interface, DS_U8));
+  LONGS_EQUAL(1, ram_datastream_sequence(&ds));
+}
+
+TEST(RamDatastreamTests, VersionAdvancesOnlyWhenValueChanges)
+{
+  RAM_DATASTREAM_VERSIONS(versions, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_version_storage(&ds, versions);
+
+  uint8_t u8 = 1;
+  uint16_t u16 = 2;
+  datastream_write(&ds.interface, DS_U8, &u8);
+  datastream_write(&ds.interface, DS_U16, &u16);
+  datastream_write(&ds.interface, DS_U8, &u8); // unchanged
+
+  LONGS_EQUAL(1, datastream_version(&ds.interface, DS_U8));
+  LONGS_EQUAL(2, datastream_version(&ds.interface, DS_U16));
+  LONGS_EQUAL(0, datastream_version(&ds.interface, DS_U32));
+  LONGS_EQUAL(0, datastream_version(&ds.interface, g_config.count));
+  LONGS_EQUAL(2, ram_datastream_sequence(&ds));
+
+  int16_t sample = 9;
+  datastream_write_range(&ds.interface, DS_WAVEFORM, 0, sizeof(sample), &sample);
+  datastream_acquire(&ds.interface, DS_U32);
+  datastream_release(&ds.interface, DS_U32);
+
+  LONGS_EQUAL(3, datastream_version(&ds.interface, DS_WAVEFORM));
+  LONGS_EQUAL(4, datastream_version(&ds.interface, DS_U32));
+}
+
+TEST(RamDatastreamTests, ChangedSinceFindsKeysWrittenAfterSequence)
+{
+  RAM_DATASTREAM_VERSIONS(versions, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_version_storage(&ds, versions);
+  bitset_t changed;
+  BITSET_STORAGE(changed_words, DATABASE_KEY_COUNT(DS_ENTRIES));
+  bitset_init(&changed, changed_words, DATABASE_KEY_COUNT(DS_ENTRIES));
+
+  uint8_t u8 = 1;
+  datastream_write(&ds.interface, DS_U8, &u8);
+  datastream_version_t seen = ram_datastream_sequence(&ds);
+
+  uint32_t u32 = 3;
+  point_t point = { .x = 1, .y = 2 };
+  datastream_write(&ds.interface, DS_U32, &u32);
+  datastream_write(&ds.interface, DS_POINT, &point);
+
+  LONGS_EQUAL(2, ram_datastream_changed_since(&ds, seen, &changed));
+  CHECK_FALSE(bitset_test(&changed, DS_U8));
+  CHECK_TRUE(bitset_test(&changed, DS_U32));
+  CHECK_TRUE(bitset_test(&changed, DS_POINT));
+
+  seen = ram_datastream_sequence(&ds);
+  LONGS_EQUAL(0, ram_datastream_changed_since(&ds, seen, &changed));
+  CHECK_TRUE(bitset_is_empty(&changed));
+}
+
+TEST(RamDatastreamTests, ChangedSinceHandlesSequenceWraparound)
+{
+  RAM_DATASTREAM_VERSIONS(versions, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_version_storage(&ds, versions);
+  bitset_t changed;
+  BITSET_STORAGE(changed_words, DATABASE_KEY_COUNT(DS_ENTRIES));
+  bitset_init(&changed, changed_words, DATABASE_KEY_COUNT(DS_ENTRIES));
+
+  ds.sequence = UINT32_MAX - 1u;
+  datastream_version_t seen = ram_datastream_sequence(&ds);
+
+  uint8_t u8 = 1;
+  uint16_t u16 = 2;
+  datastream_write(&ds.interface, DS_U8, &u8);
+  datastream_write(&ds.interface, DS_U16, &u16);
+
+  UNSIGNED_LONGS_EQUAL(UINT32_MAX, datastream_version(&ds.interface, DS_U8));
+  LONGS_EQUAL(1, datastream_version(&ds.interface, DS_U16));
+  LONGS_EQUAL(2, ram_datastream_changed_since(&ds, seen, &changed));
+}
+
 // --- subscribe_all: change detection ---
 
 TEST(RamDatastreamTests, WritePublishesAllOnChangeOnNewValue)
@@ -278,13 +591,76 @@ TEST(RamDatastreamTests, SubscribeFiresOnlyForSpecificKey)
   mock().checkExpectations();
 }
 
-TEST(RamDatastreamTests, SubscribeToInvalidKeyDoesNothing)
+TEST(RamDatastreamTests, SubscribeToInvalidKeyFails)
 {
   event_subscription_t sub;
   int ctx = 0;
   event_subscription_init(&sub, mock_callback, &ctx);
-  datastream_subscribe(&ds.interface, g_config.count, &sub);
-  // Must not crash
+  CHECK_FALSE(datastream_subscribe(&ds.interface, g_config.count, &sub));
+  LONGS_EQUAL(0, ds.subscribers.count);
+}
+
+// --- sparse subscriber table ---
+
+TEST(RamDatastreamTests, KeysOnlyTakeSubscriberSlotsWhenSubscribed)
+{
+  event_subscription_t sub1, sub2;
+  int ctx1 = 1, ctx2 = 2;
+  event_subscription_init(&sub1, mock_callback, &ctx1);
+  event_subscription_init(&sub2, mock_callback, &ctx2);
+
+  LONGS_EQUAL(0, ds.subscribers.count);
+  CHECK_TRUE(datastream_subscribe(&ds.interface, DS_POINT, &sub1));
+  CHECK_TRUE(datastream_subscribe(&ds.interface, DS_POINT, &sub2));
+  LONGS_EQUAL(1, ds.subscribers.count);
+
+  // Keys without subscribers still publish to subscribe_all and need no slot.
+  uint8_t u8 = 3;
+  datastream_write(&ds.interface, DS_U8, &u8);
+  LONGS_EQUAL(1, ds.subscribers.count);
+}
+
+TEST(RamDatastreamTests, SubscribeFailsOnceSubscriberTableIsFull)
+{
+  RAM_DATASTREAM_SUBSCRIBERS(small, 2);
+  ram_datastream_set_subscriber_storage(&ds, small_slots, small_events, 2);
+
+  event_subscription_t subs[3];
+  int ctx[3] = { 0, 1, 2 };
+  for(int i = 0; i < 3; i++) {
+    event_subscription_init(&subs[i], mock_callback, &ctx[i]);
+    CHECK_EQUAL(i < 2, datastream_subscribe(&ds.interface, (datastream_key_t)i, &subs[i]));
+  }
+  LONGS_EQUAL(2, ds.subscribers.count);
+
+  // A key that already has a slot can take more subscribers.
+  event_subscription_t more;
+  event_subscription_init(&more, mock_callback, &ctx[0]);
+  CHECK_TRUE(datastream_subscribe(&ds.interface, 0, &more));
+  datastream_unsubscribe(&ds.interface, &more);
+
+  uint32_t u32 = 1;
+  datastream_write(&ds.interface, DS_U32, &u32); // DS_U32 found no slot
+  mock().checkExpectations();
+
+  uint16_t u16 = 1;
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx[DS_U16]).ignoreOtherParameters();
+  datastream_write(&ds.interface, DS_U16, &u16);
+  mock().checkExpectations();
+}
+
+TEST(RamDatastreamTests, SubscribeFailsWithoutSubscriberTable)
+{
+  ram_datastream_init(&ds, &g_config, &storage);
+
+  event_subscription_t sub;
+  int ctx = 1;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  CHECK_FALSE(datastream_subscribe(&ds.interface, DS_U8, &sub));
+
+  uint8_t val = 1;
+  datastream_write(&ds.interface, DS_U8, &val);
+  mock().checkExpectations();
 }
 
 // --- unsubscribe ---
@@ -318,3 +694,398 @@ TEST(RamDatastreamTests, UnsubscribeStopsKeySpecificCallbacks)
 
   mock().checkExpectations(); // no calls expected
 }
+
+typedef struct {
+  i_datastream_t* datastream;
+  event_subscription_t* victim;
+  int calls;
+} unsubscribing_context_t;
+
+static void unsubscribing_callback(void* context, const void* data)
+{
+  (void)data;
+  unsubscribing_context_t* unsubscribing = (unsubscribing_context_t*)context;
+  unsubscribing->calls++;
+  if(unsubscribing->victim != NULL) {
+    datastream_unsubscribe(unsubscribing->datastream, unsubscribing->victim);
+  }
+}
+
+TEST(RamDatastreamTests, UnsubscribeFromCallbackSkipsOnlyTheRemovedKeySubscriber)
+{
+  event_subscription_t s1;
+  event_subscription_t s2;
+  event_subscription_t s3;
+  event_subscription_t other;
+  unsubscribing_context_t c1 = { &ds.interface, &s2, 0 };
+  unsubscribing_context_t c2 = { &ds.interface, nullptr, 0 };
+  unsubscribing_context_t c3 = { &ds.interface, nullptr, 0 };
+  unsubscribing_context_t other_context = { &ds.interface, nullptr, 0 };
+  event_subscription_init(&s1, unsubscribing_callback, &c1);
+  event_subscription_init(&s2, unsubscribing_callback, &c2);
+  event_subscription_init(&s3, unsubscribing_callback, &c3);
+  event_subscription_init(&other, unsubscribing_callback, &other_context);
+  datastream_subscribe(&ds.interface, DS_U16, &other);
+  datastream_subscribe(&ds.interface, DS_U8, &s1);
+  datastream_subscribe(&ds.interface, DS_U8, &s2);
+  datastream_subscribe(&ds.interface, DS_U8, &s3);
+
+  uint8_t val = 1;
+  datastream_write(&ds.interface, DS_U8, &val);
+
+  LONGS_EQUAL(1, c1.calls);
+  LONGS_EQUAL(0, c2.calls);
+  LONGS_EQUAL(1, c3.calls);
+
+  uint16_t u16 = 1;
+  datastream_write(&ds.interface, DS_U16, &u16);
+  LONGS_EQUAL(1, other_context.calls);
+}
+
+// --- deferred ---
+
+static void value_callback(void* context, const void* data)
+{
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  mock().actualCall("on_change").withPointerParameter("context", context).withIntParameter("key", args->key).withIntParameter("value", *(const uint16_t*)args->data);
+}
+
+TEST(RamDatastreamTests, DeferredWritesCoalesceUntilDrain)
+{
+  event_queue_t queue;
+  EVENT_QUEUE_ENTRIES(entries, 4);
+  EVENT_QUEUE_PAYLOAD(payload, 32);
+  event_queue_init(&queue, entries, 4, payload, sizeof(payload));
+  ram_datastream_set_deferred(&ds, &queue);
+
+  event_subscription_t key_sub;
+  event_subscription_t all_sub;
+  int key_ctx = 1;
+  int all_ctx = 2;
+  event_subscription_init(&key_sub, value_callback, &key_ctx);
+  event_subscription_init(&all_sub, value_callback, &all_ctx);
+  datastream_subscribe(&ds.interface, DS_U16, &key_sub);
+  datastream_subscribe_all(&ds.interface, &all_sub);
+
+  for(uint16_t val = 1; val <= 100; val++) {
+    datastream_write(&ds.interface, DS_U16, &val);
+  }
+  mock().checkExpectations(); // no calls before drain
+
+  mock().expectOneCall("on_change").withPointerParameter("context", &key_ctx).withIntParameter("key", DS_U16).withIntParameter("value", 100);
+  mock().expectOneCall("on_change").withPointerParameter("context", &all_ctx).withIntParameter("key", DS_U16).withIntParameter("value", 100);
+  LONGS_EQUAL(1, event_queue_drain(&queue)); // one entry carries both publishes for the key
+  mock().checkExpectations();
+}
+
+// --- static subscriptions ---
+
+static int static_u32_ctx = 9;
+
+SIERA_STATIC_SUBSCRIBE(DS_U32, mock_callback, &static_u32_ctx);
+
+DS_ENTRIES(DATABASE_EXPAND_AS_STATIC_DECLARATION)
+
+static const event_static_table_t g_static_subscriptions[] = {
+  DS_ENTRIES(DATABASE_EXPAND_AS_STATIC_TABLE)
+};
+
+TEST(RamDatastreamTests, StaticSubscriptionsFireForTheirKeyOnly)
+{
+  const ram_datastream_config_t config = {
+    .entries = g_entries,
+    .count = NUM_ELEMENTS(g_entries),
+    .static_subscriptions = g_static_subscriptions,
+  };
+  ram_datastream_init(&ds, &config, &storage);
+  ram_datastream_set_subscriber_storage(&ds, subscribers_slots, subscribers_events, 4);
+  LONGS_EQUAL(0, ds.subscribers.count); // static subscribers need no per-key event
+
+  uint16_t u16 = 1;
+  datastream_write(&ds.interface, DS_U16, &u16);
+  mock().checkExpectations(); // no static subscriber on DS_U16
+
+  uint32_t u32 = 2;
+  mock().expectOneCall("callback").withPointerParameter("context", &static_u32_ctx).ignoreOtherParameters();
+  datastream_write(&ds.interface, DS_U32, &u32);
+  mock().checkExpectations();
+}
+
+TEST(RamDatastreamTests, StaticSubscriptionsNeedNoSubscriberStorage)
+{
+  const ram_datastream_config_t config = {
+    .entries = g_entries,
+    .count = NUM_ELEMENTS(g_entries),
+    .static_subscriptions = g_static_subscriptions,
+  };
+  ram_datastream_init(&ds, &config, &storage);
+
+  uint32_t u32 = 3;
+  mock().expectOneCall("callback").withPointerParameter("context", &static_u32_ctx).ignoreOtherParameters();
+  datastream_write(&ds.interface, DS_U32, &u32);
+  mock().checkExpectations();
+}
+
+// --- batches ---
+
+static void batch_callback(void* context, const void* data)
+{
+  const datastream_on_batch_args_t* args = (const datastream_on_batch_args_t*)data;
+  mock().actualCall("on_batch").withPointerParameter("context", context).withIntParameter("count", bitset_count(args->keys)).withBoolParameter("u16", bitset_test(args->keys, DS_U16)).withBoolParameter("u32", bitset_test(args->keys, DS_U32));
+}
+
+TEST(RamDatastreamTests, BatchPublishesOncePerChangedKeyThenOneBatchEvent)
+{
+  BITSET_STORAGE(dirty, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_batch_storage(&ds, dirty);
+
+  event_subscription_t key_sub;
+  event_subscription_t batch_sub;
+  int key_ctx = 1;
+  int batch_ctx = 2;
+  event_subscription_init(&key_sub, value_callback, &key_ctx);
+  event_subscription_init(&batch_sub, batch_callback, &batch_ctx);
+  datastream_subscribe(&ds.interface, DS_U16, &key_sub);
+  datastream_subscribe_batch(&ds.interface, &batch_sub);
+
+  datastream_begin_batch(&ds.interface);
+  for(uint16_t val = 1; val <= 20; val++) {
+    datastream_write(&ds.interface, DS_U16, &val);
+  }
+  uint32_t u32 = 5;
+  datastream_write(&ds.interface, DS_U32, &u32);
+  mock().checkExpectations(); // nothing published inside the batch
+
+  mock().strictOrder();
+  mock().expectOneCall("on_change").withPointerParameter("context", &key_ctx).withIntParameter("key", DS_U16).withIntParameter("value", 20);
+  mock().expectOneCall("on_batch").withPointerParameter("context", &batch_ctx).withIntParameter("count", 2).withBoolParameter("u16", true).withBoolParameter("u32", true);
+  datastream_commit(&ds.interface);
+  mock().checkExpectations();
+
+  CHECK_TRUE(bitset_is_empty(&ds.dirty));
+}
+
+TEST(RamDatastreamTests, NestedBatchesPublishOnOutermostCommit)
+{
+  BITSET_STORAGE(dirty, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_batch_storage(&ds, dirty);
+
+  event_subscription_t sub;
+  int ctx = 3;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+
+  uint8_t val = 1;
+  datastream_begin_batch(&ds.interface);
+  datastream_begin_batch(&ds.interface);
+  datastream_write(&ds.interface, DS_U8, &val);
+  datastream_commit(&ds.interface);
+  mock().checkExpectations();
+
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).ignoreOtherParameters();
+  datastream_commit(&ds.interface);
+  mock().checkExpectations();
+}
+
+TEST(RamDatastreamTests, CommitWithoutChangesPublishesNothing)
+{
+  BITSET_STORAGE(dirty, DATABASE_KEY_COUNT(DS_ENTRIES));
+  ram_datastream_set_batch_storage(&ds, dirty);
+
+  event_subscription_t sub;
+  int ctx = 4;
+  event_subscription_init(&sub, batch_callback, &ctx);
+  datastream_subscribe_batch(&ds.interface, &sub);
+
+  uint8_t val = 0; // storage already zero
+  datastream_begin_batch(&ds.interface);
+  datastream_write(&ds.interface, DS_U8, &val);
+  datastream_commit(&ds.interface);
+  datastream_commit(&ds.interface); // unbalanced commit is ignored
+
+  mock().checkExpectations();
+}
+
+// --- snapshots ---
+
+TEST(RamDatastreamTests, SnapshotReadsValuesAsOfCapture)
+{
+  RAM_DATASTREAM_SNAPSHOT(view, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  datastream_snapshot_t snapshot;
+  ram_datastream_add_snapshot(&ds, &snapshot, &view_shadow, view_tags);
+
+  uint8_t u8 = 1;
+  point_t point = { 3, 4 };
+  datastream_write(&ds.interface, DS_U8, &u8);
+  datastream_write(&ds.interface, DS_POINT, &point);
+  ram_datastream_capture(&ds, &snapshot);
+
+  u8 = 2;
+  datastream_write(&ds.interface, DS_U8, &u8);
+  int16_t sample = 9;
+  datastream_write_range(&ds.interface, DS_WAVEFORM, 10 * sizeof(int16_t), sizeof(sample), &sample);
+  point_t* in_place = (point_t*)datastream_acquire(&ds.interface, DS_POINT);
+  in_place->x = 30;
+  datastream_release(&ds.interface, DS_POINT);
+
+  uint8_t u8_out = 0;
+  point_t point_out = { 0, 0 };
+  static waveform_t waveform_out;
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_U8, &u8_out);
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_POINT, &point_out);
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_WAVEFORM, &waveform_out);
+  BYTES_EQUAL(1, u8_out);
+  LONGS_EQUAL(3, point_out.x);
+  LONGS_EQUAL(0, waveform_out.samples[10]);
+
+  datastream_read(&ds.interface, DS_U8, &u8_out);
+  datastream_read(&ds.interface, DS_POINT, &point_out);
+  BYTES_EQUAL(2, u8_out);
+  LONGS_EQUAL(30, point_out.x);
+}
+
+TEST(RamDatastreamTests, SnapshotSavesOnlyKeysChangedAfterCapture)
+{
+  RAM_DATASTREAM_SNAPSHOT(view, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  datastream_snapshot_t snapshot;
+  memset(&view_shadow, 0xAA, sizeof(view_shadow));
+  ram_datastream_add_snapshot(&ds, &snapshot, &view_shadow, view_tags);
+  ram_datastream_capture(&ds, &snapshot);
+
+  uint32_t u32 = 5;
+  datastream_write(&ds.interface, DS_U32, &u32);
+  u32 = 6;
+  datastream_write(&ds.interface, DS_U32, &u32);
+
+  // Only the first change saved the key; everything else is still read from storage.
+  LONGS_EQUAL(0, view_shadow.DS_U32[0]);
+  BYTES_EQUAL(0xAA, view_shadow.DS_U8[0]);
+  BYTES_EQUAL(0xAA, view_shadow.DS_WAVEFORM[0]);
+
+  uint32_t out = 1;
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_U32, &out);
+  LONGS_EQUAL(0, out);
+
+  ram_datastream_capture(&ds, &snapshot);
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_U32, &out);
+  LONGS_EQUAL(6, out);
+}
+
+TEST(RamDatastreamTests, ReleasedSnapshotReadsCurrentValuesAndSavesNothing)
+{
+  RAM_DATASTREAM_SNAPSHOT(view, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  datastream_snapshot_t snapshot;
+  memset(&view_shadow, 0xAA, sizeof(view_shadow));
+  ram_datastream_add_snapshot(&ds, &snapshot, &view_shadow, view_tags);
+  ram_datastream_capture(&ds, &snapshot);
+  ram_datastream_release_snapshot(&ds, &snapshot);
+
+  uint16_t u16 = 7;
+  datastream_write(&ds.interface, DS_U16, &u16);
+
+  uint16_t out = 0;
+  ram_datastream_snapshot_read(&ds, &snapshot, DS_U16, &out);
+  LONGS_EQUAL(7, out);
+  BYTES_EQUAL(0xAA, view_shadow.DS_U16[0]);
+}
+
+TEST(RamDatastreamTests, EverySnapshotSavesItsOwnValuesAndStoresClose)
+{
+  RAM_DATASTREAM_SNAPSHOT(first, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  RAM_DATASTREAM_SNAPSHOT(second, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  datastream_snapshot_t first_snapshot;
+  datastream_snapshot_t second_snapshot;
+  ram_datastream_add_snapshot(&ds, &first_snapshot, &first_shadow, first_tags);
+  ram_datastream_add_snapshot(&ds, &second_snapshot, &second_shadow, second_tags);
+
+  ram_datastream_capture(&ds, &first_snapshot);
+  uint32_t u32 = 1;
+  datastream_write(&ds.interface, DS_U32, &u32);
+  ram_datastream_capture(&ds, &second_snapshot);
+  uint32_t* in_place = (uint32_t*)datastream_acquire(&ds.interface, DS_U32);
+  *in_place = 2;
+  datastream_release(&ds.interface, DS_U32);
+
+  uint32_t out = 9;
+  ram_datastream_snapshot_read(&ds, &first_snapshot, DS_U32, &out);
+  LONGS_EQUAL(0, out);
+  ram_datastream_snapshot_read(&ds, &second_snapshot, DS_U32, &out);
+  LONGS_EQUAL(1, out);
+
+  // Each store opened by a write or an acquire() was closed again.
+  LONGS_EQUAL(0, ds.store_depth);
+  LONGS_EQUAL(0, atomic_load(&ds.store_sequence) & 1u);
+}
+
+// Keys are always written in the order U16, WAVEFORM, U32 with the same counter, so a
+// consistent cut has U32 <= WAVEFORM <= U16, each at most one step ahead of the next.
+enum {
+  SNAPSHOT_CAPTURES = 300,
+};
+
+typedef struct {
+  ram_datastream_t* ds;
+  SIERA_ATOMIC(bool) * done;
+} snapshot_writer_t;
+
+static void* snapshot_writer(void* arg)
+{
+  snapshot_writer_t* writer = (snapshot_writer_t*)arg;
+  static waveform_t waveform;
+
+  for(uint32_t i = 1; !writer->done->load(); i++) {
+    uint16_t u16 = (uint16_t)i;
+    datastream_write(&writer->ds->interface, DS_U16, &u16);
+    for(int s = 0; s < 1024; s++) {
+      waveform.samples[s] = (int16_t)i;
+    }
+    datastream_write(&writer->ds->interface, DS_WAVEFORM, &waveform);
+    datastream_write(&writer->ds->interface, DS_U32, &i);
+  }
+
+  return nullptr;
+}
+
+TEST(RamDatastreamTests, SnapshotStaysConsistentWhileWriterRuns)
+{
+  RAM_DATASTREAM_SNAPSHOT(view, ram_storage_t, DATABASE_KEY_COUNT(DS_ENTRIES));
+  datastream_snapshot_t snapshot;
+  ram_datastream_add_snapshot(&ds, &snapshot, &view_shadow, view_tags);
+
+  SIERA_ATOMIC(bool) done;
+  done.store(false);
+  snapshot_writer_t writer = { &ds, &done };
+  pthread_t thread;
+  pthread_create(&thread, nullptr, snapshot_writer, &writer);
+
+  int inconsistent = 0;
+  static waveform_t waveform;
+  for(int c = 0; c < SNAPSHOT_CAPTURES; c++) {
+    uint32_t u32 = 0;
+    uint32_t u32_again = 0;
+    uint16_t u16 = 0;
+
+    // Yield between reads so that writes land in the middle of the snapshot.
+    ram_datastream_capture(&ds, &snapshot);
+    ram_datastream_snapshot_read(&ds, &snapshot, DS_U32, &u32);
+    sched_yield();
+    ram_datastream_snapshot_read(&ds, &snapshot, DS_WAVEFORM, &waveform);
+    sched_yield();
+    ram_datastream_snapshot_read(&ds, &snapshot, DS_U16, &u16);
+    sched_yield();
+    ram_datastream_snapshot_read(&ds, &snapshot, DS_U32, &u32_again);
+    ram_datastream_release_snapshot(&ds, &snapshot);
+
+    uint16_t w = (uint16_t)waveform.samples[0];
+    bool torn = memcmp(&waveform.samples[0], &waveform.samples[1023], sizeof(int16_t)) != 0;
+    uint16_t behind_u16 = (uint16_t)(u16 - w);
+    uint16_t behind_w = (uint16_t)(w - (uint16_t)u32);
+    if(torn || u32 != u32_again || behind_u16 > 1 || behind_w > 1) {
+      inconsistent++;
+    }
+  }
+
+  done.store(true);
+  pthread_join(thread, nullptr);
+  LONGS_EQUAL(0, inconsistent);
+}
@@ -0,0 +1,290 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <string.h>
+
+extern "C" {
+#include "event_subscription.h"
+#include "seqlock_datastream.h"
+#include "utils.h"
+}
+
+// ---------------------------------------------------------------------------
+// Schema
+// ---------------------------------------------------------------------------
+
+// Both halves are always written with the same value, so a torn read shows up as a mismatch.
+typedef struct {
+  uint64_t first;
+  uint64_t second;
+} pair_t;
+
+// Wide enough that a writer is regularly preempted mid-copy, even on a single core.
+enum {
+  FRAME_WORDS = 64,
+};
+
+typedef struct {
+  uint64_t words[FRAME_WORDS];
+} frame_t;
+
+enum {
+  SEQ_U8,
+  SEQ_PAIR,
+  SEQ_BYTES,
+  SEQ_FRAME,
+};
+
+typedef struct {
+  uint8_t u8;
+  pair_t pair;
+  uint8_t bytes[8];
+  frame_t frame;
+} seqlock_storage_t;
+
+static const ram_datastream_entry_t seqlock_entries[] = {
+  { offsetof(seqlock_storage_t, u8), sizeof(uint8_t) },
+  { offsetof(seqlock_storage_t, pair), sizeof(pair_t) },
+  { offsetof(seqlock_storage_t, bytes), 8 },
+  { offsetof(seqlock_storage_t, frame), sizeof(frame_t) },
+};
+
+static const ram_datastream_config_t seqlock_config = {
+  .entries = seqlock_entries,
+  .count = NUM_ELEMENTS(seqlock_entries),
+};
+
+static void mock_callback(void* context, const void* data)
+{
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  mock().actualCall("callback").withPointerParameter("context", context).withIntParameter("key", args->key).withIntParameter("offset", args->offset).withIntParameter("length", args->length);
+}
+
+TEST_GROUP(SeqlockDatastreamTests)
+{
+  seqlock_datastream_t ds;
+  seqlock_storage_t storage;
+  seqlock_storage_t shadow;
+  DATASTREAM_SUBSCRIBERS_STORAGE(subscribers, 2);
+
+  void setup()
+  {
+    seqlock_datastream_init(&ds, &seqlock_config, &storage, &shadow);
+    seqlock_datastream_set_subscriber_storage(&ds, subscribers_slots, subscribers_events, 2);
+  }
+
+  void teardown()
+  {
+    mock().checkExpectations();
+    mock().clear();
+  }
+};
+
+TEST(SeqlockDatastreamTests, WriteUpdatesBothCopies)
+{
+  pair_t pair = { 1, 1 };
+  datastream_write(&ds.interface, SEQ_PAIR, &pair);
+
+  pair_t out = { 0, 0 };
+  datastream_read(&ds.interface, SEQ_PAIR, &out);
+  CHECK(out.first == 1 && out.second == 1);
+  CHECK(storage.pair.first == 1 && shadow.pair.first == 1);
+  LONGS_EQUAL(0, seqlock_datastream_retries(&ds));
+}
+
+TEST(SeqlockDatastreamTests, WritePublishesOnlyOnChange)
+{
+  event_subscription_t key_sub;
+  event_subscription_t all_sub;
+  int key_ctx = 1;
+  int all_ctx = 2;
+  event_subscription_init(&key_sub, mock_callback, &key_ctx);
+  event_subscription_init(&all_sub, mock_callback, &all_ctx);
+  datastream_subscribe(&ds.interface, SEQ_U8, &key_sub);
+  datastream_subscribe_all(&ds.interface, &all_sub);
+
+  uint8_t value = 0; // already zero
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  mock().checkExpectations();
+
+  value = 5;
+  mock().expectOneCall("callback").withPointerParameter("context", &key_ctx).withIntParameter("key", SEQ_U8).withIntParameter("offset", 0).withIntParameter("length", 1);
+  mock().expectOneCall("callback").withPointerParameter("context", &all_ctx).withIntParameter("key", SEQ_U8).withIntParameter("offset", 0).withIntParameter("length", 1);
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  mock().checkExpectations();
+
+  datastream_unsubscribe(&ds.interface, &key_sub);
+  datastream_unsubscribe(&ds.interface, &all_sub);
+  value = 6;
+  datastream_write(&ds.interface, SEQ_U8, &value);
+}
+
+TEST(SeqlockDatastreamTests, WriteRangeReportsSlice)
+{
+  event_subscription_t sub;
+  int ctx = 3;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+
+  const uint8_t slice[2] = { 7, 8 };
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", SEQ_BYTES).withIntParameter("offset", 3).withIntParameter("length", 2);
+  datastream_write_range(&ds.interface, SEQ_BYTES, 3, sizeof(slice), slice);
+  mock().checkExpectations();
+
+  datastream_write_range(&ds.interface, SEQ_BYTES, 7, sizeof(slice), slice); // out of bounds
+
+  uint8_t out[8];
+  datastream_read(&ds.interface, SEQ_BYTES, out);
+  BYTES_EQUAL(0, out[2]);
+  BYTES_EQUAL(7, out[3]);
+  BYTES_EQUAL(8, out[4]);
+  BYTES_EQUAL(0, out[7]);
+}
+
+TEST(SeqlockDatastreamTests, ZeroCopyAccessIsNotOffered)
+{
+  POINTERS_EQUAL(nullptr, datastream_peek(&ds.interface, SEQ_U8));
+  POINTERS_EQUAL(nullptr, datastream_acquire(&ds.interface, SEQ_U8));
+  LONGS_EQUAL(sizeof(pair_t), datastream_size(&ds.interface, SEQ_PAIR));
+  CHECK_FALSE(datastream_contains(&ds.interface, NUM_ELEMENTS(seqlock_entries)));
+}
+
+static void mock_batch_callback(void* context, const void* data)
+{
+  const datastream_on_batch_args_t* args = (const datastream_on_batch_args_t*)data;
+  mock().actualCall("batch").withPointerParameter("context", context).withIntParameter("count", bitset_count(args->keys));
+}
+
+TEST(SeqlockDatastreamTests, BatchDefersNotificationsButNotValues)
+{
+  BITSET_STORAGE(dirty, NUM_ELEMENTS(seqlock_entries));
+  seqlock_datastream_set_batch_storage(&ds, dirty);
+
+  event_subscription_t sub;
+  event_subscription_t batch_sub;
+  int ctx = 4;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  event_subscription_init(&batch_sub, mock_batch_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+  datastream_subscribe_batch(&ds.interface, &batch_sub);
+
+  datastream_begin_batch(&ds.interface);
+  uint8_t value = 1;
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  value = 2;
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  const uint8_t slice[2] = { 7, 8 };
+  datastream_write_range(&ds.interface, SEQ_BYTES, 3, sizeof(slice), slice);
+
+  uint8_t out = 0;
+  datastream_read(&ds.interface, SEQ_U8, &out);
+  BYTES_EQUAL(2, out);
+  mock().checkExpectations();
+
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", SEQ_U8).withIntParameter("offset", 0).withIntParameter("length", 1);
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", SEQ_BYTES).withIntParameter("offset", 0).withIntParameter("length", 8);
+  mock().expectOneCall("batch").withPointerParameter("context", &ctx).withIntParameter("count", 2);
+  datastream_commit(&ds.interface);
+}
+
+TEST(SeqlockDatastreamTests, BatchWithoutStoragePublishesImmediately)
+{
+  event_subscription_t sub;
+  int ctx = 5;
+  event_subscription_init(&sub, mock_callback, &ctx);
+  datastream_subscribe_all(&ds.interface, &sub);
+
+  datastream_begin_batch(&ds.interface);
+  uint8_t value = 1;
+  mock().expectOneCall("callback").withPointerParameter("context", &ctx).withIntParameter("key", SEQ_U8).withIntParameter("offset", 0).withIntParameter("length", 1);
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  mock().checkExpectations();
+  datastream_commit(&ds.interface);
+}
+
+TEST(SeqlockDatastreamTests, VersionsFollowChanges)
+{
+  datastream_version_t versions[NUM_ELEMENTS(seqlock_entries)];
+  LONGS_EQUAL(0, datastream_version(&ds.interface, SEQ_U8));
+  seqlock_datastream_set_version_storage(&ds, versions);
+
+  uint8_t value = 1;
+  datastream_write(&ds.interface, SEQ_U8, &value);
+  pair_t pair = { 1, 1 };
+  datastream_write(&ds.interface, SEQ_PAIR, &pair);
+  datastream_write(&ds.interface, SEQ_U8, &value); // unchanged
+
+  LONGS_EQUAL(1, datastream_version(&ds.interface, SEQ_U8));
+  LONGS_EQUAL(2, datastream_version(&ds.interface, SEQ_PAIR));
+  LONGS_EQUAL(0, datastream_version(&ds.interface, SEQ_FRAME));
+  LONGS_EQUAL(0, datastream_version(&ds.interface, NUM_ELEMENTS(seqlock_entries)));
+}
+
+// ---------------------------------------------------------------------------
+// One writer, concurrent readers
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_READERS = 3,
+  STRESS_WRITES = 200000,
+};
+
+typedef struct {
+  seqlock_datastream_t* ds;
+  SIERA_ATOMIC(bool) * done;
+  uint32_t torn;
+  uint32_t regressions;
+} stress_reader_t;
+
+static void* stress_reader(void* arg)
+{
+  stress_reader_t* reader = (stress_reader_t*)arg;
+  uint64_t last = 0;
+
+  while(!reader->done->load()) {
+    frame_t frame;
+    datastream_read(&reader->ds->interface, SEQ_FRAME, &frame);
+    for(int w = 1; w < FRAME_WORDS; w++) {
+      if(frame.words[w] != frame.words[0]) {
+        reader->torn++;
+        break;
+      }
+    }
+    if(frame.words[0] < last) {
+      reader->regressions++;
+    }
+    last = frame.words[0];
+  }
+
+  return nullptr;
+}
+
+TEST(SeqlockDatastreamTests, StressReadersNeverSeeTornOrOlderValues)
+{
+  SIERA_ATOMIC(bool) done;
+  done.store(false);
+  stress_reader_t readers[STRESS_READERS];
+  pthread_t threads[STRESS_READERS];
+
+  for(int r = 0; r < STRESS_READERS; r++) {
+    readers[r] = { &ds, &done, 0, 0 };
+    pthread_create(&threads[r], nullptr, stress_reader, &readers[r]);
+  }
+
+  for(uint64_t i = 1; i <= STRESS_WRITES; i++) {
+    frame_t frame;
+    for(int w = 0; w < FRAME_WORDS; w++) {
+      frame.words[w] = i;
+    }
+    datastream_write(&ds.interface, SEQ_FRAME, &frame);
+  }
+  done.store(true);
+
+  for(int r = 0; r < STRESS_READERS; r++) {
+    pthread_join(threads[r], nullptr);
+    LONGS_EQUAL(0, readers[r].torn);
+    LONGS_EQUAL(0, readers[r].regressions);
+  }
+}
@@ -32,7 +32,7 @@ TEST_GROUP(EventTests)
 
 TEST(EventTests, init_creates_empty_subscriber_list)
 {
-  CHECK_TRUE(list_is_empty(&event.subscribers));
+  CHECK_TRUE(dlist_is_empty(&event.subscribers));
 }
 
 TEST(EventTests, subscribe_adds_subscription_to_list)
@@ -41,7 +41,7 @@ TEST(EventTests, subscribe_adds_subscription_to_list)
 
   event_subscribe(&event, &subscription);
 
-  CHECK_FALSE(list_is_empty(&event.subscribers));
+  CHECK_FALSE(dlist_is_empty(&event.subscribers));
 }
 
 TEST(EventTests, unsubscribe_removes_subscription_from_list)
@@ -51,7 +51,7 @@ TEST(EventTests, unsubscribe_removes_subscription_from_list)
 
   event_unsubscribe(&event, &subscription);
 
-  CHECK_TRUE(list_is_empty(&event.subscribers));
+  CHECK_TRUE(dlist_is_empty(&event.subscribers));
 }
 
 TEST(EventTests, publish_calls_subscriber_callback)
@@ -167,3 +167,622 @@ TEST(EventTests, unsubscribe_one_of_multiple_subscribers)
 
   mock().checkExpectations();
 }
+
+// ---------------------------------------------------------------------------
+// Reentrancy: subscribe/unsubscribe from inside callbacks
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  event_t* event;
+  event_subscription_t* target;
+  event_subscription_t* self;
+} reentrant_context_t;
+
+static void unsubscribe_target_callback(void* context, const void* data)
+{
+  (void)data;
+  reentrant_context_t* ctx = (reentrant_context_t*)context;
+  mock().actualCall("reentrant").withPointerParameter("self", ctx->self);
+  event_unsubscribe(ctx->event, ctx->target);
+}
+
+static void subscribe_target_callback(void* context, const void* data)
+{
+  (void)data;
+  reentrant_context_t* ctx = (reentrant_context_t*)context;
+  mock().actualCall("reentrant").withPointerParameter("self", ctx->self);
+  event_subscribe(ctx->event, ctx->target);
+}
+
+static void record_callback(void* context, const void* data)
+{
+  (void)data;
+  mock().actualCall("reentrant").withPointerParameter("self", context);
+}
+
+TEST(EventTests, subscriber_can_unsubscribe_itself_during_publish)
+{
+  event_subscription_t subscription3;
+  reentrant_context_t ctx = { &event, &subscription, &subscription };
+  event_subscription_init(&subscription, unsubscribe_target_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscription_init(&subscription3, record_callback, &subscription3);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &subscription2);
+  event_subscribe(&event, &subscription3);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription3);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription3);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, unsubscribing_a_later_subscriber_during_publish_skips_it)
+{
+  event_subscription_t subscription3;
+  reentrant_context_t ctx = { &event, &subscription2, &subscription };
+  event_subscription_init(&subscription, unsubscribe_target_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscription_init(&subscription3, record_callback, &subscription3);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &subscription2);
+  event_subscribe(&event, &subscription3);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription3);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, unsubscribing_the_last_subscriber_during_publish_skips_it)
+{
+  reentrant_context_t ctx = { &event, &subscription2, &subscription };
+  event_subscription_init(&subscription, unsubscribe_target_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &subscription2);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, subscriber_added_during_publish_is_called_from_the_next_publish)
+{
+  reentrant_context_t ctx = { &event, &subscription2, &subscription };
+  event_subscription_init(&subscription, subscribe_target_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscribe(&event, &subscription);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+
+  event_unsubscribe(&event, &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription2);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+static int nested_depth;
+
+static void nested_publish_callback(void* context, const void* data)
+{
+  (void)data;
+  reentrant_context_t* ctx = (reentrant_context_t*)context;
+  mock().actualCall("reentrant").withPointerParameter("self", ctx->self);
+  if(nested_depth++ == 0) {
+    event_publish(ctx->event, nullptr);
+    event_unsubscribe(ctx->event, ctx->target);
+  }
+}
+
+TEST(EventTests, unsubscribe_after_nested_publish_updates_outer_dispatch)
+{
+  reentrant_context_t ctx = { &event, &subscription2, &subscription };
+  nested_depth = 0;
+  event_subscription_init(&subscription, nested_publish_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &subscription2);
+
+  // Outer publish calls subscription, which publishes again (both called), then removes
+  // subscription2 before the outer publish reaches it.
+  mock().expectNCalls(2, "reentrant").withPointerParameter("self", &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription2);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+  POINTERS_EQUAL(nullptr, event.dispatch);
+}
+
+// ---------------------------------------------------------------------------
+// Priority bands and stop propagation
+// ---------------------------------------------------------------------------
+
+static event_propagation_t stopping_handler(void* context, const void* data)
+{
+  (void)data;
+  mock().actualCall("reentrant").withPointerParameter("self", context);
+  return EVENT_STOP;
+}
+
+static event_propagation_t continuing_handler(void* context, const void* data)
+{
+  (void)data;
+  mock().actualCall("reentrant").withPointerParameter("self", context);
+  return EVENT_CONTINUE;
+}
+
+#ifdef SIERA_EVENT_PRIORITY
+TEST(EventTests, subscribers_run_in_priority_order_then_subscription_order)
+{
+  event_subscription_t low;
+  event_subscription_t normal1;
+  event_subscription_t normal2;
+  event_subscription_t critical;
+  event_subscription_t high;
+  event_subscription_init(&low, record_callback, &low);
+  event_subscription_init(&normal1, record_callback, &normal1);
+  event_subscription_init(&normal2, record_callback, &normal2);
+  event_subscription_init(&critical, record_callback, &critical);
+  event_subscription_init(&high, record_callback, &high);
+  event_subscription_set_priority(&low, EVENT_PRIORITY_LOW);
+  event_subscription_set_priority(&critical, EVENT_PRIORITY_CRITICAL);
+  event_subscription_set_priority(&high, EVENT_PRIORITY_HIGH);
+
+  event_subscribe(&event, &low);
+  event_subscribe(&event, &normal1);
+  event_subscribe(&event, &critical);
+  event_subscribe(&event, &normal2);
+  event_subscribe(&event, &high);
+
+  mock().strictOrder();
+  mock().expectOneCall("reentrant").withPointerParameter("self", &critical);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &normal1);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &normal2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &low);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, unsubscribing_a_band_tail_keeps_band_order)
+{
+  event_subscription_t high1;
+  event_subscription_t high2;
+  event_subscription_t high3;
+  event_subscription_init(&high1, record_callback, &high1);
+  event_subscription_init(&high2, record_callback, &high2);
+  event_subscription_init(&high3, record_callback, &high3);
+  event_subscription_init(&subscription, record_callback, &subscription);
+  event_subscription_set_priority(&high1, EVENT_PRIORITY_HIGH);
+  event_subscription_set_priority(&high2, EVENT_PRIORITY_HIGH);
+  event_subscription_set_priority(&high3, EVENT_PRIORITY_HIGH);
+
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &high1);
+  event_subscribe(&event, &high2);
+  event_unsubscribe(&event, &high2);
+  event_subscribe(&event, &high3);
+
+  mock().strictOrder();
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high1);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high3);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, unsubscribing_another_events_subscriber_changes_neither_event)
+{
+  event_t other;
+  event_subscription_t high1;
+  event_subscription_t high2;
+  event_subscription_t high3;
+  event_subscription_t other1;
+  event_subscription_t other2;
+  event_subscription_t other3;
+  event_init(&other);
+  event_subscription_init(&high1, record_callback, &high1);
+  event_subscription_init(&high2, record_callback, &high2);
+  event_subscription_init(&high3, record_callback, &high3);
+  event_subscription_init(&other1, record_callback, &other1);
+  event_subscription_init(&other2, record_callback, &other2);
+  event_subscription_init(&other3, record_callback, &other3);
+  event_subscription_set_priority(&high1, EVENT_PRIORITY_HIGH);
+  event_subscription_set_priority(&high2, EVENT_PRIORITY_HIGH);
+  event_subscription_set_priority(&high3, EVENT_PRIORITY_HIGH);
+  event_subscription_set_priority(&other2, EVENT_PRIORITY_HIGH);
+
+  event_subscribe(&event, &high1);
+  event_subscribe(&event, &high2);
+  event_subscribe(&other, &other1);
+  event_subscribe(&other, &other2);
+  event_subscribe(&other, &other3);
+
+  event_unsubscribe(&event, &other2);
+  event_subscribe(&event, &high3);
+
+  mock().strictOrder();
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high1);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &high3);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &other2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &other1);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &other3);
+  event_publish(&other, nullptr);
+  mock().checkExpectations();
+}
+#else
+TEST(EventTests, subscribers_run_in_subscription_order_without_priority_bands)
+{
+  event_subscription_t low;
+  event_subscription_t critical;
+  event_subscription_init(&low, record_callback, &low);
+  event_subscription_init(&critical, record_callback, &critical);
+  event_subscription_set_priority(&low, EVENT_PRIORITY_LOW);
+  event_subscription_set_priority(&critical, EVENT_PRIORITY_CRITICAL);
+
+  event_subscribe(&event, &low);
+  event_subscribe(&event, &critical);
+
+  mock().strictOrder();
+  mock().expectOneCall("reentrant").withPointerParameter("self", &low);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &critical);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+#endif
+
+TEST(EventTests, handler_returning_stop_skips_remaining_subscribers)
+{
+  event_subscription_t interlock;
+  event_subscription_init_handler(&interlock, stopping_handler, &interlock);
+  event_subscription_set_priority(&interlock, EVENT_PRIORITY_CRITICAL);
+  event_subscription_init(&subscription, record_callback, &subscription);
+
+#ifdef SIERA_EVENT_PRIORITY
+  // The critical band runs the interlock first even though it subscribed last.
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &interlock);
+#else
+  event_subscribe(&event, &interlock);
+  event_subscribe(&event, &subscription);
+#endif
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &interlock);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+  POINTERS_EQUAL(nullptr, event.dispatch);
+}
+
+TEST(EventTests, handler_returning_continue_runs_remaining_subscribers)
+{
+  event_subscription_t handler;
+  event_subscription_init_handler(&handler, continuing_handler, &handler);
+  event_subscription_init(&subscription, record_callback, &subscription);
+
+  event_subscribe(&event, &handler);
+  event_subscribe(&event, &subscription);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &handler);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, subscriber_inserted_ahead_of_cursor_during_publish_waits_for_next_publish)
+{
+  event_subscription_t low;
+  reentrant_context_t ctx = { &event, &subscription2, &subscription };
+  event_subscription_init(&subscription, subscribe_target_callback, &ctx);
+  event_subscription_init(&subscription2, record_callback, &subscription2);
+  event_subscription_init(&low, record_callback, &low);
+  event_subscription_set_priority(&subscription, EVENT_PRIORITY_CRITICAL);
+  event_subscription_set_priority(&low, EVENT_PRIORITY_LOW);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &low);
+
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &low);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+
+  // subscription2 now sits between the running subscriber and low.
+  event_unsubscribe(&event, &subscription);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &subscription2);
+  mock().expectOneCall("reentrant").withPointerParameter("self", &low);
+  event_publish(&event, nullptr);
+  mock().checkExpectations();
+}
+
+// ---------------------------------------------------------------------------
+// Static (link-time) subscriptions
+// ---------------------------------------------------------------------------
+
+static int static_context1 = 1;
+static int static_context2 = 2;
+
+SIERA_STATIC_SUBSCRIBE(static_event, mock_callback, &static_context1);
+SIERA_STATIC_SUBSCRIBE(static_event, mock_callback, &static_context2);
+
+SIERA_STATIC_SUBSCRIPTIONS_DECLARE(static_event);
+SIERA_STATIC_SUBSCRIPTIONS_DECLARE(unused_static_event);
+
+TEST(EventTests, static_subscriptions_are_collected_per_tag)
+{
+  event_static_table_t table = SIERA_STATIC_SUBSCRIPTIONS(static_event);
+  LONGS_EQUAL(2, table.end - table.begin);
+
+  event_static_table_t empty = SIERA_STATIC_SUBSCRIPTIONS(unused_static_event);
+  LONGS_EQUAL(0, empty.end - empty.begin);
+}
+
+TEST(EventTests, static_subscribers_run_before_dynamic_ones_of_their_band)
+{
+  event_static_table_t table = SIERA_STATIC_SUBSCRIPTIONS(static_event);
+  int critical_context = 3;
+  int low_context = 4;
+  event_subscription_init(&subscription, mock_callback, &critical_context);
+  event_subscription_set_priority(&subscription, EVENT_PRIORITY_CRITICAL);
+  event_subscription_init(&subscription2, mock_callback, &low_context);
+  event_subscription_set_priority(&subscription2, EVENT_PRIORITY_LOW);
+  event_subscribe(&event, &subscription);
+  event_subscribe(&event, &subscription2);
+
+  mock().expectOneCall("callback").withPointerParameter("context", &static_context1).withConstPointerParameter("data", (const void*)nullptr);
+  mock().expectOneCall("callback").withPointerParameter("context", &static_context2).withConstPointerParameter("data", (const void*)nullptr);
+  mock().expectOneCall("callback").withPointerParameter("context", &critical_context).withConstPointerParameter("data", (const void*)nullptr);
+  mock().expectOneCall("callback").withPointerParameter("context", &low_context).withConstPointerParameter("data", (const void*)nullptr);
+  event_publish_with(&event, &table, nullptr);
+  mock().checkExpectations();
+
+  // The static subscribers are in the normal band, whatever order the linker chose.
+  mock().clear();
+  mock().strictOrder();
+#ifdef SIERA_EVENT_PRIORITY
+  mock().expectOneCall("callback").withPointerParameter("context", &critical_context).withConstPointerParameter("data", (const void*)nullptr);
+  mock().expectNCalls(2, "callback").ignoreOtherParameters();
+#else
+  mock().expectNCalls(2, "callback").ignoreOtherParameters();
+  mock().expectOneCall("callback").withPointerParameter("context", &critical_context).withConstPointerParameter("data", (const void*)nullptr);
+#endif
+  mock().expectOneCall("callback").withPointerParameter("context", &low_context).withConstPointerParameter("data", (const void*)nullptr);
+  event_publish_with(&event, &table, nullptr);
+  mock().checkExpectations();
+}
+
+static int static_interlock_context = 5;
+
+SIERA_STATIC_SUBSCRIBE_HANDLER(stopping_static_event, EVENT_PRIORITY_HIGH, stopping_handler, &static_interlock_context);
+
+SIERA_STATIC_SUBSCRIPTIONS_DECLARE(stopping_static_event);
+
+TEST(EventTests, static_handler_returning_stop_skips_remaining_subscribers)
+{
+  event_static_table_t table = SIERA_STATIC_SUBSCRIPTIONS(stopping_static_event);
+  event_subscription_t critical;
+  event_subscription_init(&critical, record_callback, &critical);
+  event_subscription_set_priority(&critical, EVENT_PRIORITY_CRITICAL);
+  event_subscription_init(&subscription, record_callback, &subscription);
+  event_subscribe(&event, &critical);
+  event_subscribe(&event, &subscription);
+
+  mock().strictOrder();
+#ifdef SIERA_EVENT_PRIORITY
+  mock().expectOneCall("reentrant").withPointerParameter("self", &critical);
+#endif
+  mock().expectOneCall("reentrant").withPointerParameter("self", &static_interlock_context);
+  event_publish_with(&event, &table, nullptr);
+  mock().checkExpectations();
+  POINTERS_EQUAL(nullptr, event.dispatch);
+}
+
+TEST(EventTests, publish_without_event_runs_only_static_subscribers)
+{
+  event_static_table_t table = SIERA_STATIC_SUBSCRIPTIONS(static_event);
+
+  mock().expectOneCall("callback").withPointerParameter("context", &static_context1).withConstPointerParameter("data", (const void*)&table);
+  mock().expectOneCall("callback").withPointerParameter("context", &static_context2).withConstPointerParameter("data", (const void*)&table);
+  event_publish_with(nullptr, &table, &table);
+  mock().checkExpectations();
+}
+
+static event_t published_static_event;
+static int published_static_context = 6;
+
+SIERA_STATIC_SUBSCRIBE(published_static_event, mock_callback, &published_static_context);
+
+TEST(EventTests, publish_macro_dispatches_the_events_own_static_table)
+{
+  int dynamic_context = 7;
+  event_init(&published_static_event);
+  event_subscription_init(&subscription, mock_callback, &dynamic_context);
+  event_subscribe(&published_static_event, &subscription);
+
+  mock().expectOneCall("callback").withPointerParameter("context", &published_static_context).withConstPointerParameter("data", (const void*)nullptr);
+  mock().expectOneCall("callback").withPointerParameter("context", &dynamic_context).withConstPointerParameter("data", (const void*)nullptr);
+  SIERA_EVENT_PUBLISH(published_static_event, nullptr);
+  mock().checkExpectations();
+}
+
+TEST(EventTests, event_without_static_table_has_no_static_subscribers)
+{
+  event_publish(&event, nullptr);
+
+  mock().checkExpectations();
+}
+
+// ---------------------------------------------------------------------------
+// Reentrancy stress: random subscribe/unsubscribe/nested publish from callbacks
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_SUBSCRIBERS = 32,
+  STRESS_PUBLISHES = 20000,
+  STRESS_MAX_DEPTH = 3,
+};
+
+typedef struct {
+  event_t event;
+  event_subscription_t subscriptions[STRESS_SUBSCRIBERS];
+  bool subscribed[STRESS_SUBSCRIBERS];
+  uint32_t rng;
+  int depth;
+  // Per nesting depth: who was subscribed at publish start, who was removed since, and
+  // how often each subscriber ran.
+  bool at_start[STRESS_MAX_DEPTH][STRESS_SUBSCRIBERS];
+  bool removed[STRESS_MAX_DEPTH][STRESS_SUBSCRIBERS];
+  int calls[STRESS_MAX_DEPTH][STRESS_SUBSCRIBERS];
+  int violations;
+} stress_t;
+
+static stress_t stress;
+
+static uint32_t stress_random(void)
+{
+  stress.rng ^= stress.rng << 13;
+  stress.rng ^= stress.rng >> 17;
+  stress.rng ^= stress.rng << 5;
+  return stress.rng;
+}
+
+static void stress_unsubscribe(int i)
+{
+  event_unsubscribe(&stress.event, &stress.subscriptions[i]);
+  stress.subscribed[i] = false;
+  for(int d = 0; d < stress.depth; d++) {
+    stress.removed[d][i] = true;
+  }
+}
+
+static void stress_subscribe(int i)
+{
+  if(!stress.subscribed[i]) {
+    event_subscribe(&stress.event, &stress.subscriptions[i]);
+    stress.subscribed[i] = true;
+  }
+}
+
+static void stress_publish(void)
+{
+  int d = stress.depth++;
+  for(int i = 0; i < STRESS_SUBSCRIBERS; i++) {
+    stress.at_start[d][i] = stress.subscribed[i];
+    stress.removed[d][i] = false;
+    stress.calls[d][i] = 0;
+  }
+
+  event_publish(&stress.event, nullptr);
+
+  for(int i = 0; i < STRESS_SUBSCRIBERS; i++) {
+    int expected_max = stress.at_start[d][i] ? 1 : 0;
+    int expected_min = (stress.at_start[d][i] && !stress.removed[d][i]) ? 1 : 0;
+    if(stress.calls[d][i] < expected_min || stress.calls[d][i] > expected_max) {
+      stress.violations++;
+    }
+  }
+  stress.depth--;
+}
+
+static void stress_callback(void* context, const void* data)
+{
+  (void)data;
+  int self = (int)(intptr_t)context;
+  stress.calls[stress.depth - 1][self]++;
+
+  uint32_t r = stress_random();
+  int other = (int)((r >> 8) % STRESS_SUBSCRIBERS);
+
+  switch(r % 8) {
+    case 0:
+      stress_unsubscribe(self);
+      break;
+    case 1:
+    case 2:
+      stress_unsubscribe(other);
+      break;
+    case 3:
+    case 4:
+      stress_subscribe(other);
+      break;
+    case 5:
+      if(stress.depth < STRESS_MAX_DEPTH) {
+        stress_publish();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+static bool stress_list_is_consistent(void)
+{
+  int count = 0;
+  dlist_node_t* prev = NULL;
+  dlist_for_each(&stress.event.subscribers, node)
+  {
+    if(node->prev != prev) {
+      return false;
+    }
+
+#ifdef SIERA_EVENT_PRIORITY
+    // Bands stay sorted and each band tail is the last node of its band.
+    uint8_t priority = ((event_subscription_t*)node)->priority;
+    if(prev != NULL && ((event_subscription_t*)prev)->priority > priority) {
+      return false;
+    }
+    bool is_band_tail = node->next == NULL || ((event_subscription_t*)node->next)->priority != priority;
+    if(is_band_tail != (stress.event.band_tail[priority] == node)) {
+      return false;
+    }
+#endif
+
+    prev = node;
+    count++;
+  }
+  if(stress.event.subscribers.tail != prev) {
+    return false;
+  }
+
+  int expected = 0;
+  for(int i = 0; i < STRESS_SUBSCRIBERS; i++) {
+    expected += stress.subscribed[i] ? 1 : 0;
+  }
+  return count == expected;
+}
+
+TEST(EventTests, stress_mutating_subscriptions_from_callbacks)
+{
+  stress.rng = 0xC0FFEEu;
+  stress.depth = 0;
+  stress.violations = 0;
+  event_init(&stress.event);
+
+  for(int i = 0; i < STRESS_SUBSCRIBERS; i++) {
+    event_subscription_init(&stress.subscriptions[i], stress_callback, (void*)(intptr_t)i);
+    event_subscription_set_priority(&stress.subscriptions[i], (event_priority_t)(i % EVENT_PRIORITY_COUNT));
+    stress.subscribed[i] = false;
+    stress_subscribe(i);
+  }
+
+  for(int n = 0; n < STRESS_PUBLISHES; n++) {
+    stress_publish();
+    CHECK_TRUE(stress_list_is_consistent());
+
+    // Keep the population from draining away.
+    stress_subscribe((int)(stress_random() % STRESS_SUBSCRIBERS));
+  }
+
+  LONGS_EQUAL(0, stress.violations);
+  POINTERS_EQUAL(nullptr, stress.event.dispatch);
+}
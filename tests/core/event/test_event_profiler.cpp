@@ -0,0 +1,168 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" {
+#include "event.h"
+#include "event_profiler.h"
+#include "event_subscription.h"
+}
+
+#ifdef SIERA_EVENT_PROFILING
+
+typedef struct {
+  i_event_profiler_clock_t interface;
+  event_profiler_ticks_t ticks;
+} fake_clock_t;
+
+static fake_clock_t fake_clock;
+
+static event_profiler_ticks_t fake_now(i_event_profiler_clock_t* instance)
+{
+  return ((fake_clock_t*)instance)->ticks;
+}
+
+// Each callback "costs" the number of ticks passed as its context.
+static void costly_callback(void* context, const void* data)
+{
+  (void)data;
+  fake_clock.ticks += (event_profiler_ticks_t)(uintptr_t)context;
+}
+
+TEST_GROUP(EventProfilerTests)
+{
+  event_t event;
+  event_t event2;
+  event_subscription_t cheap;
+  event_subscription_t expensive;
+  event_subscription_t medium;
+
+  void setup()
+  {
+    fake_clock.interface.now = fake_now;
+    fake_clock.ticks = 0xFFFFFFF0u;
+    event_profiler_set_clock(&fake_clock.interface);
+    event_profiler_reset();
+
+    event_init(&event);
+    event_init(&event2);
+    event_subscription_init(&cheap, costly_callback, (void*)(uintptr_t)1);
+    event_subscription_init(&expensive, costly_callback, (void*)(uintptr_t)100);
+    event_subscription_init(&medium, costly_callback, (void*)(uintptr_t)10);
+  }
+
+  void teardown()
+  {
+    event_profiler_set_clock(nullptr);
+    event_profiler_reset();
+  }
+};
+
+TEST(EventProfilerTests, CountsPublishesAndFanOut)
+{
+  event_subscribe(&event, &cheap);
+  event_subscribe(&event, &medium);
+
+  event_publish(&event, nullptr);
+  event_unsubscribe(&event, &medium);
+  event_publish(&event, nullptr);
+
+  LONGS_EQUAL(2, event.profile.publish_count);
+  LONGS_EQUAL(3, event.profile.callback_count);
+  LONGS_EQUAL(2, event.profile.max_fan_out);
+}
+
+TEST(EventProfilerTests, RecordsCumulativeAndMaxCallbackTicksAcrossClockWrap)
+{
+  event_subscribe(&event, &medium);
+
+  event_publish(&event, nullptr);
+  medium.context = (void*)(uintptr_t)25;
+  event_publish(&event, nullptr);
+
+  LONGS_EQUAL(2, medium.profile.call_count);
+  LONGS_EQUAL(35, (long)medium.profile.total_ticks);
+  LONGS_EQUAL(25, medium.profile.max_ticks);
+}
+
+TEST(EventProfilerTests, TopListsMostExpensiveSubscribersFirst)
+{
+  event_subscribe(&event, &cheap);
+  event_subscribe(&event, &expensive);
+  event_subscribe(&event2, &medium);
+
+  event_publish(&event, nullptr);
+  event_publish(&event2, nullptr);
+
+  event_profiler_entry_t top[2];
+  LONGS_EQUAL(2, event_profiler_top(top, 2));
+
+  POINTERS_EQUAL(&expensive, top[0].subscription);
+  LONGS_EQUAL(100, (long)top[0].profile.total_ticks);
+  POINTERS_EQUAL(&medium, top[1].subscription);
+  POINTERS_EQUAL((void*)(uintptr_t)10, top[1].context);
+}
+
+TEST(EventProfilerTests, TopKeepsOnlyTheMostExpensiveWhenFull)
+{
+  event_subscription_t subscriptions[EVENT_PROFILER_TOP_N + 1];
+
+  for(uintptr_t i = 0; i < EVENT_PROFILER_TOP_N + 1; i++) {
+    event_subscription_init(&subscriptions[i], costly_callback, (void*)(i + 1));
+    event_subscribe(&event, &subscriptions[i]);
+  }
+  event_publish(&event, nullptr);
+
+  event_profiler_entry_t top[EVENT_PROFILER_TOP_N + 1];
+  LONGS_EQUAL(EVENT_PROFILER_TOP_N, event_profiler_top(top, EVENT_PROFILER_TOP_N + 1));
+  POINTERS_EQUAL(&subscriptions[EVENT_PROFILER_TOP_N], top[0].subscription);
+  POINTERS_EQUAL(&subscriptions[1], top[EVENT_PROFILER_TOP_N - 1].subscription);
+}
+
+TEST(EventProfilerTests, CountsWithoutClock)
+{
+  event_profiler_set_clock(nullptr);
+  event_subscribe(&event, &expensive);
+
+  event_publish(&event, nullptr);
+
+  LONGS_EQUAL(1, expensive.profile.call_count);
+  LONGS_EQUAL(0, (long)expensive.profile.total_ticks);
+}
+
+typedef struct {
+  event_t* event;
+  event_subscription_t* self;
+} freeing_context_t;
+
+// Stands in for a subscriber that unsubscribes and frees itself: the poison would be
+// overwritten if the publish recorded into the subscription afterwards.
+static void free_self_callback(void* context, const void* data)
+{
+  (void)data;
+  freeing_context_t* freeing = (freeing_context_t*)context;
+  event_unsubscribe(freeing->event, freeing->self);
+  memset(freeing->self, 0xAA, sizeof(*freeing->self));
+}
+
+TEST(EventProfilerTests, SubscriberThatFreesItselfIsNotRecorded)
+{
+  event_subscription_t doomed;
+  freeing_context_t freeing = { &event, &doomed };
+  event_subscription_init(&doomed, free_self_callback, &freeing);
+  event_subscribe(&event, &doomed);
+  event_subscribe(&event, &cheap);
+
+  event_publish(&event, nullptr);
+
+  event_subscription_t poison;
+  memset(&poison, 0xAA, sizeof(poison));
+  MEMCMP_EQUAL(&poison, &doomed, sizeof(doomed));
+  LONGS_EQUAL(1, cheap.profile.call_count);
+
+  event_profiler_entry_t top[EVENT_PROFILER_TOP_N];
+  LONGS_EQUAL(1, event_profiler_top(top, EVENT_PROFILER_TOP_N));
+  POINTERS_EQUAL(&cheap, top[0].subscription);
+}
+
+#endif
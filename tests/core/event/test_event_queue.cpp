@@ -0,0 +1,168 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+extern "C" {
+#include "event.h"
+#include "event_queue.h"
+#include "event_subscription.h"
+}
+
+static void value_callback(void* context, const void* data)
+{
+  mock().actualCall("callback").withPointerParameter("context", context).withIntParameter("value", *(const uint32_t*)data);
+}
+
+TEST_GROUP(EventQueueTests)
+{
+  event_queue_t queue;
+  EVENT_QUEUE_ENTRIES(entries, 4);
+  EVENT_QUEUE_PAYLOAD(payload, 32);
+  event_t event;
+  event_t event2;
+  event_subscription_t subscription;
+  event_subscription_t subscription2;
+
+  void setup()
+  {
+    event_queue_init(&queue, entries, 4, payload, sizeof(payload));
+    event_init(&event);
+    event_init(&event2);
+    event_subscription_init(&subscription, value_callback, &event);
+    event_subscription_init(&subscription2, value_callback, &event2);
+    event_subscribe(&event, &subscription);
+    event_subscribe(&event2, &subscription2);
+  }
+
+  void teardown()
+  {
+    mock().clear();
+  }
+
+  void publish(event_t* target, uint16_t key, uint32_t value)
+  {
+    CHECK_TRUE(event_queue_publish(&queue, target, key, &value, sizeof(value)));
+  }
+};
+
+TEST(EventQueueTests, PublishDoesNotCallSubscribersUntilDrain)
+{
+  publish(&event, 0, 1);
+
+  mock().checkExpectations();
+  LONGS_EQUAL(1, event_queue_pending(&queue));
+
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 1);
+  LONGS_EQUAL(1, event_queue_drain(&queue));
+  mock().checkExpectations();
+  LONGS_EQUAL(0, event_queue_pending(&queue));
+}
+
+TEST(EventQueueTests, PayloadIsCopiedAtPublish)
+{
+  uint32_t value = 5;
+  event_queue_publish(&queue, &event, 0, &value, sizeof(value));
+  value = 6;
+
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 5);
+  event_queue_drain(&queue);
+  mock().checkExpectations();
+}
+
+TEST(EventQueueTests, RepeatedPublishesCoalesceToLatestValue)
+{
+  for(uint32_t i = 1; i <= 1000; i++) {
+    publish(&event, 0, i);
+  }
+
+  LONGS_EQUAL(1, event_queue_pending(&queue));
+  LONGS_EQUAL(999, event_queue_coalesced(&queue));
+
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 1000);
+  event_queue_drain(&queue);
+  mock().checkExpectations();
+}
+
+TEST(EventQueueTests, DistinctKeysAndEventsAreNotCoalesced)
+{
+  publish(&event, 0, 1);
+  publish(&event, 1, 2);
+  publish(&event2, 0, 3);
+
+  mock().strictOrder();
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 1);
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 2);
+  mock().expectOneCall("callback").withPointerParameter("context", &event2).withIntParameter("value", 3);
+  LONGS_EQUAL(3, event_queue_drain(&queue));
+  mock().checkExpectations();
+}
+
+TEST(EventQueueTests, DropsWhenEntriesAreExhausted)
+{
+  for(uint16_t key = 0; key < 4; key++) {
+    publish(&event, key, key);
+  }
+
+  uint32_t value = 9;
+  CHECK_FALSE(event_queue_publish(&queue, &event, 4, &value, sizeof(value)));
+  LONGS_EQUAL(1, event_queue_dropped(&queue));
+
+  // Pending keys can still be updated.
+  CHECK_TRUE(event_queue_publish(&queue, &event, 0, &value, sizeof(value)));
+}
+
+TEST(EventQueueTests, DropsWhenPayloadBufferIsExhausted)
+{
+  uint8_t big[24] = { 0 };
+
+  CHECK_TRUE(event_queue_publish(&queue, &event, 0, big, sizeof(big)));
+  CHECK_FALSE(event_queue_publish(&queue, &event, 1, big, sizeof(big)));
+  LONGS_EQUAL(1, event_queue_dropped(&queue));
+}
+
+static event_queue_t* republish_queue;
+
+static void republish_callback(void* context, const void* data)
+{
+  uint32_t next = *(const uint32_t*)data + 1;
+  mock().actualCall("republish").withIntParameter("value", *(const uint32_t*)data);
+  event_queue_publish(republish_queue, (event_t*)context, 0, &next, sizeof(next));
+}
+
+TEST(EventQueueTests, PublishesDuringDrainAreDeferredToNextDrain)
+{
+  event_subscription_t republisher;
+  event_t chained;
+  event_init(&chained);
+  event_subscription_init(&republisher, republish_callback, &chained);
+  event_subscribe(&chained, &republisher);
+  republish_queue = &queue;
+
+  uint32_t value = 1;
+  event_queue_publish(&queue, &chained, 0, &value, sizeof(value));
+
+  mock().expectOneCall("republish").withIntParameter("value", 1);
+  LONGS_EQUAL(1, event_queue_drain(&queue));
+  mock().checkExpectations();
+  LONGS_EQUAL(1, event_queue_pending(&queue));
+
+  mock().expectOneCall("republish").withIntParameter("value", 2);
+  LONGS_EQUAL(1, event_queue_drain(&queue));
+  mock().checkExpectations();
+}
+
+static void key_dispatch(event_t* event, uint16_t key, const void* payload, uint16_t size)
+{
+  (void)payload;
+  uint32_t value = key + size;
+  event_publish(event, &value);
+}
+
+TEST(EventQueueTests, CustomDispatchReceivesKeyAndPayloadSize)
+{
+  uint32_t value = 0;
+  event_queue_publish_with(&queue, &event, 42, &value, sizeof(value), key_dispatch);
+
+  mock().expectOneCall("callback").withPointerParameter("context", &event).withIntParameter("value", 42 + sizeof(value));
+  event_queue_drain(&queue);
+  mock().checkExpectations();
+}
@@ -0,0 +1,169 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "event_subscription.h"
+#include "isr_event.h"
+}
+
+enum {
+  CAPACITY = 40,
+};
+
+static void payload_callback(void* context, const void* data)
+{
+  mock().actualCall("callback").withPointerParameter("context", context).withIntParameter("payload", *(const uint32_t*)data);
+}
+
+TEST_GROUP(IsrEventTests)
+{
+  isr_event_set_t set;
+  ISR_EVENT_SET_STORAGE(storage, CAPACITY);
+  isr_event_t events[CAPACITY];
+  event_subscription_t subscriptions[CAPACITY];
+
+  void setup()
+  {
+    isr_event_set_init(&set, storage_events, storage_pending, CAPACITY);
+    for(uintptr_t i = 0; i < CAPACITY; i++) {
+      CHECK_TRUE(isr_event_init(&events[i], &set));
+      event_subscription_init(&subscriptions[i], payload_callback, (void*)i);
+      event_subscribe(&events[i].event, &subscriptions[i]);
+    }
+  }
+
+  void teardown()
+  {
+    mock().clear();
+  }
+};
+
+TEST(IsrEventTests, RejectsRegistrationBeyondCapacity)
+{
+  isr_event_t extra;
+  CHECK_FALSE(isr_event_init(&extra, &set));
+}
+
+TEST(IsrEventTests, PublishFromIsrDefersCallbacksToDrain)
+{
+  event_publish_from_isr(&events[3], 7);
+
+  mock().checkExpectations();
+
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)3).withIntParameter("payload", 7);
+  LONGS_EQUAL(1, isr_event_set_drain(&set));
+  mock().checkExpectations();
+
+  LONGS_EQUAL(0, isr_event_set_drain(&set));
+}
+
+TEST(IsrEventTests, RepeatedPublishesCoalesceToLatestPayload)
+{
+  event_publish_from_isr(&events[0], 1);
+  event_publish_from_isr(&events[0], 2);
+  event_publish_from_isr(&events[0], 3);
+
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)0).withIntParameter("payload", 3);
+  LONGS_EQUAL(1, isr_event_set_drain(&set));
+  mock().checkExpectations();
+}
+
+TEST(IsrEventTests, DrainPublishesAcrossWordsInRegistrationOrder)
+{
+  event_publish_from_isr(&events[39], 39);
+  event_publish_from_isr(&events[31], 31);
+  event_publish_from_isr(&events[32], 32);
+
+  mock().strictOrder();
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)31).withIntParameter("payload", 31);
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)32).withIntParameter("payload", 32);
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)39).withIntParameter("payload", 39);
+  LONGS_EQUAL(3, isr_event_set_drain(&set));
+  mock().checkExpectations();
+}
+
+// ---------------------------------------------------------------------------
+// Foreign threads publishing while the main loop drains
+// ---------------------------------------------------------------------------
+
+enum {
+  STRESS_PRODUCERS = 4,
+  STRESS_PUBLISHES = 100000,
+};
+
+typedef struct {
+  isr_event_t* event;
+  SIERA_ATOMIC(bool) * done;
+} stress_producer_t;
+
+static uint32_t last_seen[STRESS_PRODUCERS];
+static uint32_t regressions;
+
+static void stress_callback(void* context, const void* data)
+{
+  uintptr_t producer = (uintptr_t)context;
+  uint32_t payload = *(const uint32_t*)data;
+
+  if(payload < last_seen[producer]) {
+    regressions++;
+  }
+  last_seen[producer] = payload;
+}
+
+static void* stress_producer(void* arg)
+{
+  stress_producer_t* producer = (stress_producer_t*)arg;
+
+  for(uint32_t i = 1; i <= STRESS_PUBLISHES; i++) {
+    event_publish_from_isr(producer->event, i);
+    if((i & 0xFFu) == 0) {
+      sched_yield();
+    }
+  }
+
+  producer->done->store(true);
+  return nullptr;
+}
+
+TEST(IsrEventTests, StressForeignThreadsNeverLoseTheLatestPayload)
+{
+  event_subscription_t stress_subscriptions[STRESS_PRODUCERS];
+  stress_producer_t producers[STRESS_PRODUCERS];
+  SIERA_ATOMIC(bool) done[STRESS_PRODUCERS];
+  pthread_t threads[STRESS_PRODUCERS];
+
+  regressions = 0;
+  for(uintptr_t p = 0; p < STRESS_PRODUCERS; p++) {
+    last_seen[p] = 0;
+    done[p].store(false);
+    event_subscription_init(&stress_subscriptions[p], stress_callback, (void*)p);
+    event_unsubscribe(&events[p].event, &subscriptions[p]);
+    event_subscribe(&events[p].event, &stress_subscriptions[p]);
+    producers[p] = { &events[p], &done[p] };
+    pthread_create(&threads[p], nullptr, stress_producer, &producers[p]);
+  }
+
+  bool all_done = false;
+  while(!all_done) {
+    if(isr_event_set_drain(&set) == 0) {
+      sched_yield();
+    }
+    all_done = true;
+    for(int p = 0; p < STRESS_PRODUCERS; p++) {
+      all_done = all_done && done[p].load();
+    }
+  }
+
+  for(int p = 0; p < STRESS_PRODUCERS; p++) {
+    pthread_join(threads[p], nullptr);
+  }
+  isr_event_set_drain(&set);
+
+  LONGS_EQUAL(0, regressions);
+  for(int p = 0; p < STRESS_PRODUCERS; p++) {
+    LONGS_EQUAL(STRESS_PUBLISHES, last_seen[p]);
+  }
+}
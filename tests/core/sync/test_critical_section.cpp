@@ -0,0 +1,116 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "null_critical_section.h"
+#include "spin_critical_section.h"
+}
+
+static spin_critical_section_t* releasing_section;
+static int relax_calls;
+
+// Stands in for another thread finishing its section while we wait.
+static void release_on_relax(void)
+{
+  relax_calls++;
+  critical_section_exit(&releasing_section->interface);
+}
+
+static void yield(void)
+{
+  sched_yield();
+}
+
+TEST_GROUP(CriticalSectionTests)
+{
+  spin_critical_section_t spin;
+
+  void setup()
+  {
+    spin_critical_section_init(&spin, nullptr);
+    relax_calls = 0;
+  }
+
+  void teardown()
+  {
+  }
+};
+
+TEST(CriticalSectionTests, NullSectionNeverExcludes)
+{
+  null_critical_section_t section;
+  null_critical_section_init(&section);
+
+  critical_section_enter(&section.interface);
+  CHECK_TRUE(critical_section_try_enter(&section.interface));
+  critical_section_exit(&section.interface);
+  critical_section_exit(&section.interface);
+}
+
+TEST(CriticalSectionTests, SpinTryEnterFailsWhileHeld)
+{
+  CHECK_TRUE(critical_section_try_enter(&spin.interface));
+  CHECK_FALSE(critical_section_try_enter(&spin.interface));
+
+  critical_section_exit(&spin.interface);
+  CHECK_TRUE(critical_section_try_enter(&spin.interface));
+  critical_section_exit(&spin.interface);
+}
+
+TEST(CriticalSectionTests, SpinEnterRelaxesUntilReleased)
+{
+  spin_critical_section_init(&spin, release_on_relax);
+  releasing_section = &spin;
+
+  critical_section_enter(&spin.interface);
+  LONGS_EQUAL(0, relax_calls);
+
+  critical_section_enter(&spin.interface);
+  LONGS_EQUAL(1, relax_calls);
+  critical_section_exit(&spin.interface);
+}
+
+enum {
+  SPIN_THREADS = 4,
+  SPIN_INCREMENTS = 20000,
+};
+
+typedef struct {
+  spin_critical_section_t* section;
+  uint32_t* counter;
+} spin_worker_t;
+
+static void* spin_worker(void* arg)
+{
+  spin_worker_t* worker = (spin_worker_t*)arg;
+  for(int i = 0; i < SPIN_INCREMENTS; i++) {
+    critical_section_enter(&worker->section->interface);
+    // Split read-modify-write so a missing exclusion loses updates.
+    uint32_t value = *worker->counter;
+    if((i & 0x3Fu) == 0) {
+      sched_yield();
+    }
+    *worker->counter = value + 1;
+    critical_section_exit(&worker->section->interface);
+  }
+  return nullptr;
+}
+
+TEST(CriticalSectionTests, SpinSectionExcludesConcurrentThreads)
+{
+  spin_critical_section_init(&spin, yield);
+  uint32_t counter = 0;
+  spin_worker_t worker = { &spin, &counter };
+  pthread_t threads[SPIN_THREADS];
+
+  for(int t = 0; t < SPIN_THREADS; t++) {
+    pthread_create(&threads[t], nullptr, spin_worker, &worker);
+  }
+  for(int t = 0; t < SPIN_THREADS; t++) {
+    pthread_join(threads[t], nullptr);
+  }
+
+  LONGS_EQUAL(SPIN_THREADS * SPIN_INCREMENTS, counter);
+}
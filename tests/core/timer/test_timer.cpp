@@ -4,6 +4,7 @@
 extern "C" {
 #include "double_timesource.h"
 #include "timer.h"
+#include "timer_pass_hooks.h"
 }
 
 static void mock_callback(void* context)
@@ -17,11 +18,15 @@ TEST_GROUP(TimerTests)
   double_timesource_t timesource;
   s_timer_t timer;
   s_timer_t timer2;
+  s_timer_t timer3;
 
   void setup()
   {
     double_timesource_init(&timesource);
     timer_controller_init(&controller, &timesource.interface);
+    timer_init(&timer);
+    timer_init(&timer2);
+    timer_init(&timer3);
   }
 
   void teardown()
@@ -32,7 +37,7 @@ TEST_GROUP(TimerTests)
 
 TEST(TimerTests, init_creates_empty_timer_list)
 {
-  CHECK_TRUE(list_is_empty(&controller.timers));
+  CHECK_TRUE(dlist_is_empty(&controller.timers));
 }
 
 TEST(TimerTests, init_stores_timesource)
@@ -71,7 +76,7 @@ TEST(TimerTests, one_shot_timer_removed_after_firing)
 
   timer_controller_run(&controller);
 
-  CHECK_TRUE(list_is_empty(&controller.timers));
+  CHECK_TRUE(dlist_is_empty(&controller.timers));
 }
 
 TEST(TimerTests, repeating_timer_fires_multiple_times)
@@ -103,7 +108,7 @@ TEST(TimerTests, repeating_timer_remains_in_list_after_firing)
 
   timer_controller_run(&controller);
 
-  CHECK_FALSE(list_is_empty(&controller.timers));
+  CHECK_FALSE(dlist_is_empty(&controller.timers));
 }
 
 TEST(TimerTests, timer_stop_removes_timer)
@@ -112,7 +117,7 @@ TEST(TimerTests, timer_stop_removes_timer)
 
   timer_stop(&timer);
 
-  CHECK_TRUE(list_is_empty(&controller.timers));
+  CHECK_TRUE(dlist_is_empty(&controller.timers));
 }
 
 TEST(TimerTests, stopped_timer_does_not_fire)
@@ -152,6 +157,144 @@ TEST(TimerTests, timer_is_active_returns_false_for_fired_one_shot)
   CHECK_FALSE(timer_is_active(&controller, &timer));
 }
 
+TEST(TimerTests, timer_is_active_returns_false_for_initialized_timer)
+{
+  CHECK_FALSE(timer_is_active(&controller, &timer));
+}
+
+static void stop_callback(void* context)
+{
+  mock().actualCall("stop_callback");
+  timer_stop((s_timer_t*)context);
+}
+
+TEST(TimerTests, stopping_next_timer_from_callback_keeps_pass_going)
+{
+  int context = 3;
+  timer_start_one_shot(&timer, &controller, 10, stop_callback, &timer2);
+  timer_start_one_shot(&timer2, &controller, 50, mock_callback, nullptr);
+  timer_start_one_shot(&timer3, &controller, 10, mock_callback, &context);
+  double_timesource_set_ticks(&timesource, 10);
+
+  mock().expectOneCall("stop_callback");
+  mock().expectOneCall("callback").withPointerParameter("context", &context);
+
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+
+  mock().checkExpectations();
+  CHECK_EQUAL(UINT32_MAX, ticks);
+  CHECK_FALSE(timer_is_active(&controller, &timer2));
+}
+
+TEST(TimerTests, repeating_timer_stopped_by_own_callback_does_not_bound_sleep)
+{
+  timer_start_repeating(&timer, &controller, 10, stop_callback, &timer);
+  timer_start_one_shot(&timer2, &controller, 50, mock_callback, nullptr);
+  double_timesource_set_ticks(&timesource, 10);
+
+  mock().expectOneCall("stop_callback");
+
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+
+  mock().checkExpectations();
+  CHECK_EQUAL(40, ticks);
+}
+
+TEST(TimerTests, restarting_running_timer_rearms_it)
+{
+  int context = 1;
+  timer_start_one_shot(&timer, &controller, 10, mock_callback, &context);
+  timer_start_one_shot(&timer2, &controller, 20, mock_callback, nullptr);
+  timer_start_one_shot(&timer3, &controller, 30, mock_callback, nullptr);
+
+  double_timesource_set_ticks(&timesource, 5);
+  timer_controller_run(&controller);
+  timer_start_one_shot(&timer, &controller, 100, mock_callback, &context);
+
+  double_timesource_set_ticks(&timesource, 30);
+  mock().expectNCalls(2, "callback").withPointerParameter("context", (void*)nullptr);
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+
+  mock().checkExpectations();
+  CHECK_EQUAL(75, ticks);
+  CHECK_TRUE(timer_is_active(&controller, &timer));
+  CHECK_TRUE(controller.timers.head == &timer.node);
+  CHECK_TRUE(controller.timers.tail == &timer.node);
+}
+
+static void restart_callback(void* context)
+{
+  mock().actualCall("restart_callback");
+  s_timer_t* timer = (s_timer_t*)context;
+  timer_start_one_shot(timer, timer->controller, 100, mock_callback, nullptr);
+}
+
+TEST(TimerTests, restarting_next_timer_from_callback_defers_it)
+{
+  timer_start_one_shot(&timer, &controller, 10, restart_callback, &timer2);
+  timer_start_one_shot(&timer2, &controller, 10, mock_callback, nullptr);
+  double_timesource_set_ticks(&timesource, 10);
+
+  mock().expectOneCall("restart_callback");
+
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+
+  mock().checkExpectations();
+  CHECK_EQUAL(100, ticks);
+  CHECK_TRUE(timer_is_active(&controller, &timer2));
+}
+
+static void rearm_callback(void* context)
+{
+  mock().actualCall("rearm_callback");
+  s_timer_t* timer = (s_timer_t*)context;
+  timer_start_one_shot(timer, timer->controller, 0, rearm_callback, timer);
+}
+
+TEST(TimerTests, timer_rearmed_with_zero_interval_fires_once_per_pass)
+{
+  timer_start_one_shot(&timer, &controller, 0, rearm_callback, &timer);
+
+  mock().expectOneCall("rearm_callback");
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+  mock().checkExpectations();
+  CHECK_EQUAL(0, ticks);
+
+  mock().expectOneCall("rearm_callback");
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+  CHECK_TRUE(timer_is_active(&controller, &timer));
+}
+
+TEST(TimerTests, timer_started_by_a_callback_waits_for_the_next_pass)
+{
+  timer_start_one_shot(&timer2, &controller, 1000, mock_callback, nullptr);
+  timer_start_one_shot(&timer, &controller, 10, restart_callback, &timer2);
+  double_timesource_set_ticks(&timesource, 10);
+
+  mock().expectOneCall("restart_callback");
+  timesource_ticks_t ticks = timer_controller_run(&controller);
+  mock().checkExpectations();
+  CHECK_EQUAL(100, ticks);
+
+  double_timesource_set_ticks(&timesource, 110);
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)nullptr);
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+}
+
+TEST(TimerTests, timer_is_active_is_false_for_another_controllers_timer)
+{
+  s_timer_controller_t other;
+  timer_controller_init(&other, &timesource.interface);
+  timer_start_one_shot(&timer, &other, 10, mock_callback, nullptr);
+  timer_start_one_shot(&timer2, &other, 10, mock_callback, nullptr);
+  timer_start_one_shot(&timer3, &other, 10, mock_callback, nullptr);
+
+  CHECK_FALSE(timer_is_active(&controller, &timer2));
+  CHECK_TRUE(timer_is_active(&other, &timer2));
+}
+
 TEST(TimerTests, callback_receives_context)
 {
   int context = 42;
@@ -245,3 +388,112 @@ TEST(TimerTests, advance_ticks_helper_works)
   timer_controller_run(&controller);
   mock().checkExpectations();
 }
+
+static void scratch_callback(void* context)
+{
+  arena_t* scratch = (arena_t*)context;
+  mock().actualCall("scratch_callback").withPointerParameter("allocation", arena_alloc(scratch, 16));
+}
+
+static void hook_callback(void* context)
+{
+  mock().actualCall("hook").withPointerParameter("context", context);
+}
+
+TEST(TimerTests, pass_hooks_run_in_order_before_timers)
+{
+  timer_pass_hook_t first;
+  timer_pass_hook_t second;
+  int first_context = 1;
+  int second_context = 2;
+  timer_controller_add_pass_hook(&controller, &first, hook_callback, &first_context);
+  timer_controller_add_pass_hook(&controller, &second, hook_callback, &second_context);
+  timer_start_one_shot(&timer, &controller, 0, mock_callback, nullptr);
+
+  mock().strictOrder();
+  mock().expectOneCall("hook").withPointerParameter("context", &first_context);
+  mock().expectOneCall("hook").withPointerParameter("context", &second_context);
+  mock().expectOneCall("callback").withPointerParameter("context", (void*)nullptr);
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+
+  timer_controller_remove_pass_hook(&controller, &first);
+  mock().expectOneCall("hook").withPointerParameter("context", &second_context);
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+}
+
+TEST(TimerTests, scratch_arena_is_reset_each_run)
+{
+  uint64_t buffer[8];
+  arena_t scratch;
+  arena_init(&scratch, buffer, sizeof(buffer));
+  timer_pass_hook_t hook;
+  timer_controller_add_pass_hook(&controller, &hook, timer_pass_reset_arena, &scratch);
+
+  timer_start_repeating(&timer, &controller, 10, scratch_callback, &scratch);
+
+  mock().expectNCalls(2, "scratch_callback").withPointerParameter("allocation", (void*)buffer);
+
+  double_timesource_set_ticks(&timesource, 10);
+  timer_controller_run(&controller);
+  double_timesource_set_ticks(&timesource, 20);
+  timer_controller_run(&controller);
+
+  mock().checkExpectations();
+  LONGS_EQUAL(16, arena_peak(&scratch));
+}
+
+static void queued_callback(void* context, const void* data)
+{
+  mock().actualCall("queued_callback").withPointerParameter("context", context).withIntParameter("value", *(const uint8_t*)data);
+}
+
+TEST(TimerTests, event_queue_is_drained_each_run)
+{
+  event_queue_t queue;
+  EVENT_QUEUE_ENTRIES(entries, 2);
+  EVENT_QUEUE_PAYLOAD(payload, 8);
+  event_queue_init(&queue, entries, 2, payload, sizeof(payload));
+  timer_pass_hook_t hook;
+  timer_controller_add_pass_hook(&controller, &hook, timer_pass_drain_event_queue, &queue);
+
+  event_t event;
+  event_subscription_t subscription;
+  event_init(&event);
+  event_subscription_init(&subscription, queued_callback, &event);
+  event_subscribe(&event, &subscription);
+
+  uint8_t value = 3;
+  event_queue_publish(&queue, &event, 0, &value, sizeof(value));
+
+  mock().expectOneCall("queued_callback").withPointerParameter("context", &event).withIntParameter("value", 3);
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+  LONGS_EQUAL(0, event_queue_pending(&queue));
+}
+
+static void isr_callback(void* context, const void* data)
+{
+  mock().actualCall("isr_callback").withPointerParameter("context", context).withIntParameter("value", *(const uint32_t*)data);
+}
+
+TEST(TimerTests, isr_events_are_published_each_run)
+{
+  isr_event_set_t set;
+  ISR_EVENT_SET_STORAGE(storage, 1);
+  isr_event_t isr_event;
+  event_subscription_t subscription;
+  isr_event_set_init(&set, storage_events, storage_pending, 1);
+  isr_event_init(&isr_event, &set);
+  event_subscription_init(&subscription, isr_callback, &isr_event);
+  event_subscribe(&isr_event.event, &subscription);
+  timer_pass_hook_t hook;
+  timer_controller_add_pass_hook(&controller, &hook, timer_pass_drain_isr_events, &set);
+
+  event_publish_from_isr(&isr_event, 9);
+
+  mock().expectOneCall("isr_callback").withPointerParameter("context", &isr_event).withIntParameter("value", 9);
+  timer_controller_run(&controller);
+  mock().checkExpectations();
+}
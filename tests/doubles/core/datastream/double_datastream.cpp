@@ -2,6 +2,17 @@
 #include "CppUTestExt/MockSupport.h"
 #include "double_datastream.hpp"
 
+static void double_write_range(i_datastream_t* self, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* data)
+{
+  mock()
+    .actualCall("write_range")
+    .onObject(self)
+    .withParameter("key", key)
+    .withParameter("offset", offset)
+    .withParameter("length", length)
+    .withParameter("data", data);
+}
+
 static bool double_contains(i_datastream_t* self, datastream_key_t key)
 {
   return mock()
@@ -11,9 +22,9 @@ static bool double_contains(i_datastream_t* self, datastream_key_t key)
     .returnBoolValueOrDefault(false);
 }
 
-static uint8_t double_size(i_datastream_t* self, datastream_key_t key)
+static datastream_size_t double_size(i_datastream_t* self, datastream_key_t key)
 {
-  return static_cast<uint8_t>(
+  return static_cast<datastream_size_t>(
     mock()
       .actualCall("size")
       .onObject(self)
@@ -39,13 +50,14 @@ static void double_write(i_datastream_t* self, datastream_key_t key, const void*
     .withParameter("data", data); // ← fixed: use withParameter
 }
 
-static void double_subscribe(i_datastream_t* self, datastream_key_t key, event_subscription_t* sub)
+static bool double_subscribe(i_datastream_t* self, datastream_key_t key, event_subscription_t* sub)
 {
-  mock()
+  return mock()
     .actualCall("subscribe")
     .onObject(self)
     .withParameter("key", key)
-    .withParameter("subscription", sub);
+    .withParameter("subscription", sub)
+    .returnBoolValueOrDefault(true);
 }
 
 static void double_subscribe_all(i_datastream_t* self, event_subscription_t* sub)
@@ -64,6 +76,60 @@ static void double_unsubscribe(i_datastream_t* self, event_subscription_t* sub)
     .withParameter("subscription", sub);
 }
 
+static void double_subscribe_batch(i_datastream_t* self, event_subscription_t* sub)
+{
+  mock()
+    .actualCall("subscribe_batch")
+    .onObject(self)
+    .withParameter("subscription", sub);
+}
+
+static void double_begin_batch(i_datastream_t* self)
+{
+  mock().actualCall("begin_batch").onObject(self);
+}
+
+static void double_commit(i_datastream_t* self)
+{
+  mock().actualCall("commit").onObject(self);
+}
+
+static const void* double_peek(i_datastream_t* self, datastream_key_t key)
+{
+  return mock()
+    .actualCall("peek")
+    .onObject(self)
+    .withParameter("key", key)
+    .returnPointerValueOrDefault(nullptr);
+}
+
+static void* double_acquire(i_datastream_t* self, datastream_key_t key)
+{
+  return mock()
+    .actualCall("acquire")
+    .onObject(self)
+    .withParameter("key", key)
+    .returnPointerValueOrDefault(nullptr);
+}
+
+static void double_release(i_datastream_t* self, datastream_key_t key)
+{
+  mock()
+    .actualCall("release")
+    .onObject(self)
+    .withParameter("key", key);
+}
+
+static datastream_version_t double_version(i_datastream_t* self, datastream_key_t key)
+{
+  return static_cast<datastream_version_t>(
+    mock()
+      .actualCall("version")
+      .onObject(self)
+      .withParameter("key", key)
+      .returnUnsignedIntValueOrDefault(0));
+}
+
 void double_datastream_init(double_datastream_t* ds)
 {
   std::memset(ds, 0, sizeof(*ds));
@@ -71,11 +137,19 @@ void double_datastream_init(double_datastream_t* ds)
   ds->interface = (i_datastream_t){
     .read = double_read,
     .write = double_write,
+    .write_range = double_write_range,
     .contains = double_contains,
     .size = double_size,
     .subscribe = double_subscribe,
     .subscribe_all = double_subscribe_all,
     .unsubscribe = double_unsubscribe,
+    .subscribe_batch = double_subscribe_batch,
+    .begin_batch = double_begin_batch,
+    .commit = double_commit,
+    .peek = double_peek,
+    .acquire = double_acquire,
+    .release = double_release,
+    .version = double_version,
   };
 }
 
@@ -93,7 +167,7 @@ void double_expect_contains(double_datastream_t* ds, datastream_key_t key, bool
   mock().expectOneCall("contains").onObject(&ds->interface).withParameter("key", key).andReturnValue(returns ? 1 : 0);
 }
 
-void double_expect_size(double_datastream_t* ds, datastream_key_t key, uint8_t returns)
+void double_expect_size(double_datastream_t* ds, datastream_key_t key, datastream_size_t returns)
 {
   mock().expectOneCall("size").onObject(&ds->interface).withParameter("key", key).andReturnValue(static_cast<int>(returns));
 }
@@ -108,9 +182,14 @@ void double_expect_write(double_datastream_t* ds, datastream_key_t key, const vo
   mock().expectOneCall("write").onObject(&ds->interface).withParameter("key", key).withParameter("data", expected_data);
 }
 
-void double_expect_subscribe(double_datastream_t* ds, datastream_key_t key, event_subscription_t* sub)
+void double_expect_write_range(double_datastream_t* ds, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* expected_data)
+{
+  mock().expectOneCall("write_range").onObject(&ds->interface).withParameter("key", key).withParameter("offset", offset).withParameter("length", length).withParameter("data", expected_data);
+}
+
+void double_expect_subscribe(double_datastream_t* ds, datastream_key_t key, event_subscription_t* sub, bool returns)
 {
-  mock().expectOneCall("subscribe").onObject(&ds->interface).withParameter("key", key).withParameter("subscription", sub);
+  mock().expectOneCall("subscribe").onObject(&ds->interface).withParameter("key", key).withParameter("subscription", sub).andReturnValue(returns ? 1 : 0);
 }
 
 void double_expect_subscribe_all(double_datastream_t* ds, event_subscription_t* sub)
@@ -123,13 +202,56 @@ void double_expect_unsubscribe(double_datastream_t* ds, event_subscription_t* su
   mock().expectOneCall("unsubscribe").onObject(&ds->interface).withParameter("subscription", sub);
 }
 
+void double_expect_subscribe_batch(double_datastream_t* ds, event_subscription_t* sub)
+{
+  mock().expectOneCall("subscribe_batch").onObject(&ds->interface).withParameter("subscription", sub);
+}
+
+void double_expect_begin_batch(double_datastream_t* ds)
+{
+  mock().expectOneCall("begin_batch").onObject(&ds->interface);
+}
+
+void double_expect_commit(double_datastream_t* ds)
+{
+  mock().expectOneCall("commit").onObject(&ds->interface);
+}
+
+void double_expect_peek(double_datastream_t* ds, datastream_key_t key, const void* returns)
+{
+  mock().expectOneCall("peek").onObject(&ds->interface).withParameter("key", key).andReturnValue(returns);
+}
+
+void double_expect_acquire(double_datastream_t* ds, datastream_key_t key, void* returns)
+{
+  mock().expectOneCall("acquire").onObject(&ds->interface).withParameter("key", key).andReturnValue(returns);
+}
+
+void double_expect_release(double_datastream_t* ds, datastream_key_t key)
+{
+  mock().expectOneCall("release").onObject(&ds->interface).withParameter("key", key);
+}
+
+void double_expect_version(double_datastream_t* ds, datastream_key_t key, datastream_version_t returns)
+{
+  mock().expectOneCall("version").onObject(&ds->interface).withParameter("key", key).andReturnValue(static_cast<unsigned int>(returns));
+}
+
 void double_expect_no_calls(double_datastream_t* ds)
 {
   mock().expectNoCall("contains");
   mock().expectNoCall("size");
   mock().expectNoCall("read");
   mock().expectNoCall("write");
+  mock().expectNoCall("write_range");
   mock().expectNoCall("subscribe");
   mock().expectNoCall("subscribe_all");
   mock().expectNoCall("unsubscribe");
+  mock().expectNoCall("subscribe_batch");
+  mock().expectNoCall("begin_batch");
+  mock().expectNoCall("commit");
+  mock().expectNoCall("peek");
+  mock().expectNoCall("acquire");
+  mock().expectNoCall("release");
+  mock().expectNoCall("version");
 }
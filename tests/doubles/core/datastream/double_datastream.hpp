@@ -24,12 +24,20 @@ void double_datastream_reset(double_datastream_t* ds);
 
 // Expectation helpers
 void double_expect_contains(double_datastream_t* ds, datastream_key_t key, bool returns);
-void double_expect_size(double_datastream_t* ds, datastream_key_t key, uint8_t returns);
+void double_expect_size(double_datastream_t* ds, datastream_key_t key, datastream_size_t returns);
 void double_expect_read(double_datastream_t* ds, datastream_key_t key, const void* return_data, size_t size);
 void double_expect_write(double_datastream_t* ds, datastream_key_t key, const void* expected_data, size_t size);
-void double_expect_subscribe(double_datastream_t* ds, datastream_key_t key, event_subscription_t* sub);
+void double_expect_write_range(double_datastream_t* ds, datastream_key_t key, datastream_size_t offset, datastream_size_t length, const void* expected_data);
+void double_expect_subscribe(double_datastream_t* ds, datastream_key_t key, event_subscription_t* sub, bool returns);
 void double_expect_subscribe_all(double_datastream_t* ds, event_subscription_t* sub);
 void double_expect_unsubscribe(double_datastream_t* ds, event_subscription_t* sub);
+void double_expect_subscribe_batch(double_datastream_t* ds, event_subscription_t* sub);
+void double_expect_begin_batch(double_datastream_t* ds);
+void double_expect_commit(double_datastream_t* ds);
+void double_expect_peek(double_datastream_t* ds, datastream_key_t key, const void* returns);
+void double_expect_acquire(double_datastream_t* ds, datastream_key_t key, void* returns);
+void double_expect_release(double_datastream_t* ds, datastream_key_t key);
+void double_expect_version(double_datastream_t* ds, datastream_key_t key, datastream_version_t returns);
 
 void double_expect_no_calls(double_datastream_t* ds);
 
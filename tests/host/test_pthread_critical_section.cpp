@@ -0,0 +1,55 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+
+extern "C" {
+#include "pthread_critical_section.h"
+}
+
+typedef struct {
+  pthread_critical_section_t* section;
+  bool acquired;
+} probe_t;
+
+static void* try_from_other_thread(void* arg)
+{
+  probe_t* probe = (probe_t*)arg;
+  probe->acquired = critical_section_try_enter(&probe->section->interface);
+  if(probe->acquired) {
+    critical_section_exit(&probe->section->interface);
+  }
+  return nullptr;
+}
+
+TEST_GROUP(PthreadCriticalSectionTests)
+{
+  pthread_critical_section_t section;
+
+  void setup()
+  {
+    CHECK_TRUE(pthread_critical_section_init(&section));
+  }
+
+  void teardown()
+  {
+    pthread_critical_section_deinit(&section);
+  }
+
+  bool other_thread_can_enter()
+  {
+    probe_t probe = { &section, false };
+    pthread_t thread;
+    pthread_create(&thread, nullptr, try_from_other_thread, &probe);
+    pthread_join(thread, nullptr);
+    return probe.acquired;
+  }
+};
+
+TEST(PthreadCriticalSectionTests, HeldSectionExcludesOtherThreads)
+{
+  critical_section_enter(&section.interface);
+  CHECK_FALSE(other_thread_can_enter());
+
+  critical_section_exit(&section.interface);
+  CHECK_TRUE(other_thread_can_enter());
+}
@@ -0,0 +1,203 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+#include <string.h>
+
+extern "C" {
+#include "event.h"
+#include "event_subscription.h"
+#include "pthread_event_executor.h"
+#include "ram_datastream.h"
+#include "utils.h"
+}
+
+enum {
+  THREADS = 4,
+  TASKS = 64,
+  MAX_PAYLOAD = 32,
+};
+
+typedef struct {
+  SIERA_ATOMIC(uint32_t) calls;
+  SIERA_ATOMIC(uint32_t) sum;
+  SIERA_ATOMIC(bool) ran_off_publisher_thread;
+  SIERA_ATOMIC(const void*) last_data;
+  pthread_t publisher;
+} recorder_t;
+
+static void recording_callback(void* context, const void* data)
+{
+  recorder_t* recorder = (recorder_t*)context;
+  recorder->calls++;
+  recorder->sum += *(const uint32_t*)data;
+  recorder->last_data = data;
+  if(!pthread_equal(pthread_self(), recorder->publisher)) {
+    recorder->ran_off_publisher_thread = true;
+  }
+}
+
+TEST_GROUP(PthreadEventExecutorTests)
+{
+  pthread_event_executor_t executor;
+  pthread_t threads[THREADS];
+  PTHREAD_EVENT_EXECUTOR_TASKS(tasks, TASKS, MAX_PAYLOAD);
+  event_async_t async;
+  event_t event;
+  recorder_t recorder;
+
+  void setup()
+  {
+    CHECK_TRUE(pthread_event_executor_init(&executor, threads, THREADS, tasks, TASKS, MAX_PAYLOAD));
+    async = { &executor.interface, sizeof(uint32_t), nullptr, nullptr };
+    event_init(&event);
+    event_set_async(&event, &async);
+
+    recorder.calls = 0;
+    recorder.sum = 0;
+    recorder.ran_off_publisher_thread = false;
+    recorder.last_data = nullptr;
+    recorder.publisher = pthread_self();
+  }
+
+  void teardown()
+  {
+    pthread_event_executor_deinit(&executor);
+  }
+};
+
+TEST(PthreadEventExecutorTests, AsyncSafeSubscriberRunsOnWorkerWithCopiedPayload)
+{
+  event_subscription_t subscription;
+  event_subscription_init(&subscription, recording_callback, &recorder);
+  event_subscription_set_async_safe(&subscription, true);
+  event_subscribe(&event, &subscription);
+
+  uint32_t value = 5;
+  event_publish(&event, &value);
+  value = 6;
+  pthread_event_executor_join(&executor);
+
+  LONGS_EQUAL(1, recorder.calls.load());
+  LONGS_EQUAL(5, recorder.sum.load());
+  CHECK_TRUE(recorder.ran_off_publisher_thread.load());
+  CHECK(recorder.last_data.load() != &value);
+}
+
+TEST(PthreadEventExecutorTests, OtherSubscribersStillRunInline)
+{
+  event_subscription_t subscription;
+  event_subscription_init(&subscription, recording_callback, &recorder);
+  event_subscribe(&event, &subscription);
+
+  uint32_t value = 7;
+  event_publish(&event, &value);
+
+  LONGS_EQUAL(1, recorder.calls.load());
+  CHECK_FALSE(recorder.ran_off_publisher_thread.load());
+  POINTERS_EQUAL(&value, recorder.last_data.load());
+}
+
+TEST(PthreadEventExecutorTests, EventWithoutAsyncConfigRunsInline)
+{
+  event_subscription_t subscription;
+  event_subscription_init(&subscription, recording_callback, &recorder);
+  event_subscription_set_async_safe(&subscription, true);
+  event_set_async(&event, nullptr);
+  event_subscribe(&event, &subscription);
+
+  uint32_t value = 1;
+  event_publish(&event, &value);
+
+  CHECK_FALSE(recorder.ran_off_publisher_thread.load());
+}
+
+TEST(PthreadEventExecutorTests, OversizedPayloadRunsInline)
+{
+  event_subscription_t subscription;
+  event_subscription_init(&subscription, recording_callback, &recorder);
+  event_subscription_set_async_safe(&subscription, true);
+  event_subscribe(&event, &subscription);
+  async.payload_size = MAX_PAYLOAD + 1;
+
+  uint32_t value[MAX_PAYLOAD] = { 3 };
+  event_publish(&event, value);
+
+  LONGS_EQUAL(1, recorder.calls.load());
+  LONGS_EQUAL(1, pthread_event_executor_inline_runs(&executor));
+  CHECK_FALSE(recorder.ran_off_publisher_thread.load());
+}
+
+TEST(PthreadEventExecutorTests, JoinWaitsForEveryFanOutCall)
+{
+  enum {
+    SUBSCRIBERS = 4,
+    PUBLISHES = 5000,
+  };
+  event_subscription_t subscriptions[SUBSCRIBERS];
+
+  for(int i = 0; i < SUBSCRIBERS; i++) {
+    event_subscription_init(&subscriptions[i], recording_callback, &recorder);
+    event_subscription_set_async_safe(&subscriptions[i], true);
+    event_subscribe(&event, &subscriptions[i]);
+  }
+
+  for(uint32_t i = 1; i <= PUBLISHES; i++) {
+    event_publish(&event, &i);
+  }
+  pthread_event_executor_join(&executor);
+
+  // Calls that found the pool full ran inline; either way every call happened exactly once.
+  LONGS_EQUAL(SUBSCRIBERS * PUBLISHES, recorder.calls.load());
+  LONGS_EQUAL(SUBSCRIBERS * (PUBLISHES * (PUBLISHES + 1) / 2), recorder.sum.load());
+}
+
+typedef struct {
+  uint8_t EXECUTOR_U8[sizeof(uint8_t)];
+  uint8_t EXECUTOR_U32[sizeof(uint32_t)];
+} executor_storage_t;
+
+enum {
+  EXECUTOR_U8,
+  EXECUTOR_U32,
+};
+
+static const ram_datastream_entry_t executor_entries[] = {
+  { offsetof(executor_storage_t, EXECUTOR_U8), sizeof(uint8_t) },
+  { offsetof(executor_storage_t, EXECUTOR_U32), sizeof(uint32_t) },
+};
+
+static uint32_t datastream_value;
+static datastream_key_t datastream_key;
+
+static void datastream_callback(void* context, const void* data)
+{
+  (void)context;
+  const datastream_on_change_args_t* args = (const datastream_on_change_args_t*)data;
+  datastream_key = args->key;
+  memcpy(&datastream_value, args->data, sizeof(datastream_value));
+}
+
+TEST(PthreadEventExecutorTests, RamDatastreamSubscribersReceiveCopiedValue)
+{
+  const ram_datastream_config_t config = { executor_entries, NUM_ELEMENTS(executor_entries), nullptr };
+  ram_datastream_t ds;
+  executor_storage_t storage;
+  RAM_DATASTREAM_SUBSCRIBERS(subscribers, 2);
+  ram_datastream_init(&ds, &config, &storage);
+  ram_datastream_set_subscriber_storage(&ds, subscribers_slots, subscribers_events, 2);
+  ram_datastream_set_executor(&ds, &executor.interface);
+
+  event_subscription_t subscription;
+  event_subscription_init(&subscription, datastream_callback, nullptr);
+  event_subscription_set_async_safe(&subscription, true);
+  datastream_subscribe(&ds.interface, EXECUTOR_U32, &subscription);
+
+  uint32_t value = 0xCAFE;
+  datastream_write(&ds.interface, EXECUTOR_U32, &value);
+  value = 0;
+  pthread_event_executor_join(&executor);
+
+  LONGS_EQUAL(EXECUTOR_U32, datastream_key);
+  LONGS_EQUAL(0xCAFE, datastream_value);
+  LONGS_EQUAL(0, pthread_event_executor_inline_runs(&executor));
+}